@@ -78,6 +78,70 @@ void CurvedADSR::setTargetRatioDR(double targetRatio) {
     releaseBase = -targetRatioDR * (1.0 - releaseCoef);
 }
 
+void CurvedADSR::renderEnvelope(float* dest, int numSamples)
+{
+    int pos = 0;
+    while (pos < numSamples)
+    {
+        switch (state) {
+            case env_idle:
+                FloatVectorOperations::clear(dest + pos, numSamples - pos);
+                return;
+            case env_sustain:
+                FloatVectorOperations::fill(dest + pos, (float)sustainLevel, numSamples - pos);
+                return;
+            case env_attack:
+                pos += renderSegment(dest + pos, numSamples - pos, attackBase, attackCoef, 1.0, env_decay);
+                break;
+            case env_decay:
+                pos += renderSegment(dest + pos, numSamples - pos, decayBase, decayCoef, sustainLevel, env_sustain);
+                break;
+            case env_release:
+                pos += renderSegment(dest + pos, numSamples - pos, releaseBase, releaseCoef, 0.0, env_idle);
+                break;
+        }
+    }
+}
+
+// output = base + output * coef converges to base / (1 - coef), the distance to it shrinks by coef at each sample.
+// That gives the sample where the threshold is crossed, and the values up to it without the per sample branch.
+int CurvedADSR::renderSegment(float* dest, int numSamples, double base, double coef, double threshold, int nextState)
+{
+    double target = base / (1.0 - coef);
+    double distance = output - target;
+    double ratio = distance != 0 ? (threshold - target) / distance : 0;
+
+    int numToThreshold = numSamples + 1; //never crosses in this block
+    if (coef <= 0 || ratio >= 1) numToThreshold = 1; //instant segment, or already past the threshold
+    else if (ratio > 0) numToThreshold = jmax(1, (int)std::ceil(std::log(ratio) / std::log(coef) - 1e-9));
+
+    int num = jmin(numSamples, numToThreshold);
+
+    //distance * coef^(i+1), four independent chains so the loop vectorizes
+    float coef4 = (float)(coef * coef * coef * coef);
+    double d = distance;
+    for (int i = 0; i < jmin(num, 4); i++)
+    {
+        d *= coef;
+        dest[i] = (float)d;
+    }
+    for (int i = 4; i < num; i++) dest[i] = dest[i - 4] * coef4;
+    FloatVectorOperations::add(dest, (float)target, num);
+
+    if (num == numToThreshold)
+    {
+        dest[num - 1] = (float)threshold;
+        output = threshold;
+        state = nextState;
+    }
+    else
+    {
+        output = target + distance * std::pow(coef, (double)num); //from the double state, float rounding doesn't build up over blocks
+    }
+
+    return num;
+}
+
 void CurvedADSR::applyEnvelopeToBuffer(AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
     jassert(startSample + numSamples <= buffer.getNumSamples());
@@ -94,16 +158,15 @@ void CurvedADSR::applyEnvelopeToBuffer(AudioBuffer<float>& buffer, int startSamp
         return;
     }
 
-    auto numChannels = buffer.getNumChannels();
-
-    while (--numSamples >= 0)
+    float env[256];
+    while (numSamples > 0)
     {
-        process();
-        auto env = getOutput();
-
-        for (int i = 0; i < numChannels; ++i)
-            buffer.getWritePointer(i)[startSample] *= env;
+        int num = jmin(numSamples, 256);
+        renderEnvelope(env, num);
+        for (int i = 0; i < buffer.getNumChannels(); ++i)
+            FloatVectorOperations::multiply(buffer.getWritePointer(i, startSample), env, num);
 
-        ++startSample;
+        startSample += num;
+        numSamples -= num;
     }
 }
@@ -27,6 +27,7 @@ public:
 	CurvedADSR(void);
 	~CurvedADSR(void);
 	double process(void);
+    void renderEnvelope(float* dest, int numSamples); //same values as calling process() numSamples times, a segment at a time
     void applyEnvelopeToBuffer(AudioBuffer<float>& buffer, int startSample, int numSamples);
     double getOutput(void);
     int getState(void);
@@ -64,6 +65,7 @@ protected:
     double releaseBase;
  
     double calcCoef(double rate, double targetRatio);
+    int renderSegment(float* dest, int numSamples, double base, double coef, double threshold, int nextState);
 };
 
 inline double CurvedADSR::process() {
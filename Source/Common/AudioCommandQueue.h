@@ -0,0 +1,27 @@
+/*
+  ==============================================================================
+
+	AudioCommandQueue.h
+	Created: 17 Oct 2026 3:05:12pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* A control change sent to the audio thread. type and index are up to the receiver (usually an enum of the node + a note / track / item index).
+   timestamp is a Transport sample position, the command is applied in the block that contains it, or in the next block if it is -1.
+*/
+struct AudioCommand
+{
+	int type = 0;
+	int index = 0;
+	float value = 0;
+	int64 timestamp = -1;
+};
+
+/* Bounded lock-free queue of AudioCommands, any number of producers (message thread, OSC / MIDI threads, preset transitions)
+   and one consumer (the audio thread). Nothing allocates after construction, and push() never blocks : if the queue is full it returns false.
+*/
+typedef LockFreeQueue<AudioCommand> AudioCommandQueue;
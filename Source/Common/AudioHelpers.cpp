@@ -109,6 +109,7 @@ float DecibelsHelpers::gainToValue(float gain)
 VolumeControl::VolumeControl(const String& name, bool hasRMS) :
 	ControllableContainer(name),
 	prevGain(1),
+	audioGain(0),
 	rms(nullptr),
 	computeRMS(nullptr),
 	rmsSampleCount(0),
@@ -128,6 +129,8 @@ VolumeControl::VolumeControl(const String& name, bool hasRMS) :
 		rms->hideInRemoteControl = true; //hide by default
 		rms->defaultHideInRemoteControl = true; //hide by default
 	}
+
+	audioGain = getGain();
 }
 
 VolumeControl::~VolumeControl()
@@ -140,6 +143,13 @@ float VolumeControl::getGain()
 	return active->boolValue() ? gain->gain : 0;
 }
 
+float VolumeControl::getGainForValue(Parameter* p, float value)
+{
+	if (p == gain) return active->boolValue() ? DecibelsHelpers::valueToGain(value) : 0;
+	if (p == active) return value > 0 ? gain->gain : 0;
+	return getGain();
+}
+
 void VolumeControl::resetGainAndActive()
 {
 	gain->resetValue();
@@ -148,7 +158,7 @@ void VolumeControl::resetGainAndActive()
 
 void VolumeControl::applyGain(AudioSampleBuffer& buffer)
 {
-	float g = getGain();
+	float g = audioGain;
 	buffer.applyGainRamp(0, buffer.getNumSamples(), prevGain, g);
 	prevGain = g;
 
@@ -157,35 +167,128 @@ void VolumeControl::applyGain(AudioSampleBuffer& buffer)
 
 void VolumeControl::applyGain(int channel, AudioSampleBuffer& buffer)
 {
-	float g = getGain();
+	float g = audioGain;
 	buffer.applyGainRamp(channel, 0, buffer.getNumSamples(), prevGain, g);
 	prevGain = g;
 
 	updateRMS(buffer, channel);
 }
 
+bool VolumeControl::shouldComputeRMS() const
+{
+	return rms != nullptr && (computeRMS == nullptr || computeRMS->boolValue());
+}
+
 void VolumeControl::updateRMS(AudioSampleBuffer& buffer, int channel, int startSample, int numSamples)
 {
-	if (computeRMS != nullptr && !computeRMS->boolValue()) return;
+	if (!shouldComputeRMS()) return;
 
 	if (numSamples == -1) numSamples = buffer.getNumSamples();
 
-	if (rms != nullptr)
+	float level = 0;
+	if (channel >= 0) level = buffer.getRMSLevel(channel, startSample, numSamples);
+	else
+	{
+		for (int i = 0; i < buffer.getNumChannels(); i++) level = jmax(buffer.getRMSLevel(i, startSample, numSamples), level);
+	}
+
+	updateRMSLevel(level, buffer.getNumSamples());
+}
+
+void VolumeControl::updateRMSLevel(float level, int numSamples)
+{
+	if (!shouldComputeRMS()) return;
+
+	rmsMax = jmax(level, rmsMax);
+
+	rmsSampleCount += numSamples;
+	if (rmsSampleCount > 3000) //~10fps @44100Hz
+	{
+		//float rmsGainVal = rms->gain + (rmsMax - rms->gain) * (rmsMax > rms->gain ? 1: .4f);
+		rms->setGain(rmsMax);
+
+		rmsSampleCount = 0;
+		rmsMax = 0;
+	}
+}
+
+
+void GainMatrixHelpers::mixInputIntoTile(const float* input, float* const* tile, float* currentGains, const float* targetGains, uint8 mask, int numSamples)
+{
+	const float* __restrict in = input;
+	const float inc = 1.0f / numSamples;
+
+	if (mask == (1 << tileSize) - 1)
 	{
-		if (channel >= 0) rmsMax = jmax(buffer.getRMSLevel(channel, startSample, numSamples), rmsMax);
-		else
+		//full tile, one pass over the input for the 4 outputs, written so the compiler vectorizes it
+		float* __restrict t0 = tile[0];
+		float* __restrict t1 = tile[1];
+		float* __restrict t2 = tile[2];
+		float* __restrict t3 = tile[3];
+
+		const float g0 = currentGains[0], d0 = (targetGains[0] - g0) * inc;
+		const float g1 = currentGains[1], d1 = (targetGains[1] - g1) * inc;
+		const float g2 = currentGains[2], d2 = (targetGains[2] - g2) * inc;
+		const float g3 = currentGains[3], d3 = (targetGains[3] - g3) * inc;
+
+		for (int i = 0; i < numSamples; i++)
 		{
-			for (int i = 0; i < buffer.getNumChannels(); i++) rmsMax = jmax(buffer.getRMSLevel(i, startSample, numSamples), rmsMax);
+			const float x = in[i];
+			const float fi = (float)i;
+			t0[i] += x * (g0 + d0 * fi);
+			t1[i] += x * (g1 + d1 * fi);
+			t2[i] += x * (g2 + d2 * fi);
+			t3[i] += x * (g3 + d3 * fi);
 		}
 
-		rmsSampleCount += buffer.getNumSamples();
-		if (rmsSampleCount > 3000) //~10fps @44100Hz
-		{
-			//float rmsGainVal = rms->gain + (rmsMax - rms->gain) * (rmsMax > rms->gain ? 1: .4f);
-			rms->setGain(rmsMax);
+		for (int k = 0; k < tileSize; k++) currentGains[k] = targetGains[k];
+		return;
+	}
+
+	for (int k = 0; k < tileSize; k++)
+	{
+		if ((mask & (1 << k)) == 0) continue;
+
+		float* __restrict t = tile[k];
+		const float g = currentGains[k], d = (targetGains[k] - g) * inc;
+
+		if (d == 0) FloatVectorOperations::addWithMultiply(t, in, g, numSamples);
+		else for (int i = 0; i < numSamples; i++) t[i] += in[i] * (g + d * (float)i);
+
+		currentGains[k] = targetGains[k];
+	}
+}
+
+float GainMatrixHelpers::applyRampAndGetSumOfSquares(float* data, float startGain, float endGain, int numSamples, bool computeSum)
+{
+	float* __restrict d = data;
+	const float inc = (endGain - startGain) / numSamples;
+
+	if (!computeSum)
+	{
+		for (int i = 0; i < numSamples; i++) d[i] *= startGain + inc * (float)i;
+		return 0;
+	}
 
-			rmsSampleCount = 0;
-			rmsMax = 0;
+	//4 partial sums so the reduction vectorizes without relaxed float math
+	float sums[4] = { 0, 0, 0, 0 };
+	int i = 0;
+	for (; i + 4 <= numSamples; i += 4)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			float v = d[i + j] * (startGain + inc * (float)(i + j));
+			d[i + j] = v;
+			sums[j] += v * v;
 		}
 	}
-}
\ No newline at end of file
+
+	for (; i < numSamples; i++)
+	{
+		float v = d[i] * (startGain + inc * (float)i);
+		d[i] = v;
+		sums[0] += v * v;
+	}
+
+	return sums[0] + sums[1] + sums[2] + sums[3];
+}
@@ -51,6 +51,7 @@ public:
     virtual ~VolumeControl();
 
     float prevGain;
+    float audioGain; //copy of getGain() read by the audio thread, kept up to date by the node that owns this (see Node::audioVolumes)
     DecibelFloatParameter* gain;
     DecibelFloatParameter* rms;
     BoolParameter* active;
@@ -60,10 +61,25 @@ public:
     float rmsMax;
 
     virtual float getGain();
+    float getGainForValue(Parameter* p, float value); //what getGain() returns when p (gain or active) has this value
     virtual void resetGainAndActive();
 
     virtual void applyGain(AudioSampleBuffer& buffer);
     virtual void applyGain(int channel, AudioSampleBuffer& buffer);
 
+    bool shouldComputeRMS() const;
     virtual void updateRMS(AudioSampleBuffer& buffer, int channel = -1, int startSample = 0, int numSamples = -1);
+    void updateRMSLevel(float level, int numSamples); //when the level is already computed by the caller
+};
+
+/* Kernels for gain matrices (mixer, spat), outputs are processed in tiles of tileSize channels
+   so each input is read once per tile. Gains ramp linearly from currentGains to targetGains over the block. */
+class GainMatrixHelpers
+{
+public:
+    static const int tileSize = 4;
+
+    //mask has one bit per output of the tile to process, currentGains is set to targetGains for those
+    static void mixInputIntoTile(const float* input, float* const* tile, float* currentGains, const float* targetGains, uint8 mask, int numSamples);
+    static float applyRampAndGetSumOfSquares(float* data, float startGain, float endGain, int numSamples, bool computeSum);
 };
\ No newline at end of file
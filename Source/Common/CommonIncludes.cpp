@@ -14,9 +14,15 @@
 #include "AudioHelpers.cpp"
 #include "AudioUIHelpers.cpp"
 #include "ConnectionUIHelper.cpp"
+#include "ScratchBufferPool.cpp"
+#include "RTChecker.cpp"
+#include "ProcessTimeProfiler.cpp"
+#include "MIDI/MIDISyncOutput.cpp"
+#include "MIDI/MIDISyncInput.cpp"
 #include "MIDI/MIDIClock.cpp"
 #include "MIDI/MIDIDevice.cpp"
 #include "MIDI/MIDIDeviceParameter.cpp"
+#include "MIDI/MIDIInputQueue.cpp"
 #include "MIDI/MIDIManager.cpp"
 #include "MIDI/MTCReceiver.cpp"
 #include "MIDI/MTCSender.cpp"
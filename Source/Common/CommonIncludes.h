@@ -20,7 +20,10 @@
 #include "MIDI/MIDIDevice.h"
 #include "MIDI/MIDIManager.h"
 #include "MIDI/MIDIDeviceParameter.h"
+#include "MIDI/MIDIInputQueue.h"
 
+#include "MIDI/MIDISyncOutput.h"
+#include "MIDI/MIDISyncInput.h"
 #include "MIDI/MIDIClock.h"
 
 
@@ -31,6 +34,11 @@
 #include "MIDI/ui/MIDIDeviceParameterUI.h"
 
 #include "RingBuffer.h"
+#include "LockFreeQueue.h"
+#include "AudioCommandQueue.h"
+#include "ScratchBufferPool.h"
+#include "RTChecker.h"
+#include "ProcessTimeProfiler.h"
 
 #include "Serial/SerialDevice.h"
 #include "Serial/SerialManager.h"
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+	LockFreeQueue.h
+	Created: 17 Oct 2026 9:52:40pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Bounded lock-free queue, any number of producers and one consumer (D. Vyukov's bounded MPMC queue, with a single reader).
+   Elements are copied into preallocated cells : nothing allocates after construction as long as copying an element doesn't,
+   so keep them plain data. push() never blocks, if the queue is full it returns false.
+*/
+template <class ElementType>
+class LockFreeQueue
+{
+public:
+	LockFreeQueue(int capacity = 256) :
+		enqueuePos(0),
+		dequeuePos(0)
+	{
+		uint32 size = (uint32)nextPowerOfTwo(jmax(capacity, 2));
+		mask = size - 1;
+		cells.reset(new Cell[size]);
+		for (uint32 i = 0; i < size; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	bool push(const ElementType& element)
+	{
+		//each cell has a sequence number telling if it's free for this lap (== pos) or still holding an unread element
+		uint32 pos = enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = cells[pos & mask];
+			int32 diff = (int32)(cell.sequence.load(std::memory_order_acquire) - pos);
+
+			if (diff == 0)
+			{
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.element = element;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) return false; //full
+			else pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	//consumer thread only
+	bool pop(ElementType& element)
+	{
+		Cell& cell = cells[dequeuePos & mask];
+		if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) return false; //empty, or not written yet
+
+		element = cell.element;
+		cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+		dequeuePos++;
+		return true;
+	}
+
+	int getCapacity() const { return (int)mask + 1; }
+
+private:
+	struct Cell
+	{
+		std::atomic<uint32> sequence;
+		ElementType element;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	uint32 mask;
+	std::atomic<uint32> enqueuePos;
+	uint32 dequeuePos;
+
+	JUCE_DECLARE_NON_COPYABLE(LockFreeQueue)
+};
@@ -18,64 +18,30 @@
 
 #pragma once
 
-
-constexpr int MIDI_SYNC_QUEUE_SIZE = 100;
-
+/* Outgoing MIDI clock, 24 ticks per beat, with start / stop / continue and song position pointer.
+   Ticks are placed on the transport's sample grid for each audio block, so they follow the rendered audio exactly.
+   A jump of the transport (seek, restart) is sent as stop / song position / continue, on the next sixteenth.
+*/
 class MIDIClock :
-    public Transport::TransportListener
+	public MIDISyncOutput
 {
 public:
-    MIDIClock(bool sendSPP);
-    ~MIDIClock();
-
-    bool start();
-    void stop();
-    bool setOutput(MIDIOutputDevice * _midiOut);
-    void reset();
-
-    bool sendSPP;
-    float delta;
-    
-    bool isRunning();
-private:
-    static double sendAllClocks();
-    double runClock();
-
-    MidiMessage nextMidiMsg;
-    MIDIOutputDevice * midiOut;
+	MIDIClock(bool sendSPP);
+	~MIDIClock();
 
-    bool hasSentMessage = false;
-    
-    friend class MIDIClockRunner;
-    Atomic<bool> _isRunning = false;
-    // TimeManager Listener
+	bool sendSPP;
 
-     void bpmChanged () override;
-     virtual void beatChanged(bool isNewBar); //this allow for event after both bar and beat have been updated
-     virtual void playStateChanged(bool isPlaying, bool forceRestart);
+	static const int ticksPerBeat = 24;
 
-    void addClockIfNeeded(double & timeToNextMessage);
-    int appendCurrentSPP();
-    
-    double getPPQWithDelta(int multiplier);
-    static double ppqToTime(double ppq,int multiplier);
-    void appendOneMsg(const MidiMessage & msg);
-    void appendClocks(const int num);
-    MidiMessage  messagesToSend[MIDI_SYNC_QUEUE_SIZE];
-    AbstractFifo midiFifo;
-
-    private :
-    struct MIDIClockState{
-        MIDIClockState():isPlaying(false),ppqn(0){}
-        bool isPlaying;
-        Atomic<int> ppqn; // has to be an integer type (same resolution as device)
+protected:
+	void processSyncBlock(int64 blockStartSample, int numSamples, bool isPlaying) override;
+	void resetSync() override;
 
+private:
+	//audio thread
+	bool wasPlaying;
+	double expectedTick; //where the next block should start if the transport didn't jump
+	int64 nextTick;
 
-    };
-    MIDIClockState state;
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MIDIClock)
-    
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MIDIClock)
 };
-
-
-
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+	MIDIInputQueue.cpp
+	Created: 17 Oct 2026 9:26:04pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Common/CommonIncludes.h"
+
+MIDIInputQueue::MIDIInputQueue() :
+	fifo(queueSize)
+{
+}
+
+MIDIInputQueue::~MIDIInputQueue()
+{
+}
+
+bool MIDIInputQueue::push(const MidiMessage& message)
+{
+	int size = message.getRawDataSize();
+	if (size <= 0 || size > 3) return false;
+
+	//driver timestamps are on the millisecond counter, in seconds
+	double timeMS = message.getTimeStamp() > 0 ? message.getTimeStamp() * 1000 : Time::getMillisecondCounterHiRes();
+
+	const SpinLock::ScopedLockType sl(writeLock);
+
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 == 0) return false;
+
+	Item& item = items[start1];
+	item.timeMS = timeMS;
+	item.size = (uint8)size;
+	memcpy(item.data, message.getRawData(), size);
+
+	fifo.finishedWrite(1);
+	return true;
+}
+
+void MIDIInputQueue::removeNextBlockOfMessages(MidiBuffer& dest, int numSamples, double sampleRate, double blockTimeMS)
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+	//the previous device period, mapped onto this block
+	double periodStartMS = blockTimeMS - numSamples * 1000.0 / sampleRate;
+
+	int numRead = 0;
+	for (int i = 0; i < size1 + size2; i++)
+	{
+		const Item& item = items[i < size1 ? start1 + i : start2 + i - size1];
+		if (item.timeMS >= blockTimeMS) break; //received during this callback, for the next block
+
+		int sample = jlimit(0, numSamples - 1, roundToInt((item.timeMS - periodStartMS) * sampleRate / 1000.0));
+		dest.addEvent(item.data, item.size, sample);
+		numRead++;
+	}
+
+	fifo.finishedRead(numRead);
+}
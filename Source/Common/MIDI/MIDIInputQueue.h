@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+	MIDIInputQueue.h
+	Created: 17 Oct 2026 9:26:04pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Incoming MIDI for a node, keeping the time each message was received.
+
+   MIDI threads push short messages with their driver timestamp, the audio thread takes the ones received before the
+   current device callback and places them one block later, at the same distance from each other as when they were played.
+   This is a constant latency of one block instead of every message landing at the start of the block.
+   Nothing is allocated, long messages (sysex) are refused and go through the node's MidiMessageCollector.
+*/
+class MIDIInputQueue
+{
+public:
+	MIDIInputQueue();
+	~MIDIInputQueue();
+
+	//MIDI threads, false if the message is too long or the queue is full
+	bool push(const MidiMessage& message);
+
+	//audio thread. blockTimeMS is the time of the current device callback, on the millisecond counter
+	void removeNextBlockOfMessages(MidiBuffer& dest, int numSamples, double sampleRate, double blockTimeMS);
+
+private:
+	struct Item
+	{
+		double timeMS;
+		uint8 data[3];
+		uint8 size;
+	};
+
+	static const int queueSize = 1024;
+	Item items[queueSize];
+	AbstractFifo fifo;
+	SpinLock writeLock; //several interfaces can push at the same time, the fifo has a single writer
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MIDIInputQueue)
+};
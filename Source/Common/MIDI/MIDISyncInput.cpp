@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+	MIDISyncInput.cpp
+	Created: 17 Oct 2026 8:03:51pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Common/CommonIncludes.h"
+
+void MIDISyncInput::DLL::reset(double time, double nominalPeriod, double bw)
+{
+	double omega = 2 * double_Pi * bw * nominalPeriod / 1000.0;
+	b = std::sqrt(2.0) * omega;
+	c = omega * omega;
+	t0 = time;
+	t1 = time + nominalPeriod;
+	period = nominalPeriod;
+	count = 1;
+}
+
+void MIDISyncInput::DLL::update(double time)
+{
+	double e = time - t1;
+	t0 = t1;
+	t1 += b * e + period;
+	period += c * e;
+	count++;
+}
+
+MIDISyncInput::MIDISyncInput() :
+	mode(CLOCK),
+	active(false),
+	isPlaying(false),
+	startPending(false),
+	tickIndex(0),
+	nextTickIndex(0),
+	numConsecutivePieces(0),
+	lastPiece(-1),
+	fps(25),
+	hasPosition(false),
+	quarterIndex(0),
+	lastTickTime(0)
+{
+	for (int i = 0; i < 8; i++) pieces[i] = 0;
+}
+
+MIDISyncInput::~MIDISyncInput()
+{
+	setActive(false);
+}
+
+void MIDISyncInput::setMode(Mode newMode)
+{
+	const SpinLock::ScopedLockType sl(lock);
+	if (mode == newMode) return;
+	mode = newMode;
+	dll.count = 0;
+	isPlaying = false;
+	hasPosition = false;
+	numConsecutivePieces = 0;
+}
+
+void MIDISyncInput::setActive(bool value)
+{
+	if (active == value) return;
+	active = value;
+
+	{
+		const SpinLock::ScopedLockType sl(lock);
+		dll.count = 0;
+		isPlaying = false;
+		startPending = false;
+		hasPosition = false;
+		numConsecutivePieces = 0;
+	}
+
+	if (active)
+	{
+		Transport::getInstance()->setSyncSource(this);
+		startTimer(100);
+	}
+	else
+	{
+		stopTimer();
+		if (Transport* t = Transport::getInstanceWithoutCreating()) t->removeSyncSource(this);
+	}
+}
+
+bool MIDISyncInput::isLocked()
+{
+	const SpinLock::ScopedLockType sl(lock);
+	return dll.count >= minTicksToLock && (mode == CLOCK || hasPosition);
+}
+
+double MIDISyncInput::getEstimatedBPM()
+{
+	const SpinLock::ScopedLockType sl(lock);
+	if (mode != CLOCK || dll.period <= 0) return 0;
+	return 60000.0 / (dll.period * ticksPerBeat);
+}
+
+double MIDISyncInput::getNominalPeriod() const
+{
+	if (mode == MTC) return 1000.0 / (fps * 4);
+	return dll.period > 0 ? dll.period : 60000.0 / (120 * ticksPerBeat);
+}
+
+bool MIDISyncInput::handleMessage(const MidiMessage& message)
+{
+	//driver timestamps are on the millisecond counter, in seconds
+	double time = message.getTimeStamp() > 0 ? message.getTimeStamp() * 1000 : Time::getMillisecondCounterHiRes();
+
+	const SpinLock::ScopedLockType sl(lock);
+
+	if (mode == CLOCK)
+	{
+		if (message.isMidiClock()) handleTick(time);
+		else if (message.isMidiStart())
+		{
+			nextTickIndex = 0;
+			startPending = true;
+		}
+		else if (message.isMidiContinue()) startPending = true;
+		else if (message.isMidiStop())
+		{
+			isPlaying = false;
+			startPending = false;
+		}
+		else if (message.isSongPositionPointer()) nextTickIndex = message.getSongPositionPointerMidiBeat() * 6; //in sixteenths
+		else return false;
+
+		return true;
+	}
+
+	if (message.isQuarterFrame())
+	{
+		handleQuarterFrame(time, message.getQuarterFrameSequenceNumber(), message.getQuarterFrameValue());
+		return true;
+	}
+
+	if (message.isFullFrame())
+	{
+		handleFullFrame(message);
+		return true;
+	}
+
+	return false;
+}
+
+void MIDISyncInput::handleTick(double time)
+{
+	//a gap of a few ticks means the master paused or the cable was pulled, the old period is meaningless
+	if (dll.count == 0 || time - lastTickTime > getNominalPeriod() * 4) dll.reset(time, getNominalPeriod(), bandwidthHz);
+	else dll.update(time);
+	lastTickTime = time;
+
+	if (startPending)
+	{
+		isPlaying = true;
+		startPending = false;
+	}
+
+	if (isPlaying) tickIndex = nextTickIndex++;
+}
+
+void MIDISyncInput::handleQuarterFrame(double time, int piece, int value)
+{
+	if (dll.count == 0 || time - lastTickTime > getNominalPeriod() * 8) dll.reset(time, getNominalPeriod(), bandwidthHz);
+	else dll.update(time);
+	lastTickTime = time;
+
+	numConsecutivePieces = (piece == (lastPiece + 1) % 8) ? numConsecutivePieces + 1 : 1;
+	lastPiece = piece;
+	pieces[piece] = value;
+
+	if (hasPosition) quarterIndex++;
+
+	if (piece == 7 && numConsecutivePieces >= 8)
+	{
+		static const int rates[4] = { 24, 25, 30, 30 }; //29.97 drop frame counts as 30 here, the drift is handled by the loop
+		fps = rates[(pieces[7] >> 1) & 3];
+
+		int hours = pieces[6] | ((pieces[7] & 1) << 4);
+		int minutes = pieces[4] | (pieces[5] << 4);
+		int seconds = pieces[2] | (pieces[3] << 4);
+		int frames = pieces[0] | (pieces[1] << 4);
+
+		//the timecode of a full group is the one of its first quarter frame, seven quarter frames ago
+		int64 frameIndex = ((hours * 60 + minutes) * 60 + seconds) * (int64)fps + frames;
+		quarterIndex = frameIndex * 4 + 7;
+		hasPosition = true;
+	}
+
+	isPlaying = hasPosition;
+}
+
+void MIDISyncInput::handleFullFrame(const MidiMessage& message)
+{
+	int hours, minutes, seconds, frames;
+	MidiMessage::SmpteTimecodeType type;
+	message.getFullFrameParameters(hours, minutes, seconds, frames, type);
+
+	static const int rates[4] = { 24, 25, 30, 30 };
+	fps = rates[(int)type & 3];
+
+	int64 frameIndex = ((hours * 60 + minutes) * 60 + seconds) * (int64)fps + frames;
+	quarterIndex = frameIndex * 4 - 1; //the next quarter frame is the first one of this frame
+	hasPosition = true;
+	isPlaying = false; //full frames are sent on locate, quarter frames follow when it plays
+	numConsecutivePieces = 0;
+	dll.count = 0;
+}
+
+bool MIDISyncInput::getSyncPosition(double timeMS, bool& playing, double& positionInBeats)
+{
+	const SpinLock::ScopedTryLockType sl(lock);
+	if (!sl.isLocked()) return false;
+
+	Transport* t = Transport::getInstance();
+
+	if (mode == CLOCK)
+	{
+		if (dll.count < minTicksToLock) return false;
+
+		//a master that stopped sending clocks is gone, not stopped
+		if (timeMS - lastTickTime > getNominalPeriod() * 4 + 1000) return false;
+
+		playing = isPlaying;
+		double ticks = isPlaying ? tickIndex + jlimit(0.0, 2.0, (timeMS - dll.t0) / dll.period) : (double)nextTickIndex;
+		positionInBeats = ticks / ticksPerBeat; //the master's own beats, whatever the tempo of the transport
+		return true;
+	}
+
+	if (!hasPosition || t->numSamplesPerBeat <= 0) return false;
+
+	bool running = isPlaying && dll.count >= minTicksToLock && timeMS - lastTickTime < getNominalPeriod() * 8;
+	playing = running;
+
+	double quarters = (double)quarterIndex;
+	if (running) quarters += jlimit(0.0, 2.0, (timeMS - dll.t0) / dll.period);
+	positionInBeats = quarters / (fps * 4) * t->sampleRate / t->numSamplesPerBeat; //timecode is in seconds, counted in the transport's beats
+	return true;
+}
+
+void MIDISyncInput::timerCallback()
+{
+	if (mode != CLOCK || !isLocked()) return;
+
+	Transport* t = Transport::getInstance();
+	if (t->sampleRate <= 0 || t->blockSize <= 0) return;
+
+	double estimatedBPM = getEstimatedBPM();
+	if (estimatedBPM <= 0) return;
+
+	//only move the tempo when it lands on another block-perfect beat length, the phase is corrected by the transport meanwhile
+	int rawSamplesPerBeat = roundToInt(t->sampleRate * 60.0 / estimatedBPM);
+	int targetSamplesPerBeat = rawSamplesPerBeat - rawSamplesPerBeat % t->blockSize;
+	if (targetSamplesPerBeat == t->numSamplesPerBeat) return;
+	if (std::abs(estimatedBPM - t->bpm->doubleValue()) < t->bpm->doubleValue() * .001) return;
+
+	t->bpm->setValue(roundToInt(estimatedBPM * 100) / 100.0);
+}
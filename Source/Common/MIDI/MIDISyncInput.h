@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+	MIDISyncInput.h
+	Created: 17 Oct 2026 8:03:51pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Follows an external MIDI clock or MTC master, so the transport can sit under a hardware sequencer.
+
+   Incoming ticks (clocks or quarter frames) are timestamped by the MIDI driver, and a second order delay-locked loop
+   runs over those times : it filters out the jitter of the MIDI transport and gives a smooth period and tick phase.
+   The transport asks for the master's position in beats at each audio block, and corrects its phase by whole blocks when a bar starts.
+   The tempo (clock only) is applied on the message thread through the BPM parameter, so beat lengths stay block-perfect.
+*/
+class MIDISyncInput :
+	public Transport::SyncSource,
+	public Timer
+{
+public:
+	enum Mode { CLOCK, MTC };
+
+	MIDISyncInput();
+	~MIDISyncInput();
+
+	void setMode(Mode mode);
+	void setActive(bool active); //makes it the transport's sync source
+	bool isActive() const { return active.load(); }
+
+	bool isLocked();
+	double getEstimatedBPM();
+
+	//MIDI thread, returns true if the message was a sync message
+	bool handleMessage(const MidiMessage& message);
+
+	//audio thread
+	bool getSyncPosition(double timeMS, bool& isPlaying, double& positionInBeats) override;
+
+	void timerCallback() override;
+
+private:
+	//Delay-locked loop over tick times, in ms (F. Adriaensen, "Using a DLL to filter time")
+	struct DLL
+	{
+		double b = 0;
+		double c = 0;
+		double t0 = 0; //filtered time of the last tick
+		double t1 = 0; //predicted time of the next one
+		double period = 0;
+		int count = 0;
+
+		void reset(double time, double nominalPeriod, double bandwidthHz);
+		void update(double time);
+	};
+
+	static constexpr double bandwidthHz = 1.0;
+	static const int ticksPerBeat = 24;
+	static const int minTicksToLock = 24; //one beat of clock, 6 frames of MTC
+
+	SpinLock lock; //MIDI thread writes, audio thread tries
+	Mode mode;
+	std::atomic<bool> active;
+	DLL dll;
+
+	//clock
+	bool isPlaying;
+	bool startPending; //start / continue apply with the next clock
+	int64 tickIndex; //position of the last clock, in ticks
+	int64 nextTickIndex;
+
+	//MTC
+	int pieces[8];
+	int numConsecutivePieces;
+	int lastPiece;
+	int fps;
+	bool hasPosition;
+	int64 quarterIndex; //position of the last quarter frame, in quarter frames
+
+	double lastTickTime;
+
+	double getNominalPeriod() const;
+	void handleTick(double time);
+	void handleQuarterFrame(double time, int piece, int value);
+	void handleFullFrame(const MidiMessage& message);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MIDISyncInput)
+};
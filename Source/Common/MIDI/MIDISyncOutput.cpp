@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+	MIDISyncOutput.cpp
+	Created: 17 Oct 2026 7:14:22pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Common/CommonIncludes.h"
+
+static Array<MIDISyncOutput*, CriticalSection> allSyncOutputs;
+
+class MIDISyncRunner :
+	public Thread,
+	public DeletedAtShutdown
+{
+public:
+	MIDISyncRunner() :
+		Thread("MIDI Sync")
+	{
+		startThread(Thread::Priority::highest);
+	}
+
+	~MIDISyncRunner() { stopThread(100); }
+
+	void run() override
+	{
+		while (!threadShouldExit())
+		{
+			if (allSyncOutputs.isEmpty())
+			{
+				wait(1000); //woken up when an output is created
+				continue;
+			}
+
+			double nextTime = 0;
+			{
+				const ScopedLock sl(allSyncOutputs.getLock());
+				double now = Time::getMillisecondCounterHiRes();
+				for (auto& o : allSyncOutputs)
+				{
+					double t = o->sendDueMessages(now);
+					if (t > 0 && (nextTime == 0 || t < nextTime)) nextTime = t;
+				}
+			}
+
+			//wait() can't go under a millisecond, spin when the next message is closer than that
+			if (nextTime > 0 && nextTime - Time::getMillisecondCounterHiRes() < 1.5) Thread::yield();
+			else wait(1); //new messages come with every audio block, no need to be woken up
+		}
+	}
+};
+
+static MIDISyncRunner* getSyncRunner()
+{
+	static MIDISyncRunner* inst = nullptr;
+	if (inst == nullptr) inst = new MIDISyncRunner();
+	return inst;
+}
+
+MIDISyncOutput::MIDISyncOutput() :
+	latencyCompensationMS(0),
+	fifo(queueSize),
+	output(nullptr),
+	needsReset(true),
+	numDropped(0),
+	blockTimeMS(0)
+{
+	allSyncOutputs.add(this);
+	getSyncRunner()->notify();
+	Transport::getInstance()->addBlockListener(this);
+}
+
+MIDISyncOutput::~MIDISyncOutput()
+{
+	if (Transport* t = Transport::getInstanceWithoutCreating()) t->removeBlockListener(this);
+	allSyncOutputs.removeAllInstancesOf(this); //takes the runner's lock, it won't send from this one anymore
+}
+
+void MIDISyncOutput::setOutput(MIDIOutputDevice* device)
+{
+	const ScopedLock sl(allSyncOutputs.getLock()); //the previous device is not used after this
+	output = device;
+	needsReset = true;
+}
+
+void MIDISyncOutput::transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS)
+{
+	if (output.load() == nullptr) return;
+
+	Transport* t = Transport::getInstance();
+	if (t->sampleRate <= 0) return;
+
+	if (needsReset.exchange(false)) resetSync();
+
+	blockTimeMS = callbackTimeMS + t->outputLatencySamples * 1000.0 / t->sampleRate - latencyCompensationMS.load();
+	processSyncBlock(blockStartSample, numSamples, isPlaying);
+}
+
+MIDISyncOutput::TimedMessage* MIDISyncOutput::prepareMessage(int sampleOffset)
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 == 0)
+	{
+		numDropped++;
+		return nullptr;
+	}
+
+	TimedMessage* m = &queue[start1];
+	m->timeMS = blockTimeMS + sampleOffset * 1000.0 / Transport::getInstance()->sampleRate;
+	return m;
+}
+
+void MIDISyncOutput::pushMessage(const MidiMessage& message, int sampleOffset)
+{
+	jassert(message.getRawDataSize() <= 3); //longer messages would allocate on the audio thread
+
+	if (TimedMessage* m = prepareMessage(sampleOffset))
+	{
+		m->message = message;
+		m->isFullFrame = false;
+		fifo.finishedWrite(1);
+	}
+}
+
+void MIDISyncOutput::pushFullFrame(int hours, int minutes, int seconds, int frames, MidiMessage::SmpteTimecodeType type, int sampleOffset)
+{
+	if (TimedMessage* m = prepareMessage(sampleOffset))
+	{
+		m->isFullFrame = true;
+		m->fullFrame[0] = hours;
+		m->fullFrame[1] = minutes;
+		m->fullFrame[2] = seconds;
+		m->fullFrame[3] = frames;
+		m->timecodeType = type;
+		fifo.finishedWrite(1);
+	}
+}
+
+double MIDISyncOutput::sendDueMessages(double now)
+{
+	MIDIOutputDevice* device = output.load();
+
+	while (fifo.getNumReady() > 0)
+	{
+		int start1, size1, start2, size2;
+		fifo.prepareToRead(1, start1, size1, start2, size2);
+
+		TimedMessage& m = queue[start1];
+		if (m.timeMS > now) return m.timeMS;
+
+		if (device != nullptr)
+		{
+			if (m.isFullFrame) device->sendFullframeTimecode(m.fullFrame[0], m.fullFrame[1], m.fullFrame[2], m.fullFrame[3], m.timecodeType);
+			else device->sendMessage(m.message);
+		}
+
+		fifo.finishedRead(1);
+	}
+
+	int dropped = numDropped.exchange(0);
+	if (dropped > 0) LOGWARNING("MIDI sync output queue is full, " << dropped << " messages dropped");
+
+	return 0;
+}
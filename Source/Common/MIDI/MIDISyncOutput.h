@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+	MIDISyncOutput.h
+	Created: 17 Oct 2026 7:14:22pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Base for outgoing sync messages (MIDI clock, song position, MTC).
+
+   Messages are computed on the audio thread from the transport position of each device block, with the sample they belong to.
+   That sample is turned into the time it will be heard, using the device's output latency, minus the user's latency compensation,
+   and the message is pushed with that time in a lock-free queue.
+   A shared high priority thread sends every queued message when its time comes, so the external gear follows the rendered audio
+   instead of wall-clock polling.
+*/
+class MIDISyncOutput :
+	public Transport::BlockListener
+{
+public:
+	MIDISyncOutput();
+	virtual ~MIDISyncOutput();
+
+	//message thread
+	void setOutput(MIDIOutputDevice* device);
+	MIDIOutputDevice* getOutput() const { return output.load(); }
+	bool isRunning() const { return getOutput() != nullptr; }
+
+	std::atomic<float> latencyCompensationMS; //messages are sent this much earlier, for the latency of the MIDI interface and the receiving gear
+
+	void transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS) override;
+
+protected:
+	//audio thread, called for each block while an output is set
+	virtual void processSyncBlock(int64 blockStartSample, int numSamples, bool isPlaying) = 0;
+	virtual void resetSync() {} //the output changed, start over at the next block
+
+	void pushMessage(const MidiMessage& message, int sampleOffset); //short messages only, they are copied without allocating
+	void pushFullFrame(int hours, int minutes, int seconds, int frames, MidiMessage::SmpteTimecodeType type, int sampleOffset);
+
+private:
+	friend class MIDISyncRunner;
+
+	struct TimedMessage
+	{
+		double timeMS = 0;
+		MidiMessage message;
+		bool isFullFrame = false; //sysex, built on the sending thread
+		int fullFrame[4] = { 0, 0, 0, 0 };
+		MidiMessage::SmpteTimecodeType timecodeType = MidiMessage::fps30;
+	};
+
+	static const int queueSize = 512;
+	TimedMessage queue[queueSize];
+	AbstractFifo fifo;
+	std::atomic<MIDIOutputDevice*> output;
+	std::atomic<bool> needsReset;
+	std::atomic<int> numDropped;
+
+	double blockTimeMS; //audio thread, time at which the current block will be heard
+
+	TimedMessage* prepareMessage(int sampleOffset); //nullptr if the queue is full, finish with fifo.finishedWrite(1)
+
+	//sending thread, returns the time of the next message or 0 if the queue is empty
+	double sendDueMessages(double now);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MIDISyncOutput)
+};
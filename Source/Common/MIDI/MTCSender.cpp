@@ -1,143 +1,101 @@
 #include <math.h>
 
 MTCSender::MTCSender(MIDIOutputDevice* device) :
-	Thread("MTC"),
-	device(device),
-	speedFactor(1)
+	device(nullptr),
+	wasPlaying(false),
+	expectedQuarter(0),
+	nextQuarter(0)
 {
-	// In your constructor, you should add any child components, and
-	// initialise any special settings that your component needs.
-	if (device != nullptr) device->open();
-
-	frameTime = (1000.0 / fps / 4) / speedFactor;
+	setDevice(device);
 }
 
 MTCSender::~MTCSender()
 {
-	stopThread(10);
+	setDevice(nullptr);
 }
 
 void MTCSender::setDevice(MIDIOutputDevice * newDevice)
 {
 	if (newDevice == device) return;
-	
+
+	setOutput(nullptr);
 	if (device != nullptr) device->close();
 
 	device = newDevice;
 
 	if (device != nullptr) device->open();
+	setOutput(device);
 }
 
-void MTCSender::start(double position)
+void MTCSender::resetSync()
 {
-	setPosition(position);
-	startThread();
+	wasPlaying = false;
 }
 
-void MTCSender::pause(bool resumeIfAlreadyPaused)
+void MTCSender::processSyncBlock(int64 blockStartSample, int numSamples, bool isPlaying)
 {
-	if (isThreadRunning())
+	if (!isPlaying)
 	{
-		stopThread(10);
+		wasPlaying = false;
+		return;
 	}
-    else if(resumeIfAlreadyPaused)
-        startThread();
-}
-
-void MTCSender::stop()
-{
-	stopThread(10);
-}
 
-void MTCSender::setPosition(double position, bool fullFrame)
-{
-	if (device == nullptr) return; 
+	double samplesPerQuarter = Transport::getInstance()->sampleRate / (fps * 4.0);
+	double startQuarter = blockStartSample / samplesPerQuarter;
+	double endQuarter = (blockStartSample + numSamples) / samplesPerQuarter;
 
-	double unused;
-	lock.enter();
-	m_frame = static_cast<int>(modf(position, &unused) * fps);
-	m_second = static_cast<int>(position) % 60;
-	m_minute = (static_cast<int>(position) / 60) % 60;
-	m_hour = (static_cast<int>(position) / 60 / 60) % 60;
-	m_piece = Piece::FrameLSB;
-	lock.exit();
+	bool isJump = wasPlaying && std::abs(startQuarter - expectedQuarter) > 1;
+	if (!wasPlaying || isJump)
+	{
+		//a group of 8 quarter frames spans 2 frames and describes the frame it started on
+		nextQuarter = (int64)std::ceil(startQuarter / 8) * 8;
+		Timecode tc = getTimecode(nextQuarter / 4);
+		pushFullFrame(tc.hour, tc.minute, tc.second, tc.frame, fpsType, 0);
+	}
 
-	if(fullFrame) device->sendFullframeTimecode(m_hour, m_minute, m_second, m_frame, fpsType);
-}
+	while (nextQuarter < endQuarter)
+	{
+		int offset = jlimit(0, numSamples - 1, roundToInt(nextQuarter * samplesPerQuarter - blockStartSample));
+		Piece piece = static_cast<Piece>(nextQuarter % 8);
+		Timecode tc = getTimecode((nextQuarter / 8) * 2);
+		pushMessage(MidiMessage::quarterFrame(static_cast<int>(piece), getValue(piece, tc)), offset);
+		nextQuarter++;
+	}
 
-void MTCSender::setSpeedFactor(float speed)
-{
-	speedFactor = speed;
-	frameTime = (1000.0 / fps / 4) / speedFactor;
+	expectedQuarter = endQuarter;
+	wasPlaying = true;
 }
 
-void MTCSender::run()
+MTCSender::Timecode MTCSender::getTimecode(int64 frames) const
 {
-   if (device == nullptr) return;
-   
-   double lastFrameTime = Time::getMillisecondCounterHiRes();
-
-   while (!threadShouldExit())
-   {
-	   sleep(1);
-
-	   double t = Time::getMillisecondCounterHiRes();
-	   if (t < lastFrameTime + frameTime) continue;
-
-	   lastFrameTime += frameTime;
-
-	   lock.enter();
-
-		const int value = getValue(m_piece);
-		device->sendQuarterframe(static_cast<int>(m_piece), value);
-
-		m_piece = static_cast<Piece>((static_cast<int>(m_piece) + 1) % 8);
-
-		if (++m_quarter >= 4)
-		{
-			m_quarter = 0;
-			if (++m_frame >= fps)
-			{
-				m_frame = 0;
-				if (++m_second >= 60)
-				{
-					m_second = 0;
-					if (++m_minute >= 60)
-					{
-						m_minute = 0;
-						if (++m_hour >= 24)
-						{
-							m_hour = 0;
-						}
-					}
-				}
-			}
-		}
-
-		lock.exit();
-   }
-
+	Timecode tc;
+	int64 totalSeconds = frames / fps;
+	tc.frame = static_cast<int>(frames % fps);
+	tc.second = static_cast<int>(totalSeconds % 60);
+	tc.minute = static_cast<int>((totalSeconds / 60) % 60);
+	tc.hour = static_cast<int>((totalSeconds / 3600) % 24);
+	return tc;
 }
 
-int MTCSender::getValue(Piece piece)
+int MTCSender::getValue(Piece piece, const Timecode& tc) const
 {
     switch (piece) {
     case Piece::FrameLSB:
-        return m_frame & 0b1111;
+        return tc.frame & 0b1111;
     case Piece::FrameMSB:
-        return (m_frame >> 4) & 0b0001;
+        return (tc.frame >> 4) & 0b0001;
     case Piece::SecondLSB:
-        return m_second & 0b1111;
+        return tc.second & 0b1111;
     case Piece::SecondMSB:
-        return (m_second >> 4) & 0b0011;
+        return (tc.second >> 4) & 0b0011;
     case Piece::MinuteLSB:
-        return m_minute & 0b1111;
+        return tc.minute & 0b1111;
     case Piece::MinuteMSB:
-        return (m_minute >> 4) & 0b0011;
+        return (tc.minute >> 4) & 0b0011;
     case Piece::HourLSB:
-        return m_hour & 0b1111;
+        return tc.hour & 0b1111;
     case Piece::RateAndHourMSB:
-        return ((m_hour >> 4) & 0b0001) | ((0b00 | fpsType) << 1);
+        return ((tc.hour >> 4) & 0b0001) | ((0b00 | fpsType) << 1);
     }
 
     std::terminate();
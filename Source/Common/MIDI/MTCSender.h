@@ -1,23 +1,27 @@
 #pragma once
 
-class MTCSender : 
-	Thread
+/* Outgoing MIDI timecode, following the transport time.
+   Quarter frames are placed on the transport's sample grid for each audio block, so they follow the rendered audio exactly.
+   A full frame is sent when the transport starts playing or jumps, and quarter frames restart on the next group of 8.
+*/
+class MTCSender :
+	public MIDISyncOutput
 {
 public:
     MTCSender(MIDIOutputDevice* device = nullptr);
     ~MTCSender();
 
-
-    void setDevice(MIDIOutputDevice* newDevice);
-    void start(double position = 0);
-    void pause(bool resumeIfAlreadyPaused = true);
-    void stop();
-    void setPosition(double position, bool fullFrame = false);
-	void setSpeedFactor(float speed);
+    void setDevice(MIDIOutputDevice* newDevice); //opens and closes the device, when it's not managed elsewhere
 
 	MIDIOutputDevice* device;
 
-// Used only in separate thread!
+	const int fps = 30;
+	const MidiMessage::SmpteTimecodeType fpsType = MidiMessage::SmpteTimecodeType::fps30;
+
+protected:
+	void processSyncBlock(int64 blockStartSample, int numSamples, bool isPlaying) override;
+	void resetSync() override;
+
 private:
     enum class Piece {
         FrameLSB = 0,
@@ -30,27 +34,21 @@ private:
         RateAndHourMSB
     };
 
-    void run() override;
-    int getValue(Piece piece);
-
-	SpinLock lock;
-
-	float currentPosition;
-	float speedFactor;
-
-	double frameTime;
-	double lastFrameSendTime;
-
-	const int fps = 30;
-	const MidiMessage::SmpteTimecodeType fpsType = MidiMessage::SmpteTimecodeType::fps30;
-
-    Piece m_piece{Piece::FrameLSB};
-    int m_quarter{0};
-    int m_frame{0};
-    int m_second{0};
-    int m_minute{0};
-    int m_hour{0};
-    int m_deviceIndex{-1};
+	struct Timecode
+	{
+		int hour = 0;
+		int minute = 0;
+		int second = 0;
+		int frame = 0;
+	};
+
+	Timecode getTimecode(int64 frames) const;
+    int getValue(Piece piece, const Timecode& tc) const;
+
+	//audio thread
+	bool wasPlaying;
+	double expectedQuarter; //where the next block should start if the transport didn't jump
+	int64 nextQuarter;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MTCSender)
 };
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+	ProcessTimeProfiler.cpp
+	Created: 17 Oct 2026 11:48:20am
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Common/CommonIncludes.h"
+
+ProcessTimeProfiler::ProcessTimeProfiler() :
+	numMeasures(0)
+{
+	reset();
+	sortedTimes.ensureStorageAllocated(windowSize);
+}
+
+ProcessTimeProfiler::~ProcessTimeProfiler()
+{
+}
+
+void ProcessTimeProfiler::addMeasure(float timeMS)
+{
+	int index = numMeasures.fetch_add(1, std::memory_order_relaxed);
+	times[index % windowSize].store(timeMS, std::memory_order_relaxed);
+}
+
+void ProcessTimeProfiler::reset()
+{
+	for (auto& t : times) t.store(0, std::memory_order_relaxed);
+	numMeasures = 0;
+}
+
+ProcessTimeProfiler::Stats ProcessTimeProfiler::computeStats()
+{
+	Stats stats;
+	stats.numMeasures = jmin<int>(numMeasures.load(std::memory_order_relaxed), windowSize);
+	if (stats.numMeasures == 0) return stats;
+
+	sortedTimes.clearQuick();
+	for (int i = 0; i < stats.numMeasures; i++) sortedTimes.add(times[i].load(std::memory_order_relaxed));
+	sortedTimes.sort();
+
+	float sum = 0;
+	for (auto& t : sortedTimes) sum += t;
+
+	stats.min = sortedTimes.getFirst();
+	stats.avg = sum / stats.numMeasures;
+	stats.p99 = sortedTimes[jmin(stats.numMeasures - 1, (int)(stats.numMeasures * .99f))];
+	return stats;
+}
+
+ProcessTimeProfiler::ScopedMeasure::ScopedMeasure(ProcessTimeProfiler& profiler) :
+	profiler(profiler),
+	startTicks(Time::getHighResolutionTicks())
+{
+}
+
+ProcessTimeProfiler::ScopedMeasure::~ScopedMeasure()
+{
+	profiler.addMeasure((float)(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks) * 1000.0));
+}
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+	ProcessTimeProfiler.h
+	Created: 17 Oct 2026 11:48:20am
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Measures the wall time of a processing callback over a sliding window.
+   The audio thread only writes to a fixed array (ScopedMeasure), the message thread reads it back with computeStats(),
+   so min / avg / p99 can be shown without the audio side ever allocating or locking.
+*/
+class ProcessTimeProfiler
+{
+public:
+	ProcessTimeProfiler();
+	~ProcessTimeProfiler();
+
+	static const int windowSize = 256;
+
+	std::atomic<float> times[windowSize]; //in ms
+	std::atomic<int> numMeasures;
+	Array<float> sortedTimes; //message thread only
+
+	void addMeasure(float timeMS);
+	void reset();
+
+	struct Stats
+	{
+		float min = 0;
+		float avg = 0;
+		float p99 = 0;
+		int numMeasures = 0;
+	};
+
+	Stats computeStats();
+
+	class ScopedMeasure
+	{
+	public:
+		ScopedMeasure(ProcessTimeProfiler& profiler);
+		~ScopedMeasure();
+
+		ProcessTimeProfiler& profiler;
+		int64 startTicks;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedMeasure)
+	};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessTimeProfiler)
+};
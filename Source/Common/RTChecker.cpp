@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+	RTChecker.cpp
+	Created: 17 Oct 2026 11:02:47am
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Common/CommonIncludes.h"
+
+#if LGML_RT_CHECKS
+
+#if JUCE_LINUX && defined(__GLIBC__)
+#define RTCHECKER_HOOK_MALLOC 1
+#elif JUCE_WINDOWS && JUCE_DEBUG
+#include <crtdbg.h>
+#define RTCHECKER_CRT_HOOK 1
+#endif
+
+juce_ImplementSingleton(RTChecker)
+
+RTChecker::Event RTChecker::events[RTChecker::maxEvents];
+std::atomic<uint32> RTChecker::writeIndex{ 0 };
+std::atomic<uint32> RTChecker::droppedEvents{ 0 };
+
+static thread_local RTChecker::Scope* currentRTScope = nullptr;
+
+#if RTCHECKER_CRT_HOOK
+static int rtCheckerCrtAllocHook(int allocType, void*, size_t size, int blockType, long, const unsigned char*, int)
+{
+	if (blockType == _CRT_BLOCK) return TRUE; //CRT internal
+	if (allocType == _HOOK_FREE) RTChecker::notifyDeallocation();
+	else RTChecker::notifyAllocation(size);
+	return TRUE;
+}
+#endif
+
+RTChecker::RTChecker() :
+	readIndex(0)
+{
+#if RTCHECKER_CRT_HOOK
+	_CrtSetAllocHook(rtCheckerCrtAllocHook);
+#endif
+
+	LOG("Real-time checks are enabled, allocations and lock waits in the audio callback will be logged");
+	startTimer(500);
+}
+
+RTChecker::~RTChecker()
+{
+	stopTimer();
+#if RTCHECKER_CRT_HOOK
+	_CrtSetAllocHook(nullptr);
+#endif
+}
+
+RTChecker::Scope::Scope(const char* nodeName, const char* function) :
+	nodeName(nodeName),
+	function(function),
+	parent(currentRTScope)
+{
+	currentRTScope = this;
+}
+
+RTChecker::Scope::~Scope()
+{
+	currentRTScope = parent;
+}
+
+void RTChecker::notifyAllocation(size_t size)
+{
+	if (currentRTScope != nullptr) pushEvent(ALLOCATION, size, nullptr);
+}
+
+void RTChecker::notifyDeallocation()
+{
+	if (currentRTScope != nullptr) pushEvent(DEALLOCATION, 0, nullptr);
+}
+
+void RTChecker::notifyLockWait(const char* lockName)
+{
+	if (currentRTScope != nullptr) pushEvent(LOCK_WAIT, 0, lockName);
+}
+
+bool RTChecker::isInAudioScope()
+{
+	return currentRTScope != nullptr;
+}
+
+void RTChecker::pushEvent(EventType type, size_t size, const char* lockName)
+{
+	//no allocation allowed in here, we may be called from inside malloc
+	Scope* scope = currentRTScope;
+	currentRTScope = nullptr; //avoid reentrance
+
+	Event& e = events[writeIndex.fetch_add(1) % maxEvents];
+	if (e.ready.load(std::memory_order_acquire)) droppedEvents++;
+	else
+	{
+		e.type = type;
+		e.size = size;
+		e.function = scope->function;
+		e.lockName = lockName;
+		strncpy(e.nodeName, scope->nodeName != nullptr ? scope->nodeName : "", sizeof(e.nodeName) - 1);
+		e.ready.store(true, std::memory_order_release);
+	}
+
+	currentRTScope = scope;
+}
+
+void RTChecker::timerCallback()
+{
+	HashMap<String, int> counts;
+	StringArray keys;
+
+	for (;;)
+	{
+		Event& e = events[readIndex % maxEvents];
+		if (!e.ready.load(std::memory_order_acquire)) break;
+
+		String key = String(e.nodeName) + " > " + String(e.function) + " : ";
+		switch (e.type)
+		{
+		case ALLOCATION: key += "allocation"; break;
+		case DEALLOCATION: key += "deallocation"; break;
+		case LOCK_WAIT: key += "waited on " + String(e.lockName); break;
+		}
+
+		if (!counts.contains(key)) keys.add(key);
+		counts.set(key, counts[key] + 1);
+
+		e.ready.store(false, std::memory_order_release);
+		readIndex++;
+	}
+
+	for (auto& k : keys) LOGWARNING("[RT] " << k << " (x" << counts[k] << ")");
+
+	uint32 dropped = droppedEvents.exchange(0);
+	if (dropped > 0) LOGWARNING("[RT] " << (int)dropped << " more events were dropped");
+}
+
+
+//Allocation hooks
+#if RTCHECKER_HOOK_MALLOC
+extern "C"
+{
+	void* __libc_malloc(size_t);
+	void* __libc_calloc(size_t, size_t);
+	void* __libc_realloc(void*, size_t);
+	void __libc_free(void*);
+
+	void* malloc(size_t size) noexcept
+	{
+		RTChecker::notifyAllocation(size);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t num, size_t size) noexcept
+	{
+		RTChecker::notifyAllocation(num * size);
+		return __libc_calloc(num, size);
+	}
+
+	void* realloc(void* ptr, size_t size) noexcept
+	{
+		RTChecker::notifyAllocation(size);
+		return __libc_realloc(ptr, size);
+	}
+
+	void free(void* ptr) noexcept
+	{
+		if (ptr != nullptr) RTChecker::notifyDeallocation();
+		__libc_free(ptr);
+	}
+}
+#elif !RTCHECKER_CRT_HOOK
+void* operator new(size_t size)
+{
+	RTChecker::notifyAllocation(size);
+	if (void* p = std::malloc(size)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	RTChecker::notifyAllocation(size);
+	if (void* p = std::malloc(size)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr != nullptr) RTChecker::notifyDeallocation();
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	if (ptr != nullptr) RTChecker::notifyDeallocation();
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete[](ptr); }
+#endif
+
+#endif
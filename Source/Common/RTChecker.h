@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+	RTChecker.h
+	Created: 17 Oct 2026 11:02:47am
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Real-time safety checker, debug / profiling builds only.
+   Define LGML_RT_CHECKS=1 in the exporter's preprocessor definitions to enable it.
+
+   Node::processBlock marks the audio thread with an RTCheckScope (node name + function), and while a scope is active
+   any heap allocation / deallocation or blocking lock wait is recorded in a fixed-size event queue.
+   The message thread drains that queue and logs the events, so nothing on the audio side allocates itself.
+
+   How allocations are caught depends on the platform, only one of these is used :
+   - glibc (Linux) : malloc, calloc, realloc and free are replaced, operator new goes through them.
+     memalign, posix_memalign and aligned_alloc are not, so over-aligned allocations are missed.
+   - Windows debug builds : the debug CRT allocation hook.
+   - Everywhere else (macOS, Windows release) : the plain and array forms of global operator new / delete are replaced.
+     malloc is not seen there, so AudioBuffer and HeapBlock allocations are missed.
+*/
+
+#ifndef LGML_RT_CHECKS
+#define LGML_RT_CHECKS 0
+#endif
+
+#if LGML_RT_CHECKS
+class RTChecker :
+	public Timer
+{
+public:
+	juce_DeclareSingleton(RTChecker, true);
+
+	RTChecker();
+	~RTChecker();
+
+	enum EventType { ALLOCATION, DEALLOCATION, LOCK_WAIT };
+
+	struct Event
+	{
+		std::atomic<bool> ready{ false };
+		EventType type = ALLOCATION;
+		size_t size = 0;
+		const char* function = nullptr;
+		const char* lockName = nullptr;
+		char nodeName[64] = {};
+	};
+
+	class Scope
+	{
+	public:
+		Scope(const char* nodeName, const char* function);
+		~Scope();
+
+		const char* nodeName;
+		const char* function;
+		Scope* parent;
+	};
+
+	static void notifyAllocation(size_t size);
+	static void notifyDeallocation();
+	static void notifyLockWait(const char* lockName);
+
+	static bool isInAudioScope();
+
+	void timerCallback() override;
+
+private:
+	static const int maxEvents = 1024;
+	static Event events[maxEvents];
+	static std::atomic<uint32> writeIndex;
+	static std::atomic<uint32> droppedEvents;
+	uint32 readIndex;
+
+	static void pushEvent(EventType type, size_t size, const char* lockName);
+};
+#endif
+
+
+/* Drop-in replacement for GenericScopedLock in audio paths : with LGML_RT_CHECKS, a lock that can't be taken immediately is reported as a wait. */
+template<class LockType>
+class RTCheckedScopedLock
+{
+public:
+	RTCheckedScopedLock(const LockType& lock, const char* lockName) : lock(lock)
+	{
+#if LGML_RT_CHECKS
+		if (lock.tryEnter()) return;
+		RTChecker::notifyLockWait(lockName);
+#endif
+		lock.enter();
+	}
+
+	~RTCheckedScopedLock() { lock.exit(); }
+
+	const LockType& lock;
+
+	JUCE_DECLARE_NON_COPYABLE(RTCheckedScopedLock)
+};
+
+#if LGML_RT_CHECKS
+#define RT_CHECK_SCOPE(nodeName, function) RTChecker::Scope JUCE_JOIN_MACRO(rtCheckScope, __LINE__)(nodeName, function)
+#else
+#define RT_CHECK_SCOPE(nodeName, function)
+#endif
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+	ScratchBufferPool.cpp
+	Created: 17 Oct 2026 10:12:31am
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Common/CommonIncludes.h"
+
+ScratchBufferPool::ScratchBufferPool(int numBuffers) :
+	numChannels(0),
+	numSamples(0),
+	numUsed(0)
+{
+	for (int i = 0; i < numBuffers; i++) buffers.add(new AudioBuffer<float>());
+}
+
+ScratchBufferPool::~ScratchBufferPool()
+{
+}
+
+void ScratchBufferPool::prepare(int newNumChannels, int newNumSamples)
+{
+	//only grow, so a smaller config never forces a reallocation later
+	numChannels = jmax(numChannels, newNumChannels);
+	numSamples = jmax(numSamples, newNumSamples);
+
+	for (auto& b : buffers)
+	{
+		b->setSize(numChannels, numSamples, false, true, true);
+		b->clear();
+	}
+}
+
+AudioBuffer<float>& ScratchBufferPool::acquire(int targetNumChannels, int targetNumSamples, bool clear)
+{
+	if (numUsed >= buffers.size())
+	{
+		jassertfalse; //not enough buffers prepared, this will allocate
+		buffers.add(new AudioBuffer<float>(jmax(numChannels, targetNumChannels), jmax(numSamples, targetNumSamples)));
+	}
+
+	jassert(targetNumChannels <= numChannels && targetNumSamples <= numSamples); //will allocate if bigger than prepared
+
+	AudioBuffer<float>* b = buffers[numUsed++];
+	b->setSize(targetNumChannels, targetNumSamples, false, false, true);
+	if (clear) b->clear();
+	return *b;
+}
+
+void ScratchBufferPool::release()
+{
+	numUsed--;
+	jassert(numUsed >= 0);
+}
+
+ScratchBufferPool::Scoped::Scoped(ScratchBufferPool& pool, int numChannels, int numSamples, bool clear) :
+	pool(pool),
+	buffer(pool.acquire(numChannels, numSamples, clear))
+{
+}
+
+ScratchBufferPool::Scoped::~Scoped()
+{
+	pool.release();
+}
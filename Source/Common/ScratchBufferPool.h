@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+	ScratchBufferPool.h
+	Created: 17 Oct 2026 10:12:31am
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* A small stack of preallocated audio buffers to use as temporaries inside processBlock.
+   prepare() is called from the message thread (with processing suspended) and does all the allocation,
+   acquire / release are only called from the audio thread and never touch the heap as long as the
+   requested size fits in what has been prepared.
+*/
+class ScratchBufferPool
+{
+public:
+	ScratchBufferPool(int numBuffers = 4);
+	~ScratchBufferPool();
+
+	OwnedArray<AudioBuffer<float>> buffers;
+	int numChannels;
+	int numSamples;
+	int numUsed;
+
+	void prepare(int numChannels, int numSamples);
+
+	AudioBuffer<float>& acquire(int numChannels, int numSamples, bool clear = true);
+	void release();
+
+	class Scoped
+	{
+	public:
+		Scoped(ScratchBufferPool& pool, int numChannels, int numSamples, bool clear = true);
+		~Scoped();
+
+		ScratchBufferPool& pool;
+		AudioBuffer<float>& buffer;
+
+		JUCE_DECLARE_NON_COPYABLE(Scoped)
+	};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchBufferPool)
+};
+
+typedef ScratchBufferPool::Scoped ScopedScratchBuffer;
@@ -14,9 +14,13 @@
 
 juce_ImplementSingleton(AudioManager)
 
+thread_local bool AudioManager::isAudioThread = false;
+
 AudioManager::AudioManager() :
 	ControllableContainer("Audio Settings"),
-	graphIDIncrement(GRAPH_START_ID)
+	graphIDIncrement(GRAPH_START_ID),
+	isOffline(false),
+	blockTimeMS(0)
 	//;isSettingUp(false)
 {
 	showWarningInUI = true;
@@ -58,13 +62,13 @@ AudioManager::AudioManager() :
 	graph.addNode(std::move(midiIn), AudioProcessorGraph::NodeID(MIDI_GRAPH_INPUT_ID));
 	graph.addNode(std::move(midiOut), AudioProcessorGraph::NodeID(MIDI_GRAPH_OUTPUT_ID));
 
-	player.setProcessor(&graph);
+	player.setProcessor(&graphProcessor);
 
 	numAudioInputs = setup.inputChannels.countNumberOfSetBits();
 	numAudioOutputs = setup.outputChannels.countNumberOfSetBits();
 
-	graph.setPlayConfigDetails(numAudioInputs, numAudioOutputs, currentSampleRate, currentBufferSize);
-	graph.prepareToPlay(currentSampleRate, currentBufferSize);
+	graphProcessor.setPlayConfigDetails(numAudioInputs, numAudioOutputs, currentSampleRate, currentBufferSize);
+	graphProcessor.prepareToPlay(currentSampleRate, currentBufferSize);
 
 	Engine::mainEngine->addEngineListener(this);
 }
@@ -74,8 +78,9 @@ AudioManager::~AudioManager()
 	Engine::mainEngine->removeEngineListener(this);
 
 	am.removeAudioCallback(&player);
-	graph.clear();
 	player.setProcessor(nullptr);
+	graphProcessor.setNumWorkers(0);
+	graph.clear();
 	am.removeAudioCallback(this);
 	am.removeChangeListener(this);
 }
@@ -89,15 +94,18 @@ void AudioManager::updateGraph()
 {
 	graph.suspendProcessing(true);
 
-	AudioDeviceManager::AudioDeviceSetup setup = am.getAudioDeviceSetup();
-	currentSampleRate = setup.sampleRate;
-	currentBufferSize = setup.bufferSize;
+	if (!isOffline)
+	{
+		AudioDeviceManager::AudioDeviceSetup setup = am.getAudioDeviceSetup();
+		currentSampleRate = setup.sampleRate;
+		currentBufferSize = setup.bufferSize;
 
-	numAudioInputs = setup.inputChannels.countNumberOfSetBits();
-	numAudioOutputs = setup.outputChannels.countNumberOfSetBits();
+		numAudioInputs = setup.inputChannels.countNumberOfSetBits();
+		numAudioOutputs = setup.outputChannels.countNumberOfSetBits();
+	}
 
-	graph.setPlayConfigDetails(numAudioInputs, numAudioOutputs, currentSampleRate, currentBufferSize);
-	graph.prepareToPlay(currentSampleRate, currentBufferSize);
+	graphProcessor.setPlayConfigDetails(numAudioInputs, numAudioOutputs, currentSampleRate, currentBufferSize);
+	graphProcessor.prepareToPlay(currentSampleRate, currentBufferSize);
 
 	audioManagerListeners.call(&AudioManagerListener::audioSetupChanged);
 
@@ -106,6 +114,22 @@ void AudioManager::updateGraph()
 	graph.suspendProcessing(false);
 }
 
+void AudioManager::setOfflineMode(int numInputs, int numOutputs, double sampleRate, int bufferSize)
+{
+	isOffline = true;
+
+	//nothing should drive the graph except the renderer from now on
+	am.removeAudioCallback(&player);
+	am.closeAudioDevice();
+
+	numAudioInputs = numInputs;
+	numAudioOutputs = numOutputs;
+	currentSampleRate = sampleRate;
+	currentBufferSize = bufferSize;
+
+	updateGraph();
+}
+
 
 void AudioManager::audioDeviceIOCallbackWithContext
 #if RPISAFEMODE
@@ -126,12 +150,16 @@ void AudioManager::audioDeviceIOCallbackWithContext
 #endif
 
 {
+	isAudioThread = true;
+	blockTimeMS = Time::getMillisecondCounterHiRes(); //this callback is added before the player, so it runs before the graph
 	for (int i = 0; i < numOutputChannels; ++i) FloatVectorOperations::clear(outputChannelData[i], numSamples);
 	//for (int i = 0; i < jmin(numInputChannels, numOutputChannels); ++i) FloatVectorOperations::copy(outputChannelData[i], inputChannelData[i], numSamples);
 }
 
 void AudioManager::loadAudioConfig()
 {
+	if (isOffline) return;
+
 	if (lastUserState != nullptr)
 	{
 		String s = am.initialise(0, 2, lastUserState.get(), false);
@@ -198,6 +226,13 @@ void AudioManager::changeListenerCallback(ChangeBroadcaster* source)
 
 StringArray AudioManager::getInputChannelNames() const
 {
+	if (isOffline)
+	{
+		StringArray result;
+		for (int i = 0; i < numAudioInputs; i++) result.add("Input " + String(i + 1));
+		return result;
+	}
+
 	if (am.getCurrentAudioDevice() == nullptr) return StringArray();
 
 	StringArray allInputs = am.getCurrentAudioDevice()->getInputChannelNames();
@@ -210,6 +245,13 @@ StringArray AudioManager::getInputChannelNames() const
 
 StringArray AudioManager::getOutputChannelNames() const
 {
+	if (isOffline)
+	{
+		StringArray result;
+		for (int i = 0; i < numAudioOutputs; i++) result.add("Output " + String(i + 1));
+		return result;
+	}
+
 	if (am.getCurrentAudioDevice() == nullptr) return StringArray();
 
 	StringArray allOutputs = am.getCurrentAudioDevice()->getOutputChannelNames();
@@ -237,6 +279,8 @@ void AudioManager::endLoadFile()
 
 String AudioManager::getCurrentDeviceDescription()
 {
+	if (isOffline) return "[Offline] : " + String(currentSampleRate) + "Hz, " + String(currentBufferSize) + " samples";
+
 	String deviceName = am.getCurrentAudioDevice() != nullptr  ?am.getCurrentAudioDevice()->getName(): (targetDeviceName.isNotEmpty()?"[Disconnected :"+targetDeviceName+"]" : "");
 
 	am.getAudioDeviceSetup();
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "JuceHeader.h"
+#include "ParallelGraphProcessor.h"
 
 #define AUDIO_GRAPH_INPUT_ID 1
 #define AUDIO_GRAPH_OUTPUT_ID 2
@@ -34,6 +35,7 @@ public:
 
 	AudioDeviceManager am;
 	AudioProcessorGraph graph;
+	ParallelGraphProcessor graphProcessor{ graph }; //what the player actually runs, see ParallelGraphProcessor
 	AudioProcessorPlayer player;
 	int graphIDIncrement; //This will be incremented and assign to each node that is created, in the node constructor
 
@@ -46,9 +48,14 @@ public:
 	std::unique_ptr<XmlElement> lastUserState;
 	String targetDeviceName;
 
+	bool isOffline; //no device, the graph is driven by the OfflineRenderer
+	std::atomic<double> blockTimeMS; //millisecond counter at the start of the current device callback, for timestamped MIDI input
+	static thread_local bool isAudioThread; //set by the threads that run the graph and the transport (device callback, graph workers, offline renderer)
+
 	int getNewGraphID();
 
 	void updateGraph();
+	void setOfflineMode(int numInputs, int numOutputs, double sampleRate, int bufferSize);
 
 
 	virtual void audioDeviceIOCallbackWithContext
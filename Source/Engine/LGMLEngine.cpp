@@ -31,6 +31,10 @@ LGMLEngine::LGMLEngine() :
 
     MIDIManager::getInstance(); //force init
 
+#if LGML_RT_CHECKS
+    RTChecker::getInstance();
+#endif
+
     addChildControllableContainer(RootNodeManager::getInstance(), false, 0);
     addChildControllableContainer(Transport::getInstance(), false, 1);
     addChildControllableContainer(RootPresetManager::getInstance(), false, 2);
@@ -66,6 +70,10 @@ LGMLEngine::~LGMLEngine()
     VSTManager::deleteInstance();
     LGMLSettings::deleteInstance();
     MIDIManager::deleteInstance();
+
+#if LGML_RT_CHECKS
+    RTChecker::deleteInstance();
+#endif
 }
 
 void LGMLEngine::clearInternal()
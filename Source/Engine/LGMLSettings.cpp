@@ -9,6 +9,7 @@
 */
 
 #include "LGMLSettings.h"
+#include "AudioManager.h"
 
 juce_ImplementSingleton(LGMLSettings)
 
@@ -17,8 +18,27 @@ LGMLSettings::LGMLSettings() :
 {
     animateConnectionIntensity = addBoolParameter("Animate Connections Intensity", "If checked, this will animate the connection wires in the Node View", true);
     autoLearnOnCreateMapping = addBoolParameter("Auto Learn On Create Mapping", "If checked, this will automatically activate learn of a mapping when creating it", true);
+    parallelProcessing = addBoolParameter("Parallel Processing", "If checked, independent branches of the root graph are processed on several cores. Experimental, some nodes may not be safe to run concurrently", false);
+    processingThreads = addIntParameter("Processing Threads", "Number of worker threads used for parallel processing, in addition to the audio thread. 0 is automatic (number of cores - 1)", 0, 0, 7);
 }
 
 LGMLSettings::~LGMLSettings()
 {
 }
+
+int LGMLSettings::getNumProcessingThreads() const
+{
+    if (!parallelProcessing->boolValue()) return 0;
+    if (processingThreads->intValue() > 0) return processingThreads->intValue();
+    return jlimit(1, 7, SystemStats::getNumCpus() - 1);
+}
+
+void LGMLSettings::onContainerParameterChanged(Parameter* p)
+{
+    if (p == parallelProcessing || p == processingThreads)
+    {
+        ParallelGraphProcessor& gp = AudioManager::getInstance()->graphProcessor;
+        gp.setNumWorkers(getNumProcessingThreads());
+        gp.parallelEnabled = parallelProcessing->boolValue();
+    }
+}
@@ -19,7 +19,12 @@ public:
 
     BoolParameter* animateConnectionIntensity;
     BoolParameter* autoLearnOnCreateMapping;
+    BoolParameter* parallelProcessing;
+    IntParameter* processingThreads;
 
     LGMLSettings();
     ~LGMLSettings();
+
+    int getNumProcessingThreads() const;
+    void onContainerParameterChanged(Parameter* p) override;
 };
\ No newline at end of file
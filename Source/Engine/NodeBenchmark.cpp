@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+	NodeBenchmark.cpp
+	Created: 17 Oct 2026 1:05:18pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "NodeBenchmark.h"
+#include "Node/NodeIncludes.h"
+
+NodeBenchmark::NodeBenchmark(const String& commandLine) :
+	sampleRate(48000),
+	numBlocks(200),
+	numWarmupBlocks(20)
+{
+	StringArray args = StringArray::fromTokens(commandLine, true);
+	for (auto& a : args) a = a.unquoted();
+
+	auto getArg = [&args](const String& key) -> String
+	{
+		int index = args.indexOf(key);
+		return index >= 0 && index < args.size() - 1 ? args[index + 1] : String();
+	};
+
+	String outPath = getArg("-output");
+	if (outPath.isEmpty()) outPath = "lgml-benchmark.json";
+	outputFile = File::isAbsolutePath(outPath) ? File(outPath) : File::getCurrentWorkingDirectory().getChildFile(outPath);
+
+	if (getArg("-blocks").isNotEmpty()) numBlocks = jmax(getArg("-blocks").getIntValue(), 10);
+	if (getArg("-samplerate").isNotEmpty()) sampleRate = jmax(getArg("-samplerate").getDoubleValue(), 8000.0);
+
+	blockSizes.addArray({ 32, 64, 128, 256, 512, 1024, 2048 });
+
+	tmpFolder = File::getSpecialLocation(File::tempDirectory).getChildFile("LGMLBenchmark");
+}
+
+NodeBenchmark::~NodeBenchmark()
+{
+	tmpFolder.deleteRecursively();
+}
+
+bool NodeBenchmark::isBenchmarkCommandLine(const String& commandLine)
+{
+	return StringArray::fromTokens(commandLine, true).contains("-benchmark");
+}
+
+void NodeBenchmark::start()
+{
+	Result r = runAll();
+	if (r.wasOk()) LOG("Benchmark results written to " << outputFile.getFullPathName());
+	else LOGERROR("Benchmark failed : " << r.getErrorMessage());
+
+	JUCEApplicationBase::getInstance()->setApplicationReturnValue(r.wasOk() ? 0 : 1);
+	JUCEApplicationBase::quit();
+}
+
+Result NodeBenchmark::runAll()
+{
+	results = var();
+
+	tmpFolder.deleteRecursively();
+	tmpFolder.createDirectory();
+
+	Transport::getInstance()->bpm->setValue(100); //loops are recorded at 120, so the loopers have to stretch
+
+	for (auto& io : Array<Point<int>>({ {2, 2}, {8, 8}, {16, 16}, {32, 32} }))
+	{
+		runScenario(MixerNode::getTypeStringStatic(), String(io.x) + "x" + String(io.y), [this, io](int) { return createMixer(io.x, io.y); });
+	}
+
+	for (auto& st : Array<Point<int>>({ {1, 2}, {4, 8}, {8, 16}, {16, 32} }))
+	{
+		runScenario(SpatNode::getTypeStringStatic(), String(st.x) + " sources x " + String(st.y) + " targets", [this, st](int) { return createSpat(st.x, st.y); });
+	}
+
+	for (int ch : { 1, 2 })
+	{
+		runScenario(AudioLooperNode::getTypeStringStatic(), "8 tracks playing stretched loops, " + String(ch) + " ch", [this, ch](int blockSize) { return createLooper(ch, blockSize); });
+		runScenario(SamplerNode::getTypeStringStatic(), "128 notes, " + String(ch) + " ch", [this, ch](int blockSize) { return createSampler(ch, blockSize); });
+	}
+
+	Transport::getInstance()->stop();
+
+	var data(new DynamicObject());
+	data.getDynamicObject()->setProperty("version", ProjectInfo::versionString);
+	data.getDynamicObject()->setProperty("date", Time::getCurrentTime().toISO8601(true));
+	data.getDynamicObject()->setProperty("os", SystemStats::getOperatingSystemName());
+	data.getDynamicObject()->setProperty("cpu", SystemStats::getCpuModel());
+	data.getDynamicObject()->setProperty("sampleRate", sampleRate);
+	data.getDynamicObject()->setProperty("numBlocks", numBlocks);
+	data.getDynamicObject()->setProperty("results", results);
+
+	outputFile.deleteFile();
+	if (!outputFile.replaceWithText(JSON::toString(data))) return Result::fail("Could not write " + outputFile.getFullPathName());
+
+	return Result::ok();
+}
+
+void NodeBenchmark::runScenario(const String& scenario, const String& config, std::function<Node* (int blockSize)> createFunc)
+{
+	for (auto& blockSize : blockSizes)
+	{
+		AudioManager::getInstance()->setOfflineMode(2, 2, sampleRate, blockSize);
+		Transport::getInstance()->setPlayConfig((int)sampleRate, blockSize);
+		Transport::getInstance()->play(false, true);
+
+		Node* n = createFunc(blockSize);
+		n->processor->prepareToPlay(sampleRate, blockSize);
+		waitForBackgroundJobs(n, blockSize);
+
+		var r = measure(n, blockSize);
+		r.getDynamicObject()->setProperty("scenario", scenario);
+		r.getDynamicObject()->setProperty("config", config);
+		results.append(r);
+
+		LOG(scenario << " (" << config << "), " << blockSize << " samples : avg " << (double)r.getProperty("avgUS", 0) << "us, p99 " << (double)r.getProperty("p99US", 0) << "us");
+
+		Transport::getInstance()->stop();
+		RootNodeManager::getInstance()->clear();
+	}
+}
+
+var NodeBenchmark::measure(Node* node, int blockSize)
+{
+	AudioBuffer<float> buffer(jmax(node->getNumAudioInputs(), node->getNumAudioOutputs(), 1), blockSize);
+	MidiBuffer midi;
+	Random rand(1234); //same input every run
+	AudioIODeviceCallbackContext context;
+
+	Array<double> times;
+	times.ensureStorageAllocated(numBlocks);
+
+	for (int i = 0; i < numWarmupBlocks + numBlocks; i++)
+	{
+		for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+		{
+			float* d = buffer.getWritePointer(ch);
+			for (int s = 0; s < blockSize; s++) d[s] = (rand.nextFloat() * 2 - 1) * .5f;
+		}
+		midi.clear();
+
+		int64 startTicks = Time::getHighResolutionTicks();
+		node->processor->processBlock(buffer, midi);
+		double elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+		Transport::getInstance()->audioDeviceIOCallbackWithContext(nullptr, 0, nullptr, 0, blockSize, context);
+
+		if (i >= numWarmupBlocks) times.add(elapsed * 1e6);
+	}
+
+	times.sort();
+	double sum = 0;
+	for (auto& t : times) sum += t;
+	double avg = sum / times.size();
+	double blockUS = blockSize * 1e6 / sampleRate;
+
+	var r(new DynamicObject());
+	r.getDynamicObject()->setProperty("blockSize", blockSize);
+	r.getDynamicObject()->setProperty("numInputs", node->getNumAudioInputs());
+	r.getDynamicObject()->setProperty("numOutputs", node->getNumAudioOutputs());
+	r.getDynamicObject()->setProperty("minUS", times.getFirst());
+	r.getDynamicObject()->setProperty("avgUS", avg);
+	r.getDynamicObject()->setProperty("medianUS", times[times.size() / 2]);
+	r.getDynamicObject()->setProperty("p99US", times[jmin(times.size() - 1, (int)(times.size() * .99))]);
+	r.getDynamicObject()->setProperty("maxUS", times.getLast());
+	r.getDynamicObject()->setProperty("blockShare", avg / blockUS); //fraction of the block duration
+	r.getDynamicObject()->setProperty("samplesPerSecond", avg > 0 ? blockSize * 1e6 / avg : 0);
+	return r;
+}
+
+void NodeBenchmark::waitForBackgroundJobs(Node* node, int blockSize)
+{
+	AudioLooperNode* looper = dynamic_cast<AudioLooperNode*>(node);
+	if (looper == nullptr) return;
+
+	Array<AudioLooperTrack*> tracks;
+	for (int i = 0; i < looper->numTracks->intValue(); i++) tracks.add((AudioLooperTrack*)looper->tracksCC.controllableContainers[i].get());
+
+	//the loops are written at another bpm than the transport's, a track that doesn't stretch would time plain playback
+	for (auto& t : tracks)
+	{
+		if (t->stretch == 1 || t->stretchJob == nullptr)
+		{
+			jassertfalse;
+			LOGWARNING("Benchmark : track " << t->index + 1 << " of the looper is not stretched");
+			return;
+		}
+	}
+
+	//the tracks start on the next beat and render their stretched loops on the looper's pool,
+	//untimed blocks are processed until they all play them
+	AudioBuffer<float> buffer(jmax(node->getNumAudioInputs(), node->getNumAudioOutputs(), 1), blockSize);
+	MidiBuffer midi;
+	AudioIODeviceCallbackContext context;
+
+	uint32 startTime = Time::getMillisecondCounter();
+	for (;;)
+	{
+		bool allStretched = true;
+		for (auto& t : tracks) allStretched &= t->isPlaying(false) && t->stretchSample == -2 && t->stretchedBuffer.getNumSamples() > 0;
+		if (allStretched) break;
+
+		if (Time::getMillisecondCounter() - startTime > 60000)
+		{
+			LOGWARNING("Benchmark : the looper tracks are still not playing their stretched loops after 60s, timing anyway");
+			break;
+		}
+
+		buffer.clear();
+		midi.clear();
+		node->processor->processBlock(buffer, midi);
+		Transport::getInstance()->audioDeviceIOCallbackWithContext(nullptr, 0, nullptr, 0, blockSize, context);
+
+		if (looper->stretchPool.getNumJobs() > 0) Thread::sleep(1);
+	}
+}
+
+Node* NodeBenchmark::createMixer(int numInputs, int numOutputs)
+{
+	MixerNode* n = new MixerNode();
+	RootNodeManager::getInstance()->addItem(n, var(), false);
+	n->numAudioInputs->setValue(numInputs);
+	n->numAudioOutputs->setValue(numOutputs);
+	return n;
+}
+
+Node* NodeBenchmark::createSpat(int numSources, int numTargets)
+{
+	SpatNode* n = new SpatNode();
+	RootNodeManager::getInstance()->addItem(n, var(), false);
+	while (n->sources.items.size() < numSources) n->sources.addItem(nullptr, var(), false);
+	while (n->targets.items.size() < numTargets) n->targets.addItem(nullptr, var(), false);
+	return n;
+}
+
+Node* NodeBenchmark::createLooper(int numChannels, int blockSize)
+{
+	AudioLooperNode* n = new AudioLooperNode();
+	RootNodeManager::getInstance()->addItem(n, var(), false);
+	n->numChannelsPerTrack->setValue(numChannels);
+
+	//one bar at 120 bpm, block-aligned like a recorded loop
+	int beatSamples = (int)(sampleRate * 60 / 120);
+	beatSamples -= beatSamples % blockSize;
+
+	File dir = tmpFolder.getChildFile("looper" + String(numChannels) + "_" + String(blockSize));
+	dir.createDirectory();
+	for (int i = 0; i < n->numTracks->intValue(); i++) writeLoopFile(dir.getChildFile(String(i + 1) + ".wav"), numChannels, beatSamples * 4, 120, 4);
+
+	n->sampleDirectory->setValue(dir.getFullPathName());
+	n->loadSamples();
+	n->playAllTrigger->trigger();
+
+	return n;
+}
+
+Node* NodeBenchmark::createSampler(int numChannels, int blockSize)
+{
+	SamplerNode* n = new SamplerNode(var());
+	RootNodeManager::getInstance()->addItem(n, var(), false);
+	n->numChannels->setValue(numChannels);
+	n->monitor->setValue(false);
+
+	//about one second per note, block-aligned like a recorded note
+	int numSamples = (int)sampleRate;
+	numSamples -= numSamples % blockSize;
+
+	for (int i = 0; i < n->samplerNotes.size(); i++)
+	{
+		SamplerNode::SamplerNote* sn = n->samplerNotes[i];
+		sn->buffer.setSize(numChannels, numSamples);
+		float freq = (float)MidiMessage::getMidiNoteInHertz(i);
+		for (int ch = 0; ch < numChannels; ch++)
+		{
+			float* d = sn->buffer.getWritePointer(ch);
+			for (int s = 0; s < numSamples; s++) d[s] = std::sin(MathConstants<float>::twoPi * freq * s / (float)sampleRate) * .1f;
+		}
+		sn->state->setValueWithData(SamplerNode::FILLED);
+	}
+
+	for (int i = 0; i < n->samplerNotes.size(); i++) n->keyboardState.noteOn(1, i, 1);
+
+	return n;
+}
+
+void NodeBenchmark::writeLoopFile(File f, int numChannels, int numSamples, float bpm, int numBeats)
+{
+	AudioBuffer<float> b(numChannels, numSamples);
+	Random rand(numChannels * 100 + numSamples);
+	for (int ch = 0; ch < numChannels; ch++)
+	{
+		float* d = b.getWritePointer(ch);
+		for (int s = 0; s < numSamples; s++) d[s] = (rand.nextFloat() * 2 - 1) * .3f;
+	}
+
+	//same metadata as AudioLooperTrack::saveSampleFile. Beat play quantization : free loops are never stretched
+	StringPairArray metaData;
+	metaData.set(WavAudioFormat::riffInfoTitle, String(bpm) + ";" + String(numBeats) + ";" + String((int)Transport::BEAT));
+
+	f.deleteFile();
+	WavAudioFormat format;
+	std::unique_ptr<OutputStream> os(f.createOutputStream());
+	if (os == nullptr) return;
+
+	if (std::unique_ptr<AudioFormatWriter> writer = std::unique_ptr<AudioFormatWriter>(format.createWriterFor(os.get(), sampleRate, numChannels, 24, metaData, 0)))
+	{
+		os.release(); //owned by the writer now
+		writer->writeFromAudioSampleBuffer(b, 0, numSamples);
+	}
+}
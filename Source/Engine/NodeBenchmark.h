@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+	NodeBenchmark.h
+	Created: 17 Oct 2026 1:05:18pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+class Node;
+
+/* Headless benchmark of the node DSP hot paths.
+   Builds synthetic graphs in the root node manager (mixers, spatializers, loopers, samplers), and times each node's
+   processBlock over a range of block sizes and channel counts, with the audio device closed like in the OfflineRenderer.
+   Loopers are run untimed until all their tracks play the stretched loops rendered in the background.
+   Results are written as JSON so they can be compared between releases.
+
+   Command line :
+   LGML -benchmark [-output results.json] [-blocks 200] [-samplerate 48000]
+*/
+class NodeBenchmark
+{
+public:
+	NodeBenchmark(const String& commandLine);
+	~NodeBenchmark();
+
+	File outputFile;
+	double sampleRate;
+	int numBlocks;
+	int numWarmupBlocks;
+	Array<int> blockSizes;
+
+	File tmpFolder; //synthetic loops for the looper
+	var results;
+
+	static bool isBenchmarkCommandLine(const String& commandLine);
+
+	void start();
+	Result runAll();
+
+	//scenarios, return the node to time
+	Node* createMixer(int numInputs, int numOutputs);
+	Node* createSpat(int numSources, int numTargets);
+	Node* createLooper(int numChannels, int blockSize);
+	Node* createSampler(int numChannels, int blockSize);
+
+	void runScenario(const String& scenario, const String& config, std::function<Node* (int blockSize)> createFunc);
+	void waitForBackgroundJobs(Node* node, int blockSize); //so only the steady state is timed
+	var measure(Node* node, int blockSize);
+
+	void writeLoopFile(File f, int numChannels, int numSamples, float bpm, int numBeats);
+};
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+	OfflineRenderer.cpp
+	Created: 17 Oct 2026 12:20:42pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "AudioManager.h"
+#include "Transport/Transport.h"
+
+OfflineRenderer::OfflineRenderer(const Config& config) :
+	Thread("Offline Render"),
+	config(config),
+	result(Result::ok()),
+	renderTime(0),
+	renderedTime(0)
+{
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+	stopTimer();
+	stopThread(2000);
+}
+
+bool OfflineRenderer::isRenderCommandLine(const String& commandLine)
+{
+	return StringArray::fromTokens(commandLine, true).contains("-render");
+}
+
+OfflineRenderer::Config OfflineRenderer::parseCommandLine(const String& commandLine)
+{
+	StringArray args = StringArray::fromTokens(commandLine, true);
+	args.trim();
+	for (auto& a : args) a = a.unquoted();
+
+	auto getArg = [&args](const String& key) -> String
+	{
+		int index = args.indexOf(key);
+		return index >= 0 && index < args.size() - 1 ? args[index + 1] : String();
+	};
+
+	auto getFile = [&getArg](const String& key) -> File
+	{
+		String path = getArg(key);
+		if (path.isEmpty()) return File();
+		return File::isAbsolutePath(path) ? File(path) : File::getCurrentWorkingDirectory().getChildFile(path);
+	};
+
+	Config c;
+	c.sessionFile = getFile("-render");
+	c.outputFile = getFile("-output");
+	if (c.outputFile == File()) c.outputFile = c.sessionFile.withFileExtension("wav");
+	c.inputFile = getFile("-input");
+
+	if (getArg("-bars").isNotEmpty()) c.numBars = jmax(getArg("-bars").getIntValue(), 1);
+	if (getArg("-samplerate").isNotEmpty()) c.sampleRate = jmax(getArg("-samplerate").getDoubleValue(), 8000.0);
+	if (getArg("-blocksize").isNotEmpty()) c.blockSize = jlimit(16, 8192, getArg("-blocksize").getIntValue());
+	if (getArg("-inputs").isNotEmpty()) c.numInputs = jlimit(0, 64, getArg("-inputs").getIntValue());
+	if (getArg("-outputs").isNotEmpty()) c.numOutputs = jlimit(1, 64, getArg("-outputs").getIntValue());
+
+	return c;
+}
+
+void OfflineRenderer::start()
+{
+	if (!config.sessionFile.existsAsFile())
+	{
+		result = Result::fail("Session file not found : " + config.sessionFile.getFullPathName());
+		LOGERROR(result.getErrorMessage());
+		finish();
+		return;
+	}
+
+	LOG("Offline render of " << config.sessionFile.getFileName() << " : " << config.numBars << " bars at " << config.sampleRate << "Hz, " << config.blockSize << " samples per block");
+
+	AudioManager::getInstance()->setOfflineMode(config.numInputs, config.numOutputs, config.sampleRate, config.blockSize);
+	Transport::getInstance()->setPlayConfig((int)config.sampleRate, config.blockSize);
+
+	Engine::mainEngine->loadDocument(config.sessionFile);
+	startTimer(100); //wait for the file to be fully loaded before rendering
+}
+
+void OfflineRenderer::timerCallback()
+{
+	if (Engine::mainEngine->isLoadingFile) return;
+	stopTimer();
+
+	AudioManager::getInstance()->updateGraph(); //make sure all nodes are prepared with the offline config
+	Transport::getInstance()->play(false, true);
+
+	startThread();
+}
+
+void OfflineRenderer::run()
+{
+	AudioManager::isAudioThread = true;
+	result = render();
+
+	if (result.wasOk()) LOG("Offline render done : " << renderedTime << "s of audio rendered in " << renderTime << "s (x" << (renderTime > 0 ? renderedTime / renderTime : 0) << " realtime) to " << config.outputFile.getFullPathName());
+	else LOGERROR("Offline render failed : " << result.getErrorMessage());
+
+	MessageManager::callAsync([this]() { finish(); });
+}
+
+Result OfflineRenderer::render()
+{
+	AudioManager* am = AudioManager::getInstance();
+	Transport* t = Transport::getInstance();
+	AudioProcessorGraph& graph = am->graph;
+
+	const int blockSize = config.blockSize;
+	const int numInputs = graph.getTotalNumInputChannels();
+	const int numOutputs = graph.getTotalNumOutputChannels();
+	const int64 totalSamples = (int64)t->getBarNumSamples() * config.numBars;
+
+	if (totalSamples <= 0) return Result::fail("Transport has no valid bar length");
+
+	AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+
+	std::unique_ptr<AudioFormatReader> reader;
+	if (config.inputFile != File())
+	{
+		reader.reset(formatManager.createReaderFor(config.inputFile));
+		if (reader == nullptr) return Result::fail("Could not read input file " + config.inputFile.getFullPathName());
+		if (reader->sampleRate != config.sampleRate) LOGWARNING("Input file sample rate (" << reader->sampleRate << "Hz) doesn't match the render sample rate, it will not be resampled");
+	}
+
+	config.outputFile.deleteFile();
+	std::unique_ptr<FileOutputStream> outStream(config.outputFile.createOutputStream());
+	if (outStream == nullptr) return Result::fail("Could not write to " + config.outputFile.getFullPathName());
+
+	WavAudioFormat wavFormat;
+	std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(outStream.get(), config.sampleRate, numOutputs, 24, {}, 0));
+	if (writer == nullptr) return Result::fail("Could not create WAV writer");
+	outStream.release(); //owned by the writer now
+
+	AudioBuffer<float> buffer(jmax(numInputs, numOutputs, 1), blockSize);
+	AudioBuffer<float> inputBuffer(jmax(numInputs, 1), blockSize);
+	MidiBuffer midi;
+	AudioIODeviceCallbackContext context;
+
+	double startTime = Time::getMillisecondCounterHiRes();
+	int64 renderedSamples = 0;
+
+	while (renderedSamples < totalSamples)
+	{
+		if (threadShouldExit()) return Result::fail("Render was cancelled");
+
+		buffer.clear();
+		midi.clear();
+
+		if (reader != nullptr && numInputs > 0)
+		{
+			inputBuffer.clear();
+			reader->read(&inputBuffer, 0, blockSize, renderedSamples, true, true);
+			for (int i = 0; i < numInputs; i++) buffer.copyFrom(i, 0, inputBuffer, jmin(i, inputBuffer.getNumChannels() - 1), 0, blockSize);
+		}
+
+		//same order as the device callbacks : graph first, then the transport moves forward
+		am->graphProcessor.processBlock(buffer, midi);
+
+		t->audioDeviceIOCallbackWithContext(nullptr, 0, nullptr, 0, blockSize, context);
+
+		int numToWrite = (int)jmin<int64>(blockSize, totalSamples - renderedSamples);
+		writer->writeFromAudioSampleBuffer(buffer, 0, numToWrite);
+		renderedSamples += numToWrite;
+	}
+
+	renderTime = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+	renderedTime = renderedSamples / config.sampleRate;
+
+	return Result::ok();
+}
+
+void OfflineRenderer::finish()
+{
+	JUCEApplicationBase::getInstance()->setApplicationReturnValue(result.wasOk() ? 0 : 1);
+	JUCEApplicationBase::quit();
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+	OfflineRenderer.h
+	Created: 17 Oct 2026 12:20:42pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+/* Headless bounce of a session, as fast as the CPU allows.
+   The audio device is closed and the root graph and the Transport are driven from a thread,
+   with the inputs fed from an audio file (or silence), and the outputs written to a WAV file.
+
+   Command line :
+   LGML -render session.lgml -output bounce.wav [-bars 8] [-input input.wav] [-samplerate 48000] [-blocksize 512] [-inputs 2] [-outputs 2]
+*/
+class OfflineRenderer :
+	public Thread,
+	public Timer
+{
+public:
+	struct Config
+	{
+		File sessionFile;
+		File outputFile;
+		File inputFile; //silence if not set
+		int numBars = 8;
+		double sampleRate = 48000;
+		int blockSize = 512;
+		int numInputs = 2;
+		int numOutputs = 2;
+	};
+
+	OfflineRenderer(const Config& config);
+	~OfflineRenderer();
+
+	Config config;
+	Result result;
+	double renderTime; //wall time of the last render, in seconds
+	double renderedTime; //audio time of the last render, in seconds
+
+	static bool isRenderCommandLine(const String& commandLine);
+	static Config parseCommandLine(const String& commandLine);
+
+	void start();
+	void timerCallback() override;
+
+	void run() override;
+	Result render();
+
+	void finish();
+};
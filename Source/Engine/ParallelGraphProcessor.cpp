@@ -0,0 +1,378 @@
+/*
+  ==============================================================================
+
+	ParallelGraphProcessor.cpp
+	Created: 17 Oct 2026 2:14:51pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "ParallelGraphProcessor.h"
+#include "AudioManager.h"
+
+ParallelGraphProcessor::ParallelGraphProcessor(AudioProcessorGraph& graph) :
+	graph(graph),
+	parallelEnabled(false),
+	plan(nullptr),
+	pendingPlan(nullptr),
+	retiredPlan(nullptr),
+	jobTicket(0),
+	currentLevel(nullptr),
+	jobsDone(0),
+	currentPlan(nullptr),
+	currentNumSamples(0)
+{
+	graph.addChangeListener(this);
+}
+
+ParallelGraphProcessor::~ParallelGraphProcessor()
+{
+	graph.removeChangeListener(this);
+	stopTimer();
+	setNumWorkers(0);
+
+	delete plan;
+	delete pendingPlan.exchange(nullptr);
+	delete retiredPlan.exchange(nullptr);
+}
+
+void ParallelGraphProcessor::setNumWorkers(int numWorkers)
+{
+	if (numWorkers == workers.size()) return;
+
+	OwnedArray<Worker> oldWorkers;
+	{
+		const ScopedLock sl(getCallbackLock()); //not in the middle of a block
+		oldWorkers.swapWith(workers);
+	}
+	oldWorkers.clear(); //stops the threads
+
+	OwnedArray<Worker> newWorkers;
+	for (int i = 0; i < numWorkers; i++) newWorkers.add(new Worker(this, i));
+
+	{
+		const ScopedLock sl(getCallbackLock());
+		workers.swapWith(newWorkers);
+	}
+}
+
+void ParallelGraphProcessor::rebuildPlan()
+{
+	const ScopedLock sl(planBuildLock);
+
+	std::unique_ptr<RenderPlan> newPlan(new RenderPlan());
+	newPlan->blockSize = jmax(getBlockSize(), graph.getBlockSize());
+
+	//fades are computed against what the audio thread is running : if the previous plan was never picked up, against its own base
+	std::unique_ptr<RenderPlan> skippedPlan(pendingPlan.exchange(nullptr));
+	newPlan->baseConnections = skippedPlan != nullptr ? skippedPlan->baseConnections : lastConnections;
+	skippedPlan.reset();
+
+	std::vector<AudioProcessorGraph::Connection> connections = graph.getConnections();
+	lastConnections.clearQuick();
+	for (auto& c : connections) lastConnections.add(c);
+
+	HashMap<uint32, int> jobIndices;
+	Array<uint32> inputIDs;
+	Array<uint32> outputIDs;
+
+	for (auto& n : graph.getNodes())
+	{
+		if (AudioProcessorGraph::AudioGraphIOProcessor* io = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*>(n->getProcessor()))
+		{
+			if (io->isInput()) inputIDs.add(n->nodeID.uid);
+			else outputIDs.add(n->nodeID.uid);
+			continue;
+		}
+
+		NodeJob* job = new NodeJob();
+		job->node = n;
+		job->numChannels = jmax(n->getProcessor()->getTotalNumInputChannels(), n->getProcessor()->getTotalNumOutputChannels());
+		job->buffer.setSize(job->numChannels, newPlan->blockSize);
+		job->midi.ensureSize(2048);
+
+		jobIndices.set(n->nodeID.uid, newPlan->jobs.size());
+		newPlan->jobs.add(job);
+	}
+
+	//current connections, plus the removed ones so they can be faded out
+	Array<AudioProcessorGraph::Connection> allConnections = lastConnections;
+	for (auto& c : newPlan->baseConnections) if (!lastConnections.contains(c)) allConnections.add(c);
+
+	for (auto& c : allConnections)
+	{
+		bool isMIDI = c.source.isMIDI();
+		uint32 sourceID = c.source.nodeID.uid;
+		uint32 destID = c.destination.nodeID.uid;
+
+		bool sourceIsInput = inputIDs.contains(sourceID);
+		if (!sourceIsInput && !jobIndices.contains(sourceID)) continue;
+		int sourceJob = sourceIsInput ? -1 : jobIndices[sourceID];
+
+		int fade = 0;
+		if (!lastConnections.contains(c)) fade = -1;
+		else if (!newPlan->baseConnections.contains(c)) fade = 1;
+
+		if (isMIDI && fade < 0) continue; //MIDI is just cut
+
+		if (outputIDs.contains(destID))
+		{
+			if (isMIDI) newPlan->midiOutputs.addIfNotAlreadyThere(sourceJob);
+			else newPlan->audioOutputs.add({ sourceJob, c.source.channelIndex, c.destination.channelIndex, fade });
+			continue;
+		}
+
+		if (!jobIndices.contains(destID)) continue;
+		NodeJob* destJob = newPlan->jobs[jobIndices[destID]];
+		if (isMIDI) destJob->midiSources.addIfNotAlreadyThere(sourceJob);
+		else destJob->audioInputs.add({ sourceJob, c.source.channelIndex, c.destination.channelIndex, fade });
+	}
+
+	//dependency levels, a node goes one level after the deepest of its sources
+	Array<int> jobLevels;
+	jobLevels.insertMultiple(0, -1, newPlan->jobs.size());
+	int numAssigned = 0;
+	bool hasChanged = true;
+	while (hasChanged && numAssigned < newPlan->jobs.size())
+	{
+		hasChanged = false;
+		for (int i = 0; i < newPlan->jobs.size(); i++)
+		{
+			if (jobLevels[i] != -1) continue;
+
+			NodeJob* job = newPlan->jobs[i];
+			int level = 0;
+			bool ready = true;
+			for (auto& in : job->audioInputs) if (in.sourceJob >= 0) { if (jobLevels[in.sourceJob] == -1) ready = false; else level = jmax(level, jobLevels[in.sourceJob] + 1); }
+			for (auto& s : job->midiSources) if (s >= 0) { if (jobLevels[s] == -1) ready = false; else level = jmax(level, jobLevels[s] + 1); }
+			if (!ready) continue;
+
+			jobLevels.set(i, level);
+			while (newPlan->levels.size() <= level) newPlan->levels.add(Array<int>());
+			newPlan->levels.getReference(level).add(i);
+			numAssigned++;
+			hasChanged = true;
+		}
+	}
+
+	if (numAssigned < newPlan->jobs.size())
+	{
+		LOGWARNING("Audio graph has a feedback loop, it will be processed without render plan until it is removed");
+		newPlan->isValid = false;
+	}
+	else
+	{
+		newPlan->inputBuffer.setSize(jmax(graph.getTotalNumInputChannels(), 1), newPlan->blockSize);
+		newPlan->inputMidi.ensureSize(2048);
+	}
+
+	deleteRetiredPlan();
+	pendingPlan.store(newPlan.release());
+	startTimer(100); //to delete the old one once the audio thread has released it
+}
+
+void ParallelGraphProcessor::takePendingPlan()
+{
+	//the previous old plan has to be collected first, the audio thread never deletes.
+	//Only this thread fills retiredPlan, so once it's empty it stays empty until the store below
+	if (retiredPlan.load() != nullptr) return;
+
+	//single exchange, a plan skipped by the message thread in between is never taken half-way
+	RenderPlan* newPlan = pendingPlan.exchange(nullptr);
+	if (newPlan == nullptr) return;
+
+	retiredPlan.store(plan);
+	plan = newPlan;
+}
+
+void ParallelGraphProcessor::deleteRetiredPlan()
+{
+	delete retiredPlan.exchange(nullptr);
+}
+
+void ParallelGraphProcessor::processLevel(RenderPlan* p, const Array<int>& level, int numSamples)
+{
+	int numWorkersToWake = parallelEnabled ? jmin(workers.size(), level.size() - 1) : 0;
+	if (numWorkersToWake <= 0)
+	{
+		for (auto& j : level) processJob(p, p->jobs.getUnchecked(j), numSamples);
+		return;
+	}
+
+	currentPlan = p;
+	currentNumSamples = numSamples;
+	currentLevel.store(&level, std::memory_order_release);
+	jobsDone.store(0, std::memory_order_release);
+
+	uint64 generation = (jobTicket.load() >> 32) + 1;
+	jobTicket.store((generation << 32) | ((uint64)level.size() << 16), std::memory_order_release);
+
+	for (int i = 0; i < numWorkersToWake; i++) workers.getUnchecked(i)->notify();
+
+	doAvailableJobs();
+
+	//deterministic join, nothing from the next level starts before all of this one is done
+	while (jobsDone.load(std::memory_order_acquire) < level.size()) Thread::yield();
+}
+
+void ParallelGraphProcessor::doAvailableJobs()
+{
+	for (;;)
+	{
+		uint64 ticket = jobTicket.load(std::memory_order_acquire);
+		int levelSize = (int)((ticket >> 16) & 0xFFFF);
+		int index = (int)(ticket & 0xFFFF);
+		if (index >= levelSize) return;
+
+		//only valid if the claim below succeeds : the level can't change while it still has unclaimed jobs
+		const Array<int>* level = currentLevel.load(std::memory_order_acquire);
+		if (!jobTicket.compare_exchange_weak(ticket, ticket + 1, std::memory_order_acq_rel)) continue;
+
+		processJob(currentPlan, currentPlan->jobs.getUnchecked(level->getUnchecked(index)), currentNumSamples);
+		jobsDone.fetch_add(1, std::memory_order_acq_rel);
+	}
+}
+
+void ParallelGraphProcessor::processJob(RenderPlan* p, NodeJob* job, int numSamples)
+{
+	job->buffer.setSize(job->numChannels, numSamples, false, false, true);
+	job->buffer.clear();
+
+	for (auto& in : job->audioInputs)
+	{
+		const AudioBuffer<float>& source = in.sourceJob < 0 ? p->inputBuffer : p->jobs.getUnchecked(in.sourceJob)->buffer;
+		addInput(job->buffer, source, in, numSamples, !p->hasFaded);
+	}
+
+	job->midi.clear();
+	for (auto& s : job->midiSources) job->midi.addEvents(s < 0 ? p->inputMidi : p->jobs.getUnchecked(s)->midi, 0, numSamples, 0);
+
+	AudioProcessor* proc = job->node->getProcessor();
+	const ScopedLock sl(proc->getCallbackLock());
+
+	if (proc->isSuspended() || jmax(proc->getTotalNumInputChannels(), proc->getTotalNumOutputChannels()) != job->numChannels) //channels changed, until the new plan is there
+	{
+		job->buffer.clear();
+		job->wasSuspended = true;
+		return;
+	}
+
+	if (job->node->isBypassed()) proc->processBlockBypassed(job->buffer, job->midi);
+	else proc->processBlock(job->buffer, job->midi);
+
+	if (job->wasSuspended)
+	{
+		job->buffer.applyGainRamp(0, numSamples, 0, 1);
+		job->wasSuspended = false;
+	}
+}
+
+void ParallelGraphProcessor::addInput(AudioBuffer<float>& dest, const AudioBuffer<float>& source, const AudioInput& input, int numSamples, bool isFading)
+{
+	if (input.sourceChannel >= source.getNumChannels() || input.destChannel >= dest.getNumChannels()) return;
+
+	if (input.fade == 0) dest.addFrom(input.destChannel, 0, source, input.sourceChannel, 0, numSamples);
+	else if (isFading)
+	{
+		float startGain = input.fade > 0 ? 0 : 1;
+		dest.addFromWithRamp(input.destChannel, 0, source.getReadPointer(input.sourceChannel), numSamples, startGain, 1 - startGain);
+	}
+	else if (input.fade > 0) dest.addFrom(input.destChannel, 0, source, input.sourceChannel, 0, numSamples);
+	//removed connection, already faded out
+}
+
+void ParallelGraphProcessor::changeListenerCallback(ChangeBroadcaster* source)
+{
+	if (source == &graph) rebuildPlan(); //topology changed
+}
+
+void ParallelGraphProcessor::timerCallback()
+{
+	deleteRetiredPlan();
+	if (pendingPlan.load() == nullptr) stopTimer();
+}
+
+void ParallelGraphProcessor::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+	graph.setPlayConfigDetails(getTotalNumInputChannels(), getTotalNumOutputChannels(), sampleRate, maximumExpectedSamplesPerBlock);
+	graph.prepareToPlay(sampleRate, maximumExpectedSamplesPerBlock);
+	rebuildPlan();
+}
+
+void ParallelGraphProcessor::releaseResources()
+{
+	graph.releaseResources();
+}
+
+void ParallelGraphProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+	const ScopedLock sl(graph.getCallbackLock());
+
+	if (graph.isSuspended())
+	{
+		buffer.clear();
+		midiMessages.clear();
+		return;
+	}
+
+	takePendingPlan();
+
+	RenderPlan* p = plan;
+	const int numSamples = buffer.getNumSamples();
+
+	if (p == nullptr || !p->isValid || numSamples > p->blockSize)
+	{
+		graph.processBlock(buffer, midiMessages);
+		return;
+	}
+
+	//inputs are copied first, the buffer is used in place for the outputs
+	p->inputBuffer.setSize(p->inputBuffer.getNumChannels(), numSamples, false, false, true);
+	p->inputBuffer.clear();
+	for (int i = 0; i < jmin(buffer.getNumChannels(), p->inputBuffer.getNumChannels()); i++) p->inputBuffer.copyFrom(i, 0, buffer, i, 0, numSamples);
+	p->inputMidi.clear();
+	p->inputMidi.addEvents(midiMessages, 0, numSamples, 0);
+
+	buffer.clear();
+	midiMessages.clear();
+
+	for (auto& level : p->levels) processLevel(p, level, numSamples);
+
+	for (auto& o : p->audioOutputs) addInput(buffer, o.sourceJob < 0 ? p->inputBuffer : p->jobs.getUnchecked(o.sourceJob)->buffer, o, numSamples, !p->hasFaded);
+
+	for (auto& s : p->midiOutputs) midiMessages.addEvents(s < 0 ? p->inputMidi : p->jobs.getUnchecked(s)->midi, 0, numSamples, 0);
+
+	p->hasFaded = true;
+}
+
+
+ParallelGraphProcessor::Worker::Worker(ParallelGraphProcessor* owner, int index) :
+	Thread("Graph Worker " + String(index + 1)),
+	owner(owner)
+{
+#if RPISAFEMODE
+	startThread(Thread::realtimeAudioPriority); //7.0.2
+#else
+	//same scheduling as the audio callback waiting on it, a preempted worker would stall the whole level
+	if (!startRealtimeThread(Thread::RealtimeOptions().withPriority(10))) startThread(Thread::Priority::highest); //7.0.3, no realtime permission
+#endif
+}
+
+ParallelGraphProcessor::Worker::~Worker()
+{
+	signalThreadShouldExit();
+	notify();
+	stopThread(500);
+}
+
+void ParallelGraphProcessor::Worker::run()
+{
+	AudioManager::isAudioThread = true;
+
+	while (!threadShouldExit())
+	{
+		wait(100);
+		owner->doAvailableJobs();
+	}
+}
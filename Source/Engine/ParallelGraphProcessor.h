@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+	ParallelGraphProcessor.h
+	Created: 17 Oct 2026 2:14:51pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "JuceHeader.h"
+
+/* Runs the root AudioProcessorGraph from a render plan instead of letting the graph render itself.
+   The graph stays the model (nodes and connections are still added to it), and a new plan is built from it on the message thread
+   whenever the topology changes : nodes are sorted in dependency levels, and each node has its own buffer.
+
+   Plans are double-buffered : the new plan is handed to the audio thread, which picks it up at the start of a block,
+   and the old one is handed back to be deleted on the message thread, so re-patching never suspends or locks the audio.
+   Connections that were added or removed are faded in / out over the first block of the new plan, and a node
+   coming back from suspension is faded in.
+
+   With parallel processing enabled, all the nodes of a level are processed concurrently by the audio thread and a pool of worker threads,
+   with a join at the end of each level before the next one, and before the outputs are summed.
+   If the graph has a feedback loop, processing falls back to the graph itself.
+*/
+class ParallelGraphProcessor :
+	public AudioProcessor,
+	public ChangeListener,
+	public Timer
+{
+public:
+	ParallelGraphProcessor(AudioProcessorGraph& graph);
+	~ParallelGraphProcessor();
+
+	AudioProcessorGraph& graph;
+	std::atomic<bool> parallelEnabled;
+
+	struct AudioInput
+	{
+		int sourceJob; //-1 = graph audio input
+		int sourceChannel;
+		int destChannel;
+		int fade = 0; //1 = new connection, faded in on the first block of the plan, -1 = removed connection, faded out
+	};
+
+	struct NodeJob
+	{
+		AudioProcessorGraph::Node::Ptr node;
+		int numChannels = 0;
+		AudioBuffer<float> buffer;
+		MidiBuffer midi;
+		Array<AudioInput> audioInputs;
+		Array<int> midiSources; //-1 = graph midi input
+		bool wasSuspended = false; //audio thread, to fade in when the processor is resumed
+	};
+
+	struct RenderPlan
+	{
+		OwnedArray<NodeJob> jobs;
+		Array<Array<int>> levels;
+		Array<AudioInput> audioOutputs; //destChannel is the graph output channel
+		Array<int> midiOutputs;
+		AudioBuffer<float> inputBuffer;
+		MidiBuffer inputMidi;
+		int blockSize = 0;
+		bool isValid = true; //false if the graph has a feedback loop
+		bool hasFaded = false; //audio thread, set after the first block
+		Array<AudioProcessorGraph::Connection> baseConnections; //what the fades were computed against
+	};
+
+	RenderPlan* plan; //audio thread only
+	std::atomic<RenderPlan*> pendingPlan; //built, waiting to be picked up by the audio thread
+	std::atomic<RenderPlan*> retiredPlan; //released by the audio thread, waiting to be deleted
+	Array<AudioProcessorGraph::Connection> lastConnections; //connections of the last plan built
+	CriticalSection planBuildLock; //plans can be built from the message thread and the device thread (prepareToPlay), never the audio thread
+
+	class Worker :
+		public Thread
+	{
+	public:
+		Worker(ParallelGraphProcessor* owner, int index);
+		~Worker();
+
+		ParallelGraphProcessor* owner;
+		void run() override;
+	};
+
+	OwnedArray<Worker> workers;
+
+	//job dispatching for the current level, see processLevel
+	std::atomic<uint64> jobTicket; //generation (32 bits) | level size (16 bits) | next job index (16 bits)
+	std::atomic<const Array<int>*> currentLevel;
+	std::atomic<int> jobsDone;
+	RenderPlan* currentPlan;
+	int currentNumSamples;
+
+	void setNumWorkers(int numWorkers);
+	void rebuildPlan();
+	void takePendingPlan(); //audio thread, at the start of a block
+	void deleteRetiredPlan();
+
+	void processLevel(RenderPlan* p, const Array<int>& level, int numSamples);
+	void doAvailableJobs();
+	void processJob(RenderPlan* p, NodeJob* job, int numSamples);
+	static void addInput(AudioBuffer<float>& dest, const AudioBuffer<float>& source, const AudioInput& input, int numSamples, bool isFading);
+
+	void changeListenerCallback(ChangeBroadcaster* source) override;
+	void timerCallback() override;
+
+	//AudioProcessor
+	const String getName() const override { return "Parallel Graph"; }
+	void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
+	void releaseResources() override;
+	void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+	double getTailLengthSeconds() const override { return 0; }
+	bool acceptsMidi() const override { return true; }
+	bool producesMidi() const override { return true; }
+
+	AudioProcessorEditor* createEditor() override { return nullptr; }
+	bool hasEditor() const override { return false; }
+	int getNumPrograms() override { return 0; }
+	int getCurrentProgram() override { return 0; }
+	void setCurrentProgram(int index) override {}
+	const String getProgramName(int index) override { return "[NoProgram]"; }
+	void changeProgramName(int index, const String& newName) override {}
+	void getStateInformation(juce::MemoryBlock& destData) override {}
+	void setStateInformation(const void* data, int sizeInBytes) override {}
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelGraphProcessor)
+};
@@ -24,6 +24,10 @@ MIDIInterface::MIDIInterface(var params) :
 
 	autoFeedback = addBoolParameter("Auto feedback", "If auto feedback, this will send received message to output", false);
 	enableClock = addBoolParameter("Send Clock", "If checked, this will send the clock to the connected output device", false);
+	enableMTC = addBoolParameter("Send MTC", "If checked, this will send MIDI timecode following the transport to the connected output device", false);
+	syncLatency = addFloatParameter("Sync Latency", "Clock and timecode are sent this much earlier, in milliseconds, to compensate for the latency of the MIDI interface and the receiving gear", 0, -100, 100);
+	syncInputMode = addEnumParameter("Sync Input", "If set, the transport follows the clock or timecode received from the connected input device");
+	syncInputMode->addOption("None", -1)->addOption("MIDI Clock", MIDISyncInput::CLOCK)->addOption("MTC", MIDISyncInput::MTC);
 
 	isConnected = addBoolParameter("Is Connected", "This is checked if the module is connected to at least one input or output device", false);
 	isConnected->setControllableFeedbackOnly(true);
@@ -65,9 +69,20 @@ void MIDIInterface::onContainerParameterChangedInternal(Parameter* p)
 		updateMIDIDevices();
 	}
 
-	if (p == enableClock || p == enabled)
+	if (p == enableClock || p == enableMTC || p == enabled)
 	{
-		clock.setOutput(enabled->boolValue() && enableClock->boolValue() ? outputDevice : nullptr);
+		updateSyncOutputs();
+	}
+
+	if (p == syncInputMode || p == midiParam || p == enabled)
+	{
+		updateSyncInput();
+	}
+
+	if (p == syncLatency)
+	{
+		clock.latencyCompensationMS = syncLatency->floatValue();
+		mtc.latencyCompensationMS = syncLatency->floatValue();
 	}
 }
 
@@ -85,6 +100,9 @@ void MIDIInterface::clearItem()
 		}
 	};
 
+	syncInput.setActive(false);
+	clock.setOutput(nullptr);
+	mtc.setOutput(nullptr);
 	if (outputDevice != nullptr) outputDevice->close();
 	Interface::clearItem();
 }
@@ -239,6 +257,9 @@ void MIDIInterface::updateMIDIDevices()
 
 	MIDIOutputDevice* newOutput = midiParam->outputDevice;
 
+	//sync messages are sent from their own thread, stop them before closing
+	clock.setOutput(nullptr);
+	mtc.setOutput(nullptr);
 	if (outputDevice != nullptr) outputDevice->close();
 
 	if (enabled->boolValue())
@@ -248,7 +269,7 @@ void MIDIInterface::updateMIDIDevices()
 		if (outputDevice != nullptr)
 		{
 			outputDevice->open();
-			clock.setOutput(enabled->boolValue() && enableClock->boolValue() ? outputDevice : nullptr);
+			updateSyncOutputs();
 		}
 	}
 	else
@@ -261,8 +282,23 @@ void MIDIInterface::updateMIDIDevices()
 	midiInterfaceListeners.call(&MIDIInterfaceListener::deviceChanged, this);
 }
 
+void MIDIInterface::updateSyncOutputs()
+{
+	clock.setOutput(enabled->boolValue() && enableClock->boolValue() ? outputDevice : nullptr);
+	mtc.setOutput(enabled->boolValue() && enableMTC->boolValue() ? outputDevice : nullptr);
+}
+
+void MIDIInterface::updateSyncInput()
+{
+	int mode = syncInputMode->getValueData();
+	if (mode != -1) syncInput.setMode((MIDISyncInput::Mode)mode);
+	syncInput.setActive(mode != -1 && enabled->boolValue() && inputDevice != nullptr);
+}
+
 void MIDIInterface::handleIncomingMidiMessage(MidiInput* source, const MidiMessage& message)
 {
+	//before anything else, the sync input reads the clock itself when the driver gives no timestamp
+	bool isSyncMessage = syncInput.isActive() && syncInput.handleMessage(message);
 
 	midiMessageReceived(message);
 
@@ -276,7 +312,7 @@ void MIDIInterface::handleIncomingMidiMessage(MidiInput* source, const MidiMessa
 	else if (message.isAftertouch()) afterTouchReceived(message.getChannel(), message.getNoteNumber(), message.getAfterTouchValue());
 	else if (message.isChannelPressure()) channelPressureReceived(message.getChannel(), message.getChannelPressureValue());
 	else if (message.isFullFrame()) fullFrameTimecodeReceived(message);
-	else
+	else if (!isSyncMessage)
 	{
 		if (logIncomingData->boolValue()) NLOG(niceName, "Unhandled MIDI message : " << message.getDescription());
 	}
@@ -24,7 +24,13 @@ public:
 	MIDIOutputDevice* outputDevice;
 
 	MIDIClock clock;
+	MTCSender mtc;
 	BoolParameter* enableClock;
+	BoolParameter* enableMTC;
+	FloatParameter* syncLatency;
+
+	MIDISyncInput syncInput;
+	EnumParameter* syncInputMode;
 	BoolParameter* autoFeedback;
 
 
@@ -69,6 +75,8 @@ public:
 
 	void onContainerParameterChangedInternal(Parameter* p) override;
 	void updateMIDIDevices();
+	void updateSyncOutputs();
+	void updateSyncInput();
 
 	virtual void handleIncomingMidiMessage(MidiInput* source,
 		const MidiMessage& message) override;
@@ -155,20 +155,91 @@ void OSCInterface::processMessage(const OSCMessage& msg)
 
 	if (scriptManager->items.size() > 0)
 	{
+		String address = msg.getAddressPattern().toString();
+
+		Array<Identifier> callbacks;
+		getScriptCallbacks(msg, address, callbacks);
+
+		bool callOSCEvent = hasOSCEventHandler();
+		if (callbacks.isEmpty() && !callOSCEvent) return; //nobody listens to this address, don't convert the arguments
+
 		Array<var> params;
-		params.add(msg.getAddressPattern().toString());
+		params.add(address);
 		var args = var(Array<var>()); //initialize force array
 		for (auto& a : msg) args.append(OSCInterface::argumentToVar(a));
 		params.add(args);
-		scriptManager->callFunctionOnAllItems(oscEventId, params);
+		if (callOSCEvent) scriptManager->callFunctionOnAllItems(oscEventId, params);
 
-		for (auto& entry : scriptCallbacks)
-			if (std::get<0>(entry).matches(msg.getAddressPattern().toString()))
-				scriptManager->callFunctionOnAllItems(std::get<1>(entry), params);
+		for (auto& c : callbacks) scriptManager->callFunctionOnAllItems(c, params);
 	}
 
 }
 
+void OSCInterface::rebuildScriptCallbackIndex()
+{
+	std::unordered_map<String, Array<Identifier>> newExactCallbacks;
+	Array<std::tuple<OSCAddressPattern, Identifier, String>> newPatternCallbacks;
+
+	for (auto& entry : scriptCallbacks)
+	{
+		const OSCAddressPattern& pattern = std::get<0>(entry);
+		String patternString = pattern.toString();
+
+		if (!pattern.containsWildcards())
+		{
+			newExactCallbacks[patternString].add(std::get<1>(entry));
+			continue;
+		}
+
+		int prefixLength = patternString.indexOfAnyOf("*?[]{}");
+		newPatternCallbacks.add(std::make_tuple(pattern, std::get<1>(entry), patternString.substring(0, prefixLength)));
+	}
+
+	const ScopedLock sl(scriptCallbacksLock);
+	exactScriptCallbacks.swap(newExactCallbacks);
+	newPatternCallbacks.swapWith(patternScriptCallbacks);
+	matchedScriptCallbacks.clear();
+}
+
+void OSCInterface::getScriptCallbacks(const OSCMessage& msg, const String& address, Array<Identifier>& result)
+{
+	const ScopedLock sl(scriptCallbacksLock);
+
+	auto it = exactScriptCallbacks.find(address);
+	if (it != exactScriptCallbacks.end()) result.addArray(it->second);
+
+	if (patternScriptCallbacks.isEmpty() || msg.getAddressPattern().containsWildcards()) return;
+
+	//patterns are matched once per address, then it's a single lookup
+	auto matched = matchedScriptCallbacks.find(address);
+	if (matched == matchedScriptCallbacks.end())
+	{
+		if (matchedScriptCallbacks.size() >= maxMatchedAddresses) matchedScriptCallbacks.clear(); //addresses that change all the time (ids in the address)
+
+		Array<Identifier> patternCallbacks;
+		OSCAddress oscAddress(address);
+		for (auto& entry : patternScriptCallbacks)
+		{
+			if (address.startsWith(std::get<2>(entry)) && std::get<0>(entry).matches(oscAddress)) patternCallbacks.add(std::get<1>(entry));
+		}
+
+		matched = matchedScriptCallbacks.emplace(address, patternCallbacks).first;
+	}
+
+	result.addArray(matched->second);
+}
+
+bool OSCInterface::hasOSCEventHandler()
+{
+	//a script only gets oscEvent calls if it defines it
+	for (auto& s : scriptManager->items)
+	{
+		if (s->scriptEngine != nullptr && s->scriptEngine->getRootObjectProperties().contains(oscEventId)) return true;
+	}
+
+	return false;
+}
+
 void OSCInterface::itemAdded(OSCOutput* output)
 {
 	output->warningResolveInspectable = this;
@@ -346,6 +417,7 @@ var OSCInterface::registerOSCCallbackFromScript(const var::NativeFunctionArgs& a
 				return var();
 
 		m->scriptCallbacks.add(std::make_tuple(pattern, callbackName));
+		m->rebuildScriptCallbackIndex();
 	}
 	catch (OSCFormatError& e)
 	{
@@ -539,7 +611,11 @@ OSCOutput::OSCOutput() :
 	BaseItem("OSC Output"),
 	Thread("OSC output"),
 	forceDisabled(false),
-	senderIsConnected(false)
+	senderIsConnected(false),
+	targetPort(0),
+	queue(queueCapacity),
+	numDropped(0),
+	numTooBig(0)
 {
 	isSelectable = false;
 
@@ -549,6 +625,8 @@ OSCOutput::OSCOutput() :
 	remoteHost->setEnabled(!useLocal->boolValue());
 	remotePort = addIntParameter("Remote port", "Port on which the remote host is listening to", 9000, 1024, 65535);
 	listenToOutputFeedback = addBoolParameter("Listen to Feedback", "If checked, this will listen to the (randomly set) bound port of this sender. This is useful when some softwares automatically detect incoming host and port to send back messages.", false);
+	maxRate = addIntParameter("Max Rate", "Maximum number of sends per second. Messages to the same address in between are merged and only the last value is sent, which keeps feedback like meters from flooding the network. 0 sends every message as soon as possible.", 0, 0, 1000);
+	useBundles = addBoolParameter("Use Bundles", "If checked, messages waiting to be sent are packed in OSC bundles, up to the network packet size, instead of one packet per message", false);
 
 	if (!Engine::mainEngine->isLoadingFile) setupSender();
 }
@@ -593,14 +671,10 @@ void OSCOutput::setupSender()
 	if (isThreadRunning())
 	{
 		stopThread(1000);
-		// Clear queue
-		const ScopedLock sl(queueLock);
-		while (!messageQueue.empty())
-			messageQueue.pop();
+		clearQueue();
 	}
 
 	senderIsConnected = false;
-	sender.disconnect();
 	socket.reset();
 
 	if (receiver != nullptr) receiver->disconnect();
@@ -608,11 +682,11 @@ void OSCOutput::setupSender()
 
 	if (!enabled->boolValue() || forceDisabled || Engine::mainEngine->isClearing) return;
 
-	String targetHost = useLocal->boolValue() ? "127.0.0.1" : remoteHost->stringValue();
+	targetHost = useLocal->boolValue() ? "127.0.0.1" : remoteHost->stringValue();
+	targetPort = remotePort->intValue();
 	socket.reset(new DatagramSocket(true));
 	socket->setEnablePortReuse(true);
-	socket->bindToPort(0);
-	senderIsConnected = sender.connectToSocket(*socket, targetHost, remotePort->intValue());
+	senderIsConnected = socket->bindToPort(0);
 
 	if (senderIsConnected)
 	{
@@ -637,36 +711,170 @@ void OSCOutput::sendOSC(const OSCMessage& m)
 {
 	if (!enabled->boolValue() || forceDisabled || !senderIsConnected) return;
 
-	{
-		const ScopedLock sl(queueLock);
-		messageQueue.push(std::make_unique<OSCMessage>(m));
-	}
+	QueuedMessage qm;
+	if (!encodeMessage(m, qm)) numTooBig++;
+	else if (!queue.push(qm)) numDropped++;
 	notify();
 }
 
 void OSCOutput::run()
 {
+	Array<QueuedMessage> pending;
+	std::unordered_map<String, int> pendingIndices; //address -> index in pending, when merging
+	QueuedMessage m;
+
 	while (!Engine::mainEngine->isClearing && !threadShouldExit())
 	{
-		std::unique_ptr<OSCMessage> msgToSend;
+		uint32 cycleStart = Time::getMillisecondCounter();
+		int rate = maxRate->intValue();
+
+		pending.clearQuick();
+		pendingIndices.clear();
 
+		while (queue.pop(m))
 		{
-			const ScopedLock sl(queueLock);
-			if (!messageQueue.empty())
+			if (rate == 0)
 			{
-				msgToSend = std::move(messageQueue.front());
-				messageQueue.pop();
+				pending.add(m);
+				continue;
+			}
+
+			//last value wins, at the place of the first message to this address. The packet starts with the address
+			String address(CharPointer_UTF8(m.data));
+			auto it = pendingIndices.find(address);
+			if (it != pendingIndices.end()) pending.getReference(it->second) = m;
+			else
+			{
+				pendingIndices[address] = pending.size();
+				pending.add(m);
 			}
 		}
 
-		if (msgToSend)
-			sender.send(*msgToSend);
-		else
+		int dropped = numDropped.exchange(0);
+		if (dropped > 0) NLOGWARNING(niceName, dropped << " messages were dropped, the output can't keep up");
+		int tooBig = numTooBig.exchange(0);
+		if (tooBig > 0) NLOGWARNING(niceName, tooBig << " messages were dropped, they are bigger than " << maxMessageSize << " bytes");
+
+		if (pending.isEmpty())
+		{
 			wait(1000); // notify() is called when a message is added to the queue
+			continue;
+		}
+
+		sendPending(pending);
+
+		if (rate > 0) //whatever comes in until the next period will be merged
+		{
+			uint32 periodMS = 1000 / rate;
+			for (;;)
+			{
+				uint32 elapsed = Time::getMillisecondCounter() - cycleStart;
+				if (elapsed >= periodMS || threadShouldExit()) break;
+				wait((int)(periodMS - elapsed));
+			}
+		}
+	}
+
+	clearQueue();
+}
+
+void OSCOutput::sendPending(const Array<QueuedMessage>& messages)
+{
+	if (!useBundles->boolValue())
+	{
+		for (auto& msg : messages) socket->write(targetHost, targetPort, msg.data, msg.size);
+		return;
+	}
+
+	//"#bundle", then a time tag of 1 (immediately), then each message prefixed by its size
+	const int bundleHeaderSize = 16;
+	char bundle[maxPacketSize];
+	memcpy(bundle, "#bundle\0\0\0\0\0\0\0\0\1", bundleHeaderSize);
+	int bundleSize = bundleHeaderSize;
+
+	for (auto& msg : messages)
+	{
+		if (bundleSize + 4 + msg.size > maxPacketSize)
+		{
+			socket->write(targetHost, targetPort, bundle, bundleSize);
+			bundleSize = bundleHeaderSize;
+		}
+
+		uint32 size = ByteOrder::swapIfLittleEndian((uint32)msg.size);
+		memcpy(bundle + bundleSize, &size, 4);
+		memcpy(bundle + bundleSize + 4, msg.data, msg.size);
+		bundleSize += 4 + msg.size;
+	}
+
+	if (bundleSize > bundleHeaderSize) socket->write(targetHost, targetPort, bundle, bundleSize);
+}
+
+bool OSCOutput::encodeMessage(const OSCMessage& m, QueuedMessage& result)
+{
+	//OSC 1.0 encoding : big endian, every field zero padded to a multiple of 4 bytes
+	int size = 0;
+	auto write = [&result, &size](const void* bytes, int numBytes, int paddedSize)
+	{
+		if (size + paddedSize > maxMessageSize) return false;
+		memcpy(result.data + size, bytes, numBytes);
+		memset(result.data + size + numBytes, 0, paddedSize - numBytes);
+		size += paddedSize;
+		return true;
+	};
+
+	auto writeString = [&write](const String& s)
+	{
+		int numBytes = (int)s.getNumBytesAsUTF8();
+		return write(s.toRawUTF8(), numBytes, (numBytes + 4) & ~3); //at least one terminating zero
+	};
+
+	auto writeInt = [&write](uint32 value)
+	{
+		value = ByteOrder::swapIfLittleEndian(value);
+		return write(&value, 4, 4);
+	};
+
+	if (!writeString(m.getAddressPattern().toString())) return false;
+
+	char typeTags[maxMessageSize];
+	int numTags = 0;
+	typeTags[numTags++] = ',';
+	for (auto& a : m)
+	{
+		if (numTags >= maxMessageSize) return false;
+		typeTags[numTags++] = a.getType();
+	}
+	if (!write(typeTags, numTags, (numTags + 4) & ~3)) return false;
+
+	for (auto& a : m)
+	{
+		bool ok = false;
+		if (a.isInt32()) ok = writeInt((uint32)a.getInt32());
+		else if (a.isFloat32())
+		{
+			float f = a.getFloat32();
+			uint32 bits;
+			memcpy(&bits, &f, 4);
+			ok = writeInt(bits);
+		}
+		else if (a.isString()) ok = writeString(a.getString());
+		else if (a.isBlob())
+		{
+			const MemoryBlock& b = a.getBlob();
+			int numBytes = (int)b.getSize();
+			ok = writeInt((uint32)numBytes) && write(b.getData(), numBytes, (numBytes + 3) & ~3);
+		}
+		else if (a.isColour()) ok = writeInt(a.getColour().toInt32());
+
+		if (!ok) return false;
 	}
 
-	// Clear queue
-	const ScopedLock sl(queueLock);
-	while (!messageQueue.empty())
-		messageQueue.pop();
-}
\ No newline at end of file
+	result.size = size;
+	return true;
+}
+
+void OSCOutput::clearQueue()
+{
+	QueuedMessage m;
+	while (queue.pop(m)) {}
+}
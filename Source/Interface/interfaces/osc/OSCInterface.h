@@ -29,6 +29,8 @@ public:
 	StringParameter* remoteHost;
 	IntParameter* remotePort;
 	BoolParameter* listenToOutputFeedback;
+	IntParameter* maxRate;
+	BoolParameter* useBundles;
 	std::unique_ptr<OSCReceiver> receiver;
 	std::unique_ptr<DatagramSocket> socket;
 
@@ -45,9 +47,27 @@ public:
 	//virtual InspectableEditor* getEditor(bool isRoot) override;
 
 private:
-	OSCSender sender;
-	std::queue<std::unique_ptr<OSCMessage>> messageQueue;
-	CriticalSection queueLock;
+	static const int queueCapacity = 2048;
+	static const int maxMessageSize = 512; //bigger messages are dropped
+	static const int maxPacketSize = 1400; //stay under the usual ethernet MTU so bundles are not fragmented
+
+	//A message encoded to its OSC packet when it's queued, so pushing only copies plain bytes and never allocates
+	struct QueuedMessage
+	{
+		int size = 0;
+		char data[maxMessageSize];
+	};
+
+	String targetHost;
+	int targetPort;
+
+	LockFreeQueue<QueuedMessage> queue; //any thread pushes, the output thread pops
+	std::atomic<int> numDropped;
+	std::atomic<int> numTooBig;
+
+	static bool encodeMessage(const OSCMessage& m, QueuedMessage& result); //false if it doesn't fit
+	void clearQueue();
+	void sendPending(const Array<QueuedMessage>& messages);
 };
 
 class OSCInterface :
@@ -130,4 +150,17 @@ public:
 
 private:
 	Array<std::tuple<OSCAddressPattern, Identifier>> scriptCallbacks;
+
+	//Index of scriptCallbacks, rebuilt when a callback is registered :
+	//plain addresses are found with a single lookup, patterns with wildcards are only tested if the address starts with their literal part
+	std::unordered_map<String, Array<Identifier>> exactScriptCallbacks;
+	Array<std::tuple<OSCAddressPattern, Identifier, String>> patternScriptCallbacks; //pattern, callback, literal prefix
+	std::unordered_map<String, Array<Identifier>> matchedScriptCallbacks; //pattern callbacks of the addresses already received, reset with the index
+	CriticalSection scriptCallbacksLock;
+
+	static const int maxMatchedAddresses = 4096;
+
+	void rebuildScriptCallbackIndex();
+	void getScriptCallbacks(const OSCMessage& msg, const String& address, Array<Identifier>& result);
+	bool hasOSCEventHandler();
 };
\ No newline at end of file
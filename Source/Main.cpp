@@ -10,16 +10,31 @@
 #include "MainComponent.h"
 #include "Engine/LGMLEngine.h"
 #include "Engine/VSTManager.h"
+#include "Engine/OfflineRenderer.h"
+#include "Engine/NodeBenchmark.h"
 
 LGMLApplication::LGMLApplication() :
 	OrganicApplication(ProjectInfo::projectName,
-		true, ImageCache::getFromMemory(BinaryData::icon_png, BinaryData::icon_pngSize))
+		!isHeadlessCommandLine(getCommandLineParameters()), ImageCache::getFromMemory(BinaryData::icon_png, BinaryData::icon_pngSize))
 {
 }
 
-void LGMLApplication::initialiseInternal(const String&)
+void LGMLApplication::initialiseInternal(const String& commandLine)
 {
 	engine.reset(new LGMLEngine());
+
+	if (OfflineRenderer::isRenderCommandLine(commandLine))
+	{
+		offlineRenderer.reset(new OfflineRenderer(OfflineRenderer::parseCommandLine(commandLine)));
+		return; //headless, no UI
+	}
+
+	if (NodeBenchmark::isBenchmarkCommandLine(commandLine))
+	{
+		benchmark.reset(new NodeBenchmark(commandLine));
+		return;
+	}
+
 	mainComponent.reset(new MainComponent());
 
 	//Call after engine init
@@ -37,12 +52,36 @@ void LGMLApplication::initialiseInternal(const String&)
 
 void LGMLApplication::afterInit()
 {
+	if (offlineRenderer != nullptr)
+	{
+		offlineRenderer->start();
+		return;
+	}
+
+	if (benchmark != nullptr)
+	{
+		MessageManager::callAsync([this]() { benchmark->start(); }); //let the engine finish its init first
+		return;
+	}
+
 	if (mainWindow != nullptr)
 	{
 		mainWindow->setMenuBarComponent(new LGMLMenuBarComponent((MainComponent*)mainComponent.get(), (LGMLEngine*)engine.get()));
 	}
 }
 
+void LGMLApplication::shutdown()
+{
+	offlineRenderer.reset(); //before the engine is deleted
+	benchmark.reset();
+	OrganicApplication::shutdown();
+}
+
+bool LGMLApplication::isHeadlessCommandLine(const String& commandLine)
+{
+	return OfflineRenderer::isRenderCommandLine(commandLine) || NodeBenchmark::isBenchmarkCommandLine(commandLine);
+}
+
 void LGMLApplication::clearGlobalSettings()
 {
 	OrganicApplication::clearGlobalSettings();
@@ -12,14 +12,23 @@
 
 #include <JuceHeader.h>
 
+class OfflineRenderer;
+class NodeBenchmark;
+
 class LGMLApplication : public OrganicApplication
 {
 public:
     //==============================================================================
     LGMLApplication();
 
+    std::unique_ptr<OfflineRenderer> offlineRenderer; //headless mode, when launched with -render
+    std::unique_ptr<NodeBenchmark> benchmark; //headless mode, when launched with -benchmark
+
+    static bool isHeadlessCommandLine(const String& commandLine);
+
     void initialiseInternal(const String& commandLine) override;
     void afterInit() override;
+    void shutdown() override;
 
     void clearGlobalSettings() override;
 }; 
@@ -169,6 +169,8 @@ bool MainComponent::handleControllableMenuResult(ControllableUI* ui, int result)
 				LOG("Added " << c->niceName << " to ignore list in preset " << preset->niceName);
 			}
 
+			preset->invalidateSnapshot();
+
 		}
 
 		return true;
@@ -11,6 +11,8 @@
 #include "Node/NodeIncludes.h"
 #include "Interface/InterfaceIncludes.h"
 
+thread_local bool Node::isMirroringAudioValues = false;
+
 Node::Node(StringRef name, var params, bool hasAudioInput, bool hasAudioOutput, bool userCanSetIO, bool useOutControl, bool canHaveMidiDeviceIn, bool canHaveMidiDeviceOut) :
 	BaseItem(name, true),
 	graph(nullptr),
@@ -27,9 +29,12 @@ Node::Node(StringRef name, var params, bool hasAudioInput, bool hasAudioOutput,
 	//currentOutDevice(nullptr),
 	pedalSustain(nullptr),
 	forceSustain(nullptr),
+	profilerCC("Profiler"),
 	viewCC("View"),
 	showOutControl(nullptr),
 	bypassAntiClickCount(anticlickBlocks),
+	commandQueue(1024),
+	numPendingCommands(0),
 	nodeNotifier(5)
 {
 	showWarningInUI = true;
@@ -40,6 +45,8 @@ Node::Node(StringRef name, var params, bool hasAudioInput, bool hasAudioOutput,
 	processor = new NodeAudioProcessor(this);
 	processor->setPlayHead(Transport::getInstance());
 
+	pendingCommands.allocate(commandQueue.getCapacity(), true);
+
 	hideInEditor = true;
 	editorIsCollapsed = true;
 
@@ -67,10 +74,24 @@ Node::Node(StringRef name, var params, bool hasAudioInput, bool hasAudioOutput,
 	{
 		outControl.reset(new VolumeControl("Out", true));
 		addChildControllableContainer(outControl.get());
+		audioVolumes.add(outControl.get());
 
 		showOutControl = viewCC.addBoolParameter("Show Out Control", "Shows the Gain, RMS and Active on the right side in the view", true);
 	}
 
+	processTimeMin = profilerCC.addFloatParameter("Process Time Min", "Minimum time spent in this node's processBlock over the last blocks, in milliseconds", 0, 0);
+	processTimeAvg = profilerCC.addFloatParameter("Process Time Avg", "Average time spent in this node's processBlock over the last blocks, in milliseconds", 0, 0);
+	processTimeP99 = profilerCC.addFloatParameter("Process Time P99", "99th percentile of the time spent in this node's processBlock over the last blocks, in milliseconds. Spikes here are what make the audio crackle", 0, 0);
+	cpuShare = profilerCC.addFloatParameter("CPU Share", "Average percentage of the audio block duration used by this node", 0, 0, 100);
+	for (auto& c : profilerCC.controllables) c->setControllableFeedbackOnly(true);
+
+	profilerCC.editorIsCollapsed = true;
+	profilerCC.hideInRemoteControl = true;
+	profilerCC.defaultHideInRemoteControl = true;
+	addChildControllableContainer(&profilerCC);
+
+	showCPUShare = viewCC.addBoolParameter("Show CPU Share", "Shows the percentage of the audio block used by this node in the header of the view", false);
+
 	viewCC.hideInRemoteControl = true;
 	viewCC.defaultHideInRemoteControl = true;
 	addChildControllableContainer(&viewCC);
@@ -112,6 +133,13 @@ void Node::clearItem()
 	BaseItem::clearItem();
 	setMIDIInterface(nullptr);
 	//setMIDIOutDevice(nullptr);
+
+	//the processor can outlive us in a render plan that is still playing, it will just output silence
+	{
+		const ScopedLock sl(processor->getCallbackLock());
+		processor->node = nullptr;
+	}
+
 	if (nodeGraphPtr != nullptr && graph != nullptr) graph->removeNode(nodeGraphPtr.get());
 	masterReference.clear();
 }
@@ -123,6 +151,9 @@ void Node::init(AudioProcessorGraph* _graph)
 
 	ScopedSuspender sp(processor);
 
+#if LGML_RT_CHECKS
+	updateRTCheckName();
+#endif
 
 	initInternal();
 
@@ -133,6 +164,7 @@ void Node::init(AudioProcessorGraph* _graph)
 	else updateAudioOutputs(false);
 
 	updatePlayConfig();
+	syncAudioValues();
 
 	nodeGraphPtr = graph->addNode(std::unique_ptr<NodeAudioProcessor>(processor), AudioProcessorGraph::NodeID(nodeGraphID));
 
@@ -176,6 +208,13 @@ void Node::onContainerParameterChangedInternal(Parameter* p)
 
 void Node::onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c)
 {
+	if (c->type != Controllable::TRIGGER && !isMirroringAudioValues && !isCurrentlyLoadingData)
+	{
+		AudioCommand command;
+		Parameter* p = (Parameter*)c;
+		if (getAudioValueCommand(p, p->floatValue(), command)) sendAudioCommand(command.type, command.index, command.value);
+	}
+
 	if (cc == &viewCC)
 	{
 		if (!isCurrentlyLoadingData) nodeNotifier.addMessage(new NodeEvent(NodeEvent::VIEW_FILTER_UPDATED, this));
@@ -191,6 +230,13 @@ void Node::onControllableFeedbackUpdateInternal(ControllableContainer* cc, Contr
 	}
 }
 
+void Node::afterLoadJSONDataInternal()
+{
+	//values are not sent while loading, the audio thread gets them all at once
+	ScopedSuspender sp(processor);
+	syncAudioValues();
+}
+
 void Node::setAudioInputs(const int& numInputs, bool updateConfig)
 {
 	StringArray s;
@@ -253,30 +299,32 @@ void Node::updateAudioOutputs(bool updateConfig)
 
 void Node::addInConnection(NodeConnection* c)
 {
-	ScopedSuspender sp(processor);
+	const ScopedLock sl(processor->getCallbackLock()); //only waits for the current block, no need to suspend and cut the sound
 	if (c->connectionType == NodeConnection::AUDIO) inAudioConnections.addIfNotAlreadyThere((NodeAudioConnection*)c);
 	else if (c->connectionType == NodeConnection::MIDI) inMidiConnections.addIfNotAlreadyThere((NodeMIDIConnection*)c);
 }
 
 void Node::removeInConnection(NodeConnection* c)
 {
-	ScopedSuspender sp(processor);
+	const ScopedLock sl(processor->getCallbackLock());
 	if (c->connectionType == NodeConnection::AUDIO) inAudioConnections.removeAllInstancesOf((NodeAudioConnection*)c);
 	else if (c->connectionType == NodeConnection::MIDI) inMidiConnections.removeAllInstancesOf((NodeMIDIConnection*)c);
 }
 
 void Node::addOutConnection(NodeConnection* c)
 {
-	ScopedSuspender sp(processor);
+	const ScopedLock sl(processor->getCallbackLock());
 	if (c->connectionType == NodeConnection::AUDIO) outAudioConnections.addIfNotAlreadyThere((NodeAudioConnection*)c);
 	else if (c->connectionType == NodeConnection::MIDI) outMidiConnections.addIfNotAlreadyThere((NodeMIDIConnection*)c);
+	connectionsActivityLevels.resize(outAudioConnections.size()); //sized here so processBlock doesn't grow it
 }
 
 void Node::removeOutConnection(NodeConnection* c)
 {
-	ScopedSuspender sp(processor);
+	const ScopedLock sl(processor->getCallbackLock());
 	if (c->connectionType == NodeConnection::AUDIO) outAudioConnections.removeAllInstancesOf((NodeAudioConnection*)c);
 	else if (c->connectionType == NodeConnection::MIDI) outMidiConnections.removeAllInstancesOf((NodeMIDIConnection*)c);
+	connectionsActivityLevels.resize(outAudioConnections.size());
 }
 
 void Node::setMIDIIO(bool hasInput, bool hasOutput)
@@ -332,10 +380,118 @@ void Node::updatePlayConfig(bool notify)
 void Node::updatePlayConfigInternal()
 {
 	processor->setPlayConfigDetails(audioInputNames.size(), audioOutputNames.size(), graph->getSampleRate(), graph->getBlockSize());
+	scratchBuffers.prepare(jmax(audioInputNames.size(), audioOutputNames.size()), graph->getBlockSize());
     
     if(graph->getSampleRate() > 0) midiCollector.reset(graph->getSampleRate());
 }
 
+void Node::updateProfilerStats()
+{
+	ProcessTimeProfiler::Stats stats = profiler.computeStats();
+	processTimeMin->setValue(stats.min);
+	processTimeAvg->setValue(stats.avg);
+	processTimeP99->setValue(stats.p99);
+
+	double sampleRate = processor->getSampleRate();
+	int blockSize = processor->getBlockSize();
+	float blockTimeMS = sampleRate > 0 && blockSize > 0 ? (float)(blockSize * 1000.0 / sampleRate) : 0;
+	cpuShare->setValue(blockTimeMS > 0 ? stats.avg * 100 / blockTimeMS : 0);
+}
+
+bool Node::sendAudioCommand(int type, int index, float value, int64 timestamp)
+{
+	AudioCommand c;
+	c.type = type;
+	c.index = index;
+	c.value = value;
+	c.timestamp = timestamp;
+
+	if (commandQueue.push(c)) return true;
+
+	NLOGWARNING(niceName, "Command queue is full, command has been dropped");
+	return false;
+}
+
+void Node::processAudioCommands(int numSamples)
+{
+	const int capacity = commandQueue.getCapacity();
+
+	AudioCommand c;
+	while (commandQueue.pop(c))
+	{
+		if (numPendingCommands >= capacity)
+		{
+			applyAudioCommand(c, 0); //no room to keep it for later, better late than never
+			continue;
+		}
+
+		//insert sorted, commands for the next block (-1) first, equal times stay in the order they were sent
+		int insertIndex = numPendingCommands;
+		while (insertIndex > 0 && pendingCommands[insertIndex - 1].timestamp > c.timestamp)
+		{
+			pendingCommands[insertIndex] = pendingCommands[insertIndex - 1];
+			insertIndex--;
+		}
+		pendingCommands[insertIndex] = c;
+		numPendingCommands++;
+	}
+
+	if (numPendingCommands == 0) return;
+
+	//timestamps are in Transport time, which is only moved forward after the graph has processed the block
+	const int64 blockStart = Transport::getInstance()->timeInSamples;
+	int numDone = 0;
+	while (numDone < numPendingCommands && pendingCommands[numDone].timestamp < blockStart + numSamples)
+	{
+		const AudioCommand& pc = pendingCommands[numDone];
+		applyAudioCommand(pc, pc.timestamp < blockStart ? 0 : (int)(pc.timestamp - blockStart));
+		numDone++;
+	}
+
+	if (numDone == 0) return;
+	numPendingCommands -= numDone;
+	for (int i = 0; i < numPendingCommands; i++) pendingCommands[i] = pendingCommands[i + numDone];
+}
+
+void Node::applyAudioCommand(const AudioCommand& command, int sampleOffset)
+{
+	if (command.type == VOLUME_GAIN_COMMAND)
+	{
+		if (VolumeControl* vc = audioVolumes[command.index]) vc->audioGain = command.value;
+	}
+	else handleAudioCommand(command, sampleOffset);
+}
+
+void Node::registerAudioVolume(VolumeControl* vc)
+{
+	vc->audioGain = vc->getGain();
+	audioVolumes.addIfNotAlreadyThere(vc);
+}
+
+void Node::unregisterAudioVolume(VolumeControl* vc)
+{
+	audioVolumes.removeAllInstancesOf(vc);
+}
+
+bool Node::getAudioValueCommand(Parameter* p, float value, AudioCommand& command)
+{
+	VolumeControl* vc = dynamic_cast<VolumeControl*>(p->parentContainer.get());
+	if (vc == nullptr || (p != vc->gain && p != vc->active)) return false;
+
+	int index = audioVolumes.indexOf(vc);
+	if (index == -1) return false;
+
+	command.type = VOLUME_GAIN_COMMAND;
+	command.index = index;
+	command.value = vc->getGainForValue(p, value);
+	return true;
+}
+
+void Node::syncAudioValues()
+{
+	for (auto& vc : audioVolumes) vc->audioGain = vc->getGain();
+}
+
 void Node::midiMessageReceived(MIDIInterface* i, const MidiMessage& m)
 {
 	if (!enabled->boolValue()) return;
@@ -369,7 +525,7 @@ void Node::midiMessageReceived(MIDIInterface* i, const MidiMessage& m)
 
 	if (addToQueue)
 	{
-		if (processor->getSampleRate() != 0) midiCollector.addMessageToQueue(m);
+		if (processor->getSampleRate() != 0 && !midiInputQueue.push(m)) midiCollector.addMessageToQueue(m);
 	}
 }
 
@@ -400,9 +556,9 @@ void Node::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 		return;
 	}
 
-	ScopedLock sl(processor->getCallbackLock());
-
-
+	ProcessTimeProfiler::ScopedMeasure profilerMeasure(profiler);
+	RT_CHECK_SCOPE(rtCheckName, "processBlock");
+	RTCheckedScopedLock<CriticalSection> sl(processor->getCallbackLock(), "callbackLock");
 
 	int numInputs = getNumAudioInputs();
 	int numOutputs = getNumAudioOutputs();
@@ -424,7 +580,16 @@ void Node::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
     }
     
 	//MIDI
-    if(hasMIDIInput) midiCollector.removeNextBlockOfMessages(midiMessages, buffer.getNumSamples());
+    if(hasMIDIInput)
+    {
+        midiCollector.removeNextBlockOfMessages(midiMessages, buffer.getNumSamples());
+
+        AudioManager* am = AudioManager::getInstance();
+        double blockTimeMS = am->isOffline ? Time::getMillisecondCounterHiRes() : am->blockTimeMS.load();
+        midiInputQueue.removeNextBlockOfMessages(midiMessages, buffer.getNumSamples(), processor->getSampleRate(), blockTimeMS);
+    }
+
+	processAudioCommands(buffer.getNumSamples());
 
 	bool isEnabled = enabled->boolValue();
 	bool antiClickFinished = bypassAntiClickCount == (isEnabled ? anticlickBlocks : 0);
@@ -433,23 +598,39 @@ void Node::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 
 		if (isEnabled)
 		{
-			processBlockInternal(buffer, midiMessages);
+			{
+				RT_CHECK_SCOPE(rtCheckName, "processBlockInternal");
+				processBlockInternal(buffer, midiMessages);
+			}
 			if (outControl != nullptr) outControl->applyGain(buffer);
 		}
 		else
 		{
-			processBlockBypassed(buffer, midiMessages);
+			{
+				RT_CHECK_SCOPE(rtCheckName, "processBlockBypassed");
+				processBlockBypassed(buffer, midiMessages);
+			}
 			if (outControl != nullptr) outControl->updateRMS(buffer);
 		}
 	}
 	else
 	{
-		AudioSampleBuffer b1;
-		b1.makeCopyOf(buffer);
-		AudioSampleBuffer b2;
-		b2.makeCopyOf(buffer);
-		processBlockInternal(b1, midiMessages);
-		processBlockBypassed(b2, midiMessages);
+		ScopedScratchBuffer b1(scratchBuffers, buffer.getNumChannels(), buffer.getNumSamples(), false);
+		ScopedScratchBuffer b2(scratchBuffers, buffer.getNumChannels(), buffer.getNumSamples(), false);
+		for (int i = 0; i < buffer.getNumChannels(); i++)
+		{
+			b1.buffer.copyFrom(i, 0, buffer, i, 0, buffer.getNumSamples());
+			b2.buffer.copyFrom(i, 0, buffer, i, 0, buffer.getNumSamples());
+		}
+
+		{
+			RT_CHECK_SCOPE(rtCheckName, "processBlockInternal");
+			processBlockInternal(b1.buffer, midiMessages);
+		}
+		{
+			RT_CHECK_SCOPE(rtCheckName, "processBlockBypassed");
+			processBlockBypassed(b2.buffer, midiMessages);
+		}
 		buffer.clear();
 
 		float curVal = bypassAntiClickCount * 1.0f / anticlickBlocks;
@@ -463,8 +644,8 @@ void Node::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 
 		for (int i = 0; i < buffer.getNumChannels(); i++)
 		{
-			buffer.addFromWithRamp(i, 0, b1.getReadPointer(i), buffer.getNumSamples(), curVal, nextVal);
-			buffer.addFromWithRamp(i, 0, b2.getReadPointer(i), buffer.getNumSamples(), 1 - curVal, 1 - nextVal);
+			buffer.addFromWithRamp(i, 0, b1.buffer.getReadPointer(i), buffer.getNumSamples(), curVal, nextVal);
+			buffer.addFromWithRamp(i, 0, b2.buffer.getReadPointer(i), buffer.getNumSamples(), 1 - curVal, 1 - nextVal);
 		}
 	}
 
@@ -522,6 +703,14 @@ void Node::loadJSONDataItemInternal(var data)
 	}
 }
 
+#if LGML_RT_CHECKS
+void Node::updateRTCheckName()
+{
+	String n = niceName + " (" + getTypeString() + ")";
+	n.copyToUTF8(rtCheckName, sizeof(rtCheckName));
+}
+#endif
+
 BaseNodeViewUI* Node::createViewUI()
 {
 	return new BaseNodeViewUI(this);
@@ -550,7 +739,19 @@ void NodeAudioProcessor::resume()
 	if (suspendCount == 0) suspendProcessing(false);
 }
 
+void NodeAudioProcessor::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+	if (node == nullptr) return;
+	node->scratchBuffers.prepare(jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()), maximumExpectedSamplesPerBlock);
+#if LGML_RT_CHECKS
+	node->updateRTCheckName();
+#endif
+	node->prepareToPlay(sampleRate, maximumExpectedSamplesPerBlock);
+}
+
 void NodeAudioProcessor::numChannelsChanged()
 {
+	if (node == nullptr) return;
+	if (node->graph != nullptr) node->graph->sendChangeMessage(); //buffers of the render plan have to follow
 	NLOG(node->niceName, "Channels changed : " << getTotalNumInputChannels() << ":" << getTotalNumOutputChannels());
 }
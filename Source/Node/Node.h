@@ -64,7 +64,8 @@ public:
 	BoolParameter* logIncomingMidi;
 	BoolParameter* forceNoteOffOnEnabled;
 
-	MidiMessageCollector midiCollector;
+	MidiMessageCollector midiCollector; //internal and long messages
+	MIDIInputQueue midiInputQueue; //messages from the interfaces, with their time
 	HashMap<int, int> sustainedNotes; //keep track of sustain
 
 	BoolParameter* isNodePlaying;
@@ -72,13 +73,38 @@ public:
 	IntParameter* numAudioOutputs; //if userCanSetIO
 	std::unique_ptr<VolumeControl> outControl;
 
+	ControllableContainer profilerCC;
+	FloatParameter* processTimeMin;
+	FloatParameter* processTimeAvg;
+	FloatParameter* processTimeP99;
+	FloatParameter* cpuShare;
+	ProcessTimeProfiler profiler;
+
 	ControllableContainer viewCC;
 	BoolParameter* showOutControl;
+	BoolParameter* showCPUShare;
 
 	MIDIInterface* midiInterface;
 
 	const int anticlickBlocks = 10; //number of blocks to do the transition
 	int bypassAntiClickCount; //anti-click on processBlock
+
+	ScratchBufferPool scratchBuffers; //temporary buffers for processBlock, sized in prepareToPlay / updatePlayConfig so the audio thread never allocates
+
+	AudioCommandQueue commandQueue; //control changes from other threads, applied at the start of processBlock
+	HeapBlock<AudioCommand> pendingCommands; //audio thread, popped commands waiting for their timestamp, sorted by time
+	int numPendingCommands;
+
+	//Audio values : the gains the audio thread uses are not read from the parameters. Their changes are sent as commands,
+	//the audio thread keeps its own copy (VolumeControl::audioGain for the volumes registered here, the mixer matrix, the VST dry / wet...)
+	enum NodeCommandType { VOLUME_GAIN_COMMAND = -1 }; //negative types are the node's, subclasses use positive ones
+	Array<VolumeControl*> audioVolumes; //only changed with processing suspended, the command index is the position in this array
+	static thread_local bool isMirroringAudioValues; //set when copying values that were already sent to the audio thread back to the parameters, so they are not sent again
+
+#if LGML_RT_CHECKS
+	char rtCheckName[64]; //copy of the name to report from the audio thread without allocating
+	void updateRTCheckName();
+#endif
     
     bool channelMismatch;
 
@@ -87,6 +113,7 @@ public:
 
 	virtual void onContainerParameterChangedInternal(Parameter* p) override;
 	virtual void onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c) override;
+	virtual void afterLoadJSONDataInternal() override;
 
 	virtual void setAudioInputs(const int& numInputs, bool updateConfig = true); //auto naming
 	virtual void setAudioInputs(const StringArray& inputNames, bool updateConfig = true);
@@ -118,6 +145,21 @@ public:
 	virtual void updatePlayConfig(bool notify = true);
 	virtual void updatePlayConfigInternal();
 
+	void updateProfilerStats(); //message thread, called regularly by the NodeManager
+
+	//Commands, to change audio state from any thread without locking the audio thread
+	bool sendAudioCommand(int type, int index = 0, float value = 0, int64 timestamp = -1);
+	void processAudioCommands(int numSamples);
+	void applyAudioCommand(const AudioCommand& command, int sampleOffset);
+	//audio thread, sampleOffset is the position of the command in the current block.
+	//Nodes that only change their state per block (gains, sampler keyboard, looper states) apply it at the start of the block
+	virtual void handleAudioCommand(const AudioCommand& command, int sampleOffset) {}
+
+	void registerAudioVolume(VolumeControl* vc); //with processing suspended
+	void unregisterAudioVolume(VolumeControl* vc); //with processing suspended
+	virtual bool getAudioValueCommand(Parameter* p, float value, AudioCommand& command); //false if the audio thread doesn't use p, value is not necessarily p's current value
+	virtual void syncAudioValues(); //with processing suspended, copies all the audio values from the parameters
+
 	//MIDI
 	//virtual void receiveMIDIFromInput(Node* n, MidiBuffer& inputBuffer);
 	virtual void midiMessageReceived(MIDIInterface* i, const MidiMessage& m) override;
@@ -180,14 +222,14 @@ public:
 		~Suspender();
 	};
 
-	virtual const String getName() const override { return node->getTypeString(); }
-	virtual void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override { node->prepareToPlay(sampleRate, maximumExpectedSamplesPerBlock); }
+	virtual const String getName() const override { return node != nullptr ? node->getTypeString() : "Removed Node"; }
+	virtual void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
 	virtual void releaseResources() override {}
-	virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override { return node->processBlock(buffer, midiMessages); }
-	virtual void processBlockBypassed(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override { return node->processBlockBypassed(buffer, midiMessages); }
+	virtual void processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override { if (node != nullptr) node->processBlock(buffer, midiMessages); else buffer.clear(); }
+	virtual void processBlockBypassed(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override { if (node != nullptr) node->processBlockBypassed(buffer, midiMessages); else buffer.clear(); }
 	virtual double getTailLengthSeconds() const override { return 0; }
-	virtual bool acceptsMidi() const override { return node->hasMIDIInput; }
-	virtual bool producesMidi() const override { return node->hasMIDIOutput; }
+	virtual bool acceptsMidi() const override { return node != nullptr && node->hasMIDIInput; }
+	virtual bool producesMidi() const override { return node != nullptr && node->hasMIDIOutput; }
 
 	virtual void numChannelsChanged() override;
 
@@ -29,9 +29,11 @@
 #include "nodes/looper/LooperTrack.cpp"
 #include "nodes/looper/LooperNode.cpp"
 
+#include "nodes/looper/AudioLooperStream.cpp"
 #include "nodes/looper/AudioLooperTrack.cpp"
 #include "nodes/looper/AudioLooperNode.cpp"
 
+#include "nodes/looper/MIDILooperEventStore.cpp"
 #include "nodes/looper/MIDILooperTrack.cpp"
 #include "nodes/looper/MIDILooperNode.cpp"
 
@@ -44,11 +46,13 @@
 #include "nodes/router/AudioRouterNode.cpp"
 #include "nodes/router/ui/AudioRouterNodeUI.cpp"
 
+#include "nodes/sampler/SamplerBankLoader.cpp"
 #include "nodes/sampler/SamplerNode.cpp"
 #include "nodes/sampler/ui/SamplerNodeUI.cpp"
 
 #include "nodes/spat/SpatItem.cpp"
 #include "nodes/spat/SpatNode.cpp"
+#include "nodes/spat/SpatPanning.cpp"
 
 
 #include "nodes/spat/ui/SpatItemUI.cpp"
@@ -48,9 +48,11 @@
 #include "nodes/looper/LooperTrack.h"
 #include "nodes/looper/LooperNode.h"
 
+#include "nodes/looper/AudioLooperStream.h"
 #include "nodes/looper/AudioLooperTrack.h"
 #include "nodes/looper/AudioLooperNode.h"
 
+#include "nodes/looper/MIDILooperEventStore.h"
 #include "nodes/looper/MIDILooperTrack.h"
 #include "nodes/looper/MIDILooperNode.h"
 
@@ -58,9 +60,11 @@
 #include "nodes/mixer/MixerNode.h"
 #include "nodes/router/AudioRouterNode.h"
 
+#include "nodes/sampler/SamplerBankLoader.h"
 #include "nodes/sampler/SamplerNode.h"
 
 #include "nodes/spat/SpatItem.h"
+#include "nodes/spat/SpatPanning.h"
 #include "nodes/spat/SpatNode.h"
 
 
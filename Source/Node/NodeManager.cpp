@@ -31,6 +31,11 @@ NodeManager::NodeManager(AudioProcessorGraph* graph,
 	isPlaying->setControllableFeedbackOnly(true);
 	isPlaying->hideInEditor = true;
 
+	cpuUsage = addFloatParameter("DSP Usage", "Sum of the CPU shares of all the nodes in this manager, in percentage of the audio block duration", 0, 0, 100);
+	cpuUsage->setControllableFeedbackOnly(true);
+	cpuUsage->hideInRemoteControl = true;
+	cpuUsage->defaultHideInRemoteControl = true;
+
 	playAllLoopers = looperControlCC.addTrigger("Play All Loopers", "This will play all loopers");
 	stopAllLoopers = looperControlCC.addTrigger("Stop All Loopers", "This will stop all loopers");
 	clearAllLoopers = looperControlCC.addTrigger("Clear All Loopers", "This will clear all loopers");
@@ -42,11 +47,14 @@ NodeManager::NodeManager(AudioProcessorGraph* graph,
 	connectionManager->hideInRemoteControl = true;
 	connectionManager->defaultHideInRemoteControl = true;
 	addChildControllableContainer(connectionManager.get());
+
+	startTimer(200);
 }
 
 
 NodeManager::~NodeManager()
 {
+	stopTimer();
 }
 
 
@@ -231,6 +239,18 @@ bool NodeManager::hasPlayingNodes()
 	return false;
 }
 
+void NodeManager::timerCallback()
+{
+	float totalShare = 0;
+	for (auto& n : items)
+	{
+		n->updateProfilerStats();
+		totalShare += n->cpuShare->floatValue(); //bypassed nodes still process, so they count too
+	}
+
+	cpuUsage->setValue(totalShare);
+}
+
 var NodeManager::getJSONData()
 {
 	var data = BaseManager::getJSONData();
@@ -19,7 +19,8 @@ class MIDIInputNode;
 class MIDIOutputNode;
 
 class NodeManager :
-	public BaseManager<Node>
+	public BaseManager<Node>,
+	public Timer
 {
 public:
 	NodeManager(AudioProcessorGraph* graph,
@@ -76,6 +77,8 @@ public:
 
 	bool hasPlayingNodes();
 
+	void timerCallback() override; //profiler stats
+
 	var getJSONData() override;
 	void loadJSONDataManagerInternal(var data) override;
 };
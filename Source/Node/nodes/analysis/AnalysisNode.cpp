@@ -11,7 +11,7 @@
 #include "AnalysisNode.h"
 
 AnalysisNode::AnalysisNode(var params) :
-	Node(getTypeString(), params, true, false, false, false),
+	Node(getTypeString(), params, true, false, true, false),
 	noteCC("Note")
 {
 	saveAndLoadRecursiveData = true;
@@ -19,6 +19,12 @@ AnalysisNode::AnalysisNode(var params) :
 	activityThreshold = addFloatParameter("Activity Threshold", "Threshold to consider activity from the source.\nAnalysis will compute only if volume is greater than this parameter", .1f, 0, 1);
 	pitchDetectionMethod = addEnumParameter("Pitch Detection Method", "Choose how to detect the pitch.\nNone will disable the detection (for performance),\nMPM is better suited for monophonic sounds,\nYIN is better suited for high-pitched voices and music");
 	pitchDetectionMethod->addOption("None", NONE)->addOption("MPM", MPM)->addOption("YIN", YIN);
+	pitchWindowSize = addEnumParameter("Pitch Window", "Number of samples analyzed for each pitch estimation, independent of the audio block size. The lowest detectable frequency is about 2 x samplerate / window");
+	for (int order = 9; order <= 12; order++) pitchWindowSize->addOption(String(1 << order), 1 << order);
+	pitchWindowSize->setDefaultValue("2048");
+	pitchOverlap = addEnumParameter("Pitch Overlap", "A new pitch is estimated every Pitch Window / Overlap samples. More overlap means lower latency but more CPU");
+	pitchOverlap->addOption("None", 1)->addOption("2x", 2)->addOption("4x", 4)->addOption("8x", 8);
+	pitchOverlap->setDefaultValue("4x");
 	keepLastDetectedValues = addBoolParameter("Keep Values", "Keep last detected values when no activity detected.", false);
 
 
@@ -43,56 +49,73 @@ AnalysisNode::~AnalysisNode()
 {
 }
 
-void AnalysisNode::onContainerParameterChangedInternal(Parameter* p)
+void AnalysisNode::updatePitchDetector()
 {
-	if (p == pitchDetectionMethod)
+	PitchDetectionMethod pdm = pitchDetectionMethod->getValueDataAsEnum<PitchDetectionMethod>();
+	double sampleRate = processor->getSampleRate() > 0 ? processor->getSampleRate() : 44100;
+	int windowSize = (int)pitchWindowSize->getValueData();
+	int hopSize = windowSize / jmax((int)pitchOverlap->getValueData(), 1);
+
+	//allocated here, then swapped in with the audio callback locked
+	std::unique_ptr<PitchDetector> newDetector;
+	switch (pdm)
 	{
-		PitchDetectionMethod pdm = pitchDetectionMethod->getValueDataAsEnum<PitchDetectionMethod>();
+	case NONE: break;
+	case MPM: newDetector.reset(new PitchMPM(sampleRate, windowSize, hopSize)); break;
+	case YIN: newDetector.reset(new PitchYIN(sampleRate, windowSize, hopSize)); break;
+	}
 
-		switch (pdm)
-		{
-		case NONE: pitchDetector.reset(nullptr); break;
-		case MPM: pitchDetector.reset(new PitchMPM(processor->getSampleRate(), processor->getBlockSize())); break;
-		case YIN: pitchDetector.reset(new PitchYIN(processor->getSampleRate(), processor->getBlockSize())); break;
-		}
+	{
+		const ScopedLock sl(processor->getCallbackLock());
+		pitchDetector.swap(newDetector);
+	}
+}
 
+void AnalysisNode::onContainerParameterChangedInternal(Parameter* p)
+{
+	if (p == pitchDetectionMethod || p == pitchWindowSize || p == pitchOverlap)
+	{
+		updatePitchDetector();
 	}
 }
 
+void AnalysisNode::updateAudioInputsInternal()
+{
+	analyzerManager.setNumChannels(getNumAudioInputs());
+}
+
 void AnalysisNode::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock)
 {
+	if (pitchDetector != nullptr) pitchDetector->setSampleRate(sampleRate);
 }
 
 void AnalysisNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
 	float rms = buffer.getRMSLevel(0, 0, buffer.getNumSamples());
-	if (rms > activityThreshold->floatValue())
+	bool isActive = rms > activityThreshold->floatValue();
+
+	//the detector always gets the signal so its window stays continuous, estimations only come every hop
+	bool hasNewPitch = pitchDetector != nullptr && pitchDetector->process(buffer.getReadPointer(0), buffer.getNumSamples());
+	float freq = hasNewPitch ? pitchDetector->getFrequency() : 0;
+
+	if (isActive && freq > 0)
 	{
-		if (pitchDetector != nullptr)
-		{
-			if ((int)pitchDetector->getBufferSize() != buffer.getNumSamples()) pitchDetector->setBufferSize(buffer.getNumSamples());
-
-			float freq = pitchDetector->getPitch(buffer.getReadPointer(0));
-			frequency->setValue(freq);
-			int pitchNote = getNoteForFrequency(freq);
-			pitch->setValue(pitchNote);
-
-			note->setValueWithKey(MIDIManager::getNoteName(pitchNote, false));
-			octave->setValue(floor(pitchNote / 12.0));
-		}
+		frequency->setValue(freq);
+		int pitchNote = getNoteForFrequency(freq);
+		pitch->setValue(pitchNote);
+
+		note->setValueWithKey(MIDIManager::getNoteName(pitchNote, false));
+		octave->setValue(floor(pitchNote / 12.0));
 	}
-	else
+	else if ((!isActive || hasNewPitch) && !keepLastDetectedValues->boolValue())
 	{
-		if (!keepLastDetectedValues->boolValue())
-		{
-			frequency->setValue(0);
-			pitch->setValue(0);
-			note->setValueWithKey("-");
-		}
+		frequency->setValue(0);
+		pitch->setValue(0);
+		note->setValueWithKey("-");
 	}
 
 	//Analysis
-	analyzerManager.process(buffer.getReadPointer(0), buffer.getNumSamples());
+	analyzerManager.process(buffer, getNumAudioInputs());
 }
 
 int AnalysisNode::getNoteForFrequency(float freq)
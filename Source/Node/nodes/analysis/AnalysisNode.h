@@ -20,6 +20,8 @@ public:
 	FloatParameter* activityThreshold;
 	enum PitchDetectionMethod { NONE, MPM, YIN };
 	EnumParameter* pitchDetectionMethod;
+	EnumParameter* pitchWindowSize;
+	EnumParameter* pitchOverlap;
 	BoolParameter* keepLastDetectedValues;
 
 	//Values
@@ -33,8 +35,10 @@ public:
 
 	std::unique_ptr<PitchDetector> pitchDetector;
 
+	void updatePitchDetector();
 	void onContainerParameterChangedInternal(Parameter* p) override;
 
+	void updateAudioInputsInternal() override;
 
 	void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
 	void processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
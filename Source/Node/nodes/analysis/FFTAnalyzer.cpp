@@ -28,36 +28,6 @@ FFTAnalyzer::~FFTAnalyzer()
 }
 
 
-void FFTAnalyzer::process(float* fftSamples, int numSamples)
-{
-	if (!enabled->boolValue()) return;
-
-	float result = 0;
-	float targetPos = position->floatValue();
-	float maxDist = size->floatValue() / 2;
-
-	int numGoodSamples = 0;
-	float totalCoef = 0;
-	for (int i = 0; i < numSamples; ++i)
-	{
-		float pos = i * 1.0f / numSamples;
-		float dist = jmin<float>(fabsf(targetPos - pos) / maxDist, 1);
-		if (dist >= 1) continue;
-
-		numGoodSamples++;
-		float factor = cosf(dist * float_Pi / 2); //smooth
-
-		result += fftSamples[i] * factor;
-		totalCoef += factor;
-	}
-
-	if (totalCoef > 0)
-	{
-		result /= totalCoef;
-		value->setValue(result);
-	}
-}
-
 void FFTAnalyzer::onContainerNiceNameChanged()
 {
 	BaseItem::onContainerNiceNameChanged();
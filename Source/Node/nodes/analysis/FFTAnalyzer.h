@@ -23,8 +23,6 @@ public:
 	FloatParameter* value;
 	ColorParameter* color;
 
-	void process(float* fftSamples, int numSamples);
-
 	void onContainerNiceNameChanged() override;
 
 	InspectableEditor* getEditorInternal(bool isRoot, Array<Inspectable*> inspectables = {}) override;
@@ -10,8 +10,11 @@
 
 FFTAnalyzerManager::FFTAnalyzerManager() :
 	BaseManager("FFT Analysis"),
-	forwardFFT(fftOrder),
-	window(fftSize, dsp::WindowingFunction<float>::hann)
+	fftSize(0),
+	hopSize(0),
+	fifoWritePos(0),
+	samplesSinceFrame(0),
+	hasNewResults(false)
 {
 	setCanBeDisabled(true);
 	enabled->setValue(false);
@@ -21,57 +24,251 @@ FFTAnalyzerManager::FFTAnalyzerManager() :
 	minDB = addFloatParameter("Min DB", "", -100, -100, 20);
 	maxDB = addFloatParameter("Max DB", "", 0, -100, 20);
 
+	fftSizeParam = addEnumParameter("FFT Size", "Number of samples analyzed in each frame. Bigger sizes are more precise in the low frequencies but react slower");
+	for (int order = 9; order <= 13; order++) fftSizeParam->addOption(String(1 << order), order);
+	fftSizeParam->setDefaultValue("2048");
+
+	overlap = addEnumParameter("Overlap", "How many frames overlap, a new frame is analyzed every FFT Size / Overlap samples. More overlap means lower latency but more CPU");
+	overlap->addOption("None", 1)->addOption("2x", 2)->addOption("4x", 4)->addOption("8x", 8);
+	overlap->setDefaultValue("4x");
+
+	channelMode = addEnumParameter("Channels", "First only analyzes the first input, Mix analyzes the sum of all inputs, Average analyzes each input separately and averages the spectra");
+	channelMode->addOption("First", FIRST_CHANNEL)->addOption("Mix", MIX)->addOption("Average", AVERAGE);
+
 	selectItemWhenCreated = false;
+
+	zeromem(scopeData, sizeof(scopeData));
+	fifo.setSize(1, 0);
+	updateSTFT();
+
+	addBaseManagerListener(this);
+	startTimerHz(50);
 }
 
 FFTAnalyzerManager::~FFTAnalyzerManager()
 {
+	stopTimer();
 }
 
+void FFTAnalyzerManager::setNumChannels(int numChannels)
+{
+	if (numChannels == fifo.getNumChannels()) return;
 
+	const SpinLock::ScopedLockType lock(stftLock);
+	fifo.setSize(jmax(numChannels, 1), fftSize);
+	fifo.clear();
+}
 
-void FFTAnalyzerManager::process(const float* samples, int numSamples)
+void FFTAnalyzerManager::updateSTFT()
 {
-	if (!enabled->boolValue()) return;
+	int order = (int)fftSizeParam->getValueData();
+	int newSize = 1 << order;
+	int newHop = jmax(newSize / jmax((int)overlap->getValueData(), 1), 1);
+
+	const SpinLock::ScopedLockType lock(stftLock);
+
+	hopSize = newHop;
+	samplesSinceFrame = 0;
+	if (newSize == fftSize && forwardFFT != nullptr) return;
 
-	for (auto i = 0; i < numSamples; ++i) pushNextSampleIntoFifo(samples[i]);
-	window.multiplyWithWindowingTable(fftData, fftSize);      // [1]
+	fftSize = newSize;
+	forwardFFT.reset(new dsp::FFT(order));
 
+	window.allocate(fftSize, true);
+	dsp::WindowingFunction<float>::fillWindowingTables(window, fftSize, dsp::WindowingFunction<float>::hann, false);
 
-	if (nextFFTBlockReady)
+	fifo.setSize(fifo.getNumChannels(), fftSize);
+	fifo.clear();
+	fifoWritePos = 0;
+
+	frame.allocate(fftSize * 2, true); //the transform needs twice the size to work in place
+	power.allocate(fftSize / 2 + 1, true);
+
+	//scope points are skewed towards the low frequencies
+	scopeBins.clearQuick();
+	for (int i = 0; i <= scopeSize; i++)
 	{
-		forwardFFT.performFrequencyOnlyForwardTransform(fftData);
+		float skewedProportionX = 1.0f - std::exp(std::log(1.0f - i / (float)scopeSize) * 0.2f);
+		scopeBins.add(jlimit(0, fftSize / 2, (int)(skewedProportionX * fftSize / 2)));
+	}
+}
 
-		auto mindB = minDB->floatValue();
-		auto maxdB = jmax<float>(maxDB->floatValue(), mindB);
+void FFTAnalyzerManager::updateBands()
+{
+	Array<Band> newBands;
 
-		for (int i = 0; i < scopeSize; ++i)                        // [3]
+	for (auto& a : items)
+	{
+		Band b;
+		b.analyzer = a;
+		b.startIndex = -1;
+
+		float targetPos = a->position->floatValue();
+		float maxDist = a->size->floatValue() / 2;
+		float totalCoef = 0;
+
+		for (int i = 0; i < scopeSize && maxDist > 0; ++i)
 		{
-			auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - i / (float)scopeSize) * 0.2f);
-			auto fftDataIndex = jlimit(0, fftSize / 2, (int)(skewedProportionX * fftSize / 2));
-			auto level = jmap(jlimit(mindB, maxdB, Decibels::gainToDecibels(fftData[fftDataIndex]) - Decibels::gainToDecibels((float)fftSize)), mindB, maxdB, 0.0f, 1.0f);
-			scopeData[i] = level;                                  // [4]
-		}
+			float pos = i * 1.0f / scopeSize;
+			float dist = jmin<float>(fabsf(targetPos - pos) / maxDist, 1);
+			if (dist >= 1) continue;
 
-		for (auto& i : items) i->process(scopeData, scopeSize);
+			if (b.startIndex == -1) b.startIndex = i;
+			while (b.startIndex + b.weights.size() < i) b.weights.add(0);
 
-		nextFFTBlockReady = false;
+			float factor = cosf(dist * float_Pi / 2); //smooth
+			b.weights.add(factor);
+			totalCoef += factor;
+		}
+
+		if (totalCoef <= 0) continue;
+		for (auto& w : b.weights) w /= totalCoef;
+		newBands.add(b);
 	}
+
+	const SpinLock::ScopedLockType lock(stftLock);
+	bands.swapWith(newBands);
 }
 
-void FFTAnalyzerManager::pushNextSampleIntoFifo(float sample)
+void FFTAnalyzerManager::process(const AudioBuffer<float>& buffer, int numChannels)
 {
-	if (fifoIndex == fftSize)    // [11]
+	if (!enabled->boolValue()) return;
+	if (!stftLock.tryEnter()) return; //being reconfigured
+
+	ChannelMode mode = channelMode->getValueDataAsEnum<ChannelMode>();
+	numChannels = jmin(numChannels, buffer.getNumChannels());
+	int numFifoChannels = mode == AVERAGE ? jmin(numChannels, fifo.getNumChannels()) : 1;
+	int numSamples = buffer.getNumSamples();
+
+	if (numChannels > 0 && fftSize > 0)
 	{
-		if (!nextFFTBlockReady) // [12]
+		for (int pos = 0; pos < numSamples;)
+		{
+			int n = jmin(numSamples - pos, fftSize - fifoWritePos);
+
+			if (mode == MIX)
+			{
+				float* dest = fifo.getWritePointer(0, fifoWritePos);
+				FloatVectorOperations::copy(dest, buffer.getReadPointer(0, pos), n);
+				for (int c = 1; c < numChannels; c++) FloatVectorOperations::add(dest, buffer.getReadPointer(c, pos), n);
+				if (numChannels > 1) FloatVectorOperations::multiply(dest, 1.0f / numChannels, n);
+			}
+			else
+			{
+				for (int c = 0; c < numFifoChannels; c++) FloatVectorOperations::copy(fifo.getWritePointer(c, fifoWritePos), buffer.getReadPointer(c, pos), n);
+			}
+
+			fifoWritePos = (fifoWritePos + n) % fftSize;
+			pos += n;
+		}
+
+		samplesSinceFrame += numSamples;
+		if (samplesSinceFrame >= hopSize)
 		{
-			zeromem(fftData, sizeof(fftData));
-			memcpy(fftData, fifo, sizeof(fifo));
-			nextFFTBlockReady = true;
+			//if several hops passed in this block, only the latest frame matters. The rest is kept so frames stay a hop apart
+			samplesSinceFrame %= hopSize;
+			processFrame(mode, numFifoChannels);
 		}
-		fifoIndex = 0;
 	}
-	fifo[fifoIndex++] = sample;  // [12]
+
+	stftLock.exit();
+}
+
+void FFTAnalyzerManager::processFrame(ChannelMode mode, int numChannels)
+{
+	int numBins = fftSize / 2 + 1;
+	FloatVectorOperations::clear(power, numBins);
+
+	for (int c = 0; c < numChannels; c++)
+	{
+		//unroll the ring so the frame ends with the latest sample, the window is applied once per frame
+		const float* ring = fifo.getReadPointer(c);
+		int firstPart = fftSize - fifoWritePos;
+		FloatVectorOperations::copy(frame, ring + fifoWritePos, firstPart);
+		FloatVectorOperations::copy(frame + firstPart, ring, fifoWritePos);
+		FloatVectorOperations::multiply(frame, window, fftSize);
+
+		forwardFFT->performFrequencyOnlyForwardTransform(frame);
+
+		FloatVectorOperations::multiply(frame, frame, numBins);
+		FloatVectorOperations::add(power, frame, numBins);
+	}
+
+	auto mindB = minDB->floatValue();
+	auto maxdB = jmax<float>(maxDB->floatValue(), mindB);
+	float sizeDB = Decibels::gainToDecibels((float)fftSize);
+	float channelNorm = 1.0f / jmax(numChannels, 1);
+
+	for (int i = 0; i < scopeSize; ++i)
+	{
+		//strongest bin between this scope point and the next one, so the high frequencies aren't undersampled
+		int endBin = jmax(scopeBins[i + 1], scopeBins[i] + 1);
+		float maxPower = 0;
+		for (int b = scopeBins[i]; b < endBin && b < numBins; b++) maxPower = jmax(maxPower, power[b]);
+
+		float level = std::sqrt(maxPower * channelNorm);
+		scopeData[i] = jmap(jlimit(mindB, maxdB, Decibels::gainToDecibels(level) - sizeDB), mindB, maxdB, 0.0f, 1.0f);
+	}
+
+	for (auto& b : bands)
+	{
+		float result = 0;
+		int numWeights = jmin(b.weights.size(), scopeSize - b.startIndex);
+		for (int i = 0; i < numWeights; i++) result += b.weights.getUnchecked(i) * scopeData[b.startIndex + i];
+		b.result = result;
+	}
+
+	hasNewResults = true;
+}
+
+void FFTAnalyzerManager::onContainerParameterChangedInternal(Parameter* p)
+{
+	BaseManager::onContainerParameterChangedInternal(p);
+	if (p == fftSizeParam || p == overlap) updateSTFT();
+}
+
+void FFTAnalyzerManager::onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c)
+{
+	BaseManager::onControllableFeedbackUpdateInternal(cc, c);
+
+	if (FFTAnalyzer* a = dynamic_cast<FFTAnalyzer*>(cc))
+	{
+		if (c == a->position || c == a->size) updateBands();
+	}
+}
+
+void FFTAnalyzerManager::itemAdded(FFTAnalyzer* a)
+{
+	updateBands();
+}
+
+void FFTAnalyzerManager::itemRemoved(FFTAnalyzer* a)
+{
+	updateBands();
+}
+
+void FFTAnalyzerManager::afterLoadJSONDataInternal()
+{
+	BaseManager::afterLoadJSONDataInternal();
+	updateSTFT();
+	updateBands();
+}
+
+void FFTAnalyzerManager::timerCallback()
+{
+	Array<std::pair<WeakReference<ControllableContainer>, float>> results;
+	{
+		const SpinLock::ScopedLockType lock(stftLock);
+		if (!hasNewResults) return;
+		hasNewResults = false;
+		for (auto& b : bands) results.add({ b.analyzer, b.result });
+	}
+
+	for (auto& r : results)
+	{
+		FFTAnalyzer* a = dynamic_cast<FFTAnalyzer*>(r.first.get());
+		if (a != nullptr && a->enabled->boolValue()) a->value->setValue(r.second);
+	}
 }
 
 InspectableEditor* FFTAnalyzerManager::getEditorInternal(bool isRoot, Array<Inspectable*> inspectables)
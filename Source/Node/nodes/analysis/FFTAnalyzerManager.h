@@ -11,7 +11,9 @@
 #pragma once
 
 class FFTAnalyzerManager :
-	public BaseManager<FFTAnalyzer>
+	public BaseManager<FFTAnalyzer>,
+	public BaseManager<FFTAnalyzer>::ManagerListener,
+	public Timer
 {
 public:
 	FFTAnalyzerManager();
@@ -20,26 +22,59 @@ public:
 
 	FloatParameter* minDB;
 	FloatParameter* maxDB;
+	EnumParameter* fftSizeParam;
+	EnumParameter* overlap;
 
+	enum ChannelMode { FIRST_CHANNEL, MIX, AVERAGE };
+	EnumParameter* channelMode;
 
-	//FFT
 	enum
 	{
-		fftOrder = 11,            // [1]
-		fftSize = 1 << fftOrder, // [2]
-		scopeSize = 256            // [3]
+		scopeSize = 256
 	};
 
-	dsp::FFT forwardFFT;                  // [4]
-	dsp::WindowingFunction<float> window; // [5]
-	float fifo[fftSize];                 // [6]
-	float fftData[2 * fftSize];          // [7]
-	int fifoIndex = 0;                    // [8]
-	bool nextFFTBlockReady = false;       // [9]
-	float scopeData[scopeSize];          // [10]
+	float scopeData[scopeSize];
 
-	void process(const float* samples, int numSamples);
-	void pushNextSampleIntoFifo(float sample);
+	//Streaming STFT : the input goes into a ring of fftSize samples per channel and every hopSize samples the latest frame is windowed and transformed.
+	//Everything below is (re)allocated on the message thread under stftLock, the audio thread only try-locks it and skips the analysis while it's being changed.
+	SpinLock stftLock;
+	int fftSize;
+	int hopSize;
+	std::unique_ptr<dsp::FFT> forwardFFT;
+	HeapBlock<float> window;
+	AudioBuffer<float> fifo;
+	int fifoWritePos;
+	int samplesSinceFrame;
+	HeapBlock<float> frame;
+	HeapBlock<float> power;
+	Array<int> scopeBins; //first FFT bin of each scope point
+
+	//Precomputed weights of every analyzer over the scope points, so all bands are extracted in one go.
+	//The audio thread only writes the results, the analyzers' values are set from them on the message thread
+	struct Band
+	{
+		WeakReference<ControllableContainer> analyzer; //message thread only
+		int startIndex;
+		Array<float> weights;
+		float result = 0;
+	};
+	Array<Band> bands;
+	bool hasNewResults;
+
+	void setNumChannels(int numChannels);
+	void updateSTFT();
+	void updateBands();
+
+	void process(const AudioBuffer<float>& buffer, int numChannels);
+	void processFrame(ChannelMode mode, int numChannels);
+
+	void onContainerParameterChangedInternal(Parameter* p) override;
+	void onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c) override;
+	void itemAdded(FFTAnalyzer* a) override;
+	void itemRemoved(FFTAnalyzer* a) override;
+	void afterLoadJSONDataInternal() override;
+
+	void timerCallback() override;
 
 	InspectableEditor* getEditorInternal(bool isRoot, Array<Inspectable*> inspectables = {}) override;
-};
\ No newline at end of file
+};
@@ -10,13 +10,170 @@
 
 #pragma once
 
+/* Base for the pitch detectors. Samples are pushed in a ring of windowSize samples, independently of the audio block size,
+   and every hopSize samples the latest window is analyzed.
+   The correlation terms are computed with FFTs so the cost is O(N log N) instead of the O(N^2) of the time domain versions.
+   Everything is allocated in the constructor, process() doesn't touch the heap.
+*/
 class PitchDetector
 {
 public:
-	PitchDetector() {}
+	PitchDetector(double sampleRate, int windowSize, int hopSize) :
+		sampleRate(sampleRate),
+		windowSize(jmax(nextPowerOfTwo(windowSize), 64)),
+		hopSize(jlimit(1, this->windowSize, hopSize)),
+		maxLag(this->windowSize / 2),
+		writePos(0),
+		samplesSinceHop(0),
+		frequency(0)
+	{
+		int fftOrder = roundToInt(std::log2(this->windowSize)) + 1; //room for the lags without circular aliasing
+		fft.reset(new dsp::FFT(fftOrder));
+		fftSize = fft->getSize();
+
+		ring.allocate(this->windowSize, true);
+		window.allocate(this->windowSize, true);
+		fftA.allocate(fftSize * 2, true);
+		fftB.allocate(fftSize * 2, true);
+		correlation.allocate(maxLag + 1, true);
+		energy.allocate(maxLag + 1, true);
+		squareSums.allocate(this->windowSize + 1, true);
+	}
+
 	virtual ~PitchDetector() {}
 
-	virtual float getPitch(const float * samples) = 0;
-	virtual unsigned int getBufferSize() = 0;
-	virtual void setBufferSize(int value) = 0;
-};
\ No newline at end of file
+	void setSampleRate(double newSampleRate) { sampleRate = newSampleRate; }
+	int getWindowSize() const { return windowSize; }
+	int getHopSize() const { return hopSize; }
+
+	//Pushes samples, returns true if a new estimate has been computed during this call
+	bool process(const float* samples, int numSamples)
+	{
+		bool hopReached = false;
+		for (int pos = 0; pos < numSamples;)
+		{
+			int n = jmin(numSamples - pos, windowSize - writePos);
+			FloatVectorOperations::copy(ring + writePos, samples + pos, n);
+			writePos = (writePos + n) % windowSize;
+			pos += n;
+		}
+
+		samplesSinceHop += numSamples;
+		if (samplesSinceHop >= hopSize)
+		{
+			samplesSinceHop %= hopSize; //if several hops passed, only the latest window matters. The rest is kept so windows stay a hop apart
+			hopReached = true;
+
+			int firstPart = windowSize - writePos;
+			FloatVectorOperations::copy(window, ring + writePos, firstPart);
+			FloatVectorOperations::copy(window + firstPart, ring, writePos);
+
+			float period = detectPeriod();
+			frequency = period > 0 ? (float)(sampleRate / period) : 0;
+		}
+
+		return hopReached;
+	}
+
+	//Last detected frequency in Hz, 0 if no pitch was found
+	float getFrequency() const { return frequency; }
+
+protected:
+	double sampleRate;
+	int windowSize;
+	int hopSize;
+	int maxLag; //periods longer than half the window can't be detected reliably
+
+	//Period in samples of the current window, 0 or less if none
+	virtual float detectPeriod() = 0;
+
+	/* Fills correlation and energy for tau in [0, maxLag].
+	   fixedWindow = false : correlation(tau) = sum over j < windowSize - tau of x[j].x[j+tau], energy(tau) = sum of x[j]^2 + x[j+tau]^2 over the same range (MPM)
+	   fixedWindow = true : same sums but over j < windowSize / 2 for every tau (YIN)
+	*/
+	void computeCorrelation(bool fixedWindow)
+	{
+		int integrationSize = fixedWindow ? windowSize / 2 : windowSize;
+
+		squareSums[0] = 0;
+		for (int i = 0; i < windowSize; i++) squareSums[i + 1] = squareSums[i] + window[i] * window[i];
+
+		FloatVectorOperations::clear(fftA, fftSize * 2);
+		FloatVectorOperations::copy(fftA, window, integrationSize);
+		fft->performRealOnlyForwardTransform(fftA, true);
+
+		if (fixedWindow)
+		{
+			FloatVectorOperations::clear(fftB, fftSize * 2);
+			FloatVectorOperations::copy(fftB, window, windowSize);
+			fft->performRealOnlyForwardTransform(fftB, true);
+
+			//conj(A) * B
+			for (int k = 0; k <= fftSize / 2; k++)
+			{
+				float ar = fftA[2 * k], ai = fftA[2 * k + 1];
+				float br = fftB[2 * k], bi = fftB[2 * k + 1];
+				fftA[2 * k] = ar * br + ai * bi;
+				fftA[2 * k + 1] = ar * bi - ai * br;
+			}
+		}
+		else
+		{
+			//|A|^2
+			for (int k = 0; k <= fftSize / 2; k++)
+			{
+				float ar = fftA[2 * k], ai = fftA[2 * k + 1];
+				fftA[2 * k] = ar * ar + ai * ai;
+				fftA[2 * k + 1] = 0;
+			}
+		}
+
+		fft->performRealOnlyInverseTransform(fftA);
+		FloatVectorOperations::copy(correlation, fftA, maxLag + 1);
+
+		for (int tau = 0; tau <= maxLag; tau++)
+		{
+			int count = fixedWindow ? integrationSize : windowSize - tau;
+			energy[tau] = squareSums[count] + squareSums[tau + count] - squareSums[tau];
+		}
+	}
+
+	static float getParabolicPeak(const float* data, int pos, int size, float* peakValue = nullptr)
+	{
+		if (pos <= 0 || pos >= size - 1)
+		{
+			if (peakValue != nullptr) *peakValue = data[pos];
+			return (float)pos;
+		}
+
+		float a = data[pos - 1], b = data[pos], c = data[pos + 1];
+		float bottom = a + c - 2 * b;
+		if (bottom == 0)
+		{
+			if (peakValue != nullptr) *peakValue = b;
+			return (float)pos;
+		}
+
+		float delta = a - c;
+		if (peakValue != nullptr) *peakValue = b - delta * delta / (8 * bottom);
+		return pos + delta / (2 * bottom);
+	}
+
+	HeapBlock<float> window;
+	HeapBlock<float> correlation;
+	HeapBlock<float> energy;
+
+private:
+	std::unique_ptr<dsp::FFT> fft;
+	int fftSize;
+
+	HeapBlock<float> ring;
+	HeapBlock<float> fftA;
+	HeapBlock<float> fftB;
+	HeapBlock<float> squareSums;
+	int writePos;
+	int samplesSinceHop;
+	float frequency;
+
+	JUCE_DECLARE_NON_COPYABLE(PitchDetector)
+};
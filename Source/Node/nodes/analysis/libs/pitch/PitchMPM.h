@@ -1,6 +1,7 @@
 
 /*
  *  Adapted for JUCE from the McLeod Pitch Method implementation in https://github.com/sevagh/pitch-detection
+ *  The NSDF is computed from an FFT autocorrelation instead of the time domain double loop
  */
 
 #pragma once
@@ -19,36 +20,30 @@ class PitchMPM :
 	 
 public:
 
-    PitchMPM(int bufferSize) : bufferSize (bufferSize), sampleRate (44100), turningPointX(0), turningPointY(0)
+    PitchMPM(double sampleRate, int windowSize, int hopSize) :
+        PitchDetector(sampleRate, windowSize, hopSize),
+        turningPointX(0),
+        turningPointY(0)
     {
+        bufferSize = maxLag;
         nsdf.insertMultiple(0, 0.0, bufferSize);
+        maxPositions.ensureStorageAllocated(bufferSize);
+        periodEstimates.ensureStorageAllocated(bufferSize);
+        ampEstimates.ensureStorageAllocated(bufferSize);
     }
     
-    PitchMPM(int sampleRate, int bufferSize) : bufferSize (bufferSize), sampleRate (sampleRate), turningPointX(0), turningPointY(0)
-    {
-        nsdf.insertMultiple(0, 0.0, bufferSize); // DRY!
-    }
-    
-    
     ~PitchMPM()
     {
-        nsdf.clear();
-        maxPositions.clear();
-        ampEstimates.clear();
-        periodEstimates.clear();
-        
     }
     
-	float getPitch(const float* audioBuffer) override
+protected:
+	float detectPeriod() override
     {
-        
-        float pitch;
-        
         maxPositions.clearQuick();
         periodEstimates.clearQuick();
         ampEstimates.clearQuick();
         
-        nsdfTimeDomain(audioBuffer);
+        nsdfFromCorrelation();
         
         peakPicking();
         
@@ -67,56 +62,27 @@ public:
             }
         }
         
-        if (periodEstimates.size() == 0)
-        {
-            pitch = -1;
-        }
-        else
+        if (periodEstimates.size() == 0) return -1;
+
+        float actualCutoff = CUTOFF * highestAmplitude;
+        
+        int periodIndex = 0;
+        for (int i = 0; i < ampEstimates.size(); ++i)
         {
-            float actualCutoff = CUTOFF * highestAmplitude;
-            
-            int periodIndex = 0;
-            for (int i = 0; i < ampEstimates.size(); ++i)
+            if (ampEstimates[i] >= actualCutoff)
             {
-                if (ampEstimates[i] >= actualCutoff)
-                {
-                    periodIndex = i;
-                    break;
-                }
-            }
-            
-            float period = periodEstimates[periodIndex];
-            float pitchEstimate = (sampleRate / period);
-            if (pitchEstimate > LOWER_PITCH_CUTOFF)
-            {
-                pitch = pitchEstimate;
-            }
-            else
-            {
-                pitch = -1;
+                periodIndex = i;
+                break;
             }
         }
-        return pitch;
-    }
-    
-    void setSampleRate (int newSampleRate)
-    {
-        sampleRate = newSampleRate;
+        
+        float period = periodEstimates[periodIndex];
+        if (sampleRate / period <= LOWER_PITCH_CUTOFF) return -1;
+        return period;
     }
 
-	unsigned int getBufferSize() override
-	{
-		return bufferSize;
-	}
-
-	void setBufferSize(int value) override
-	{
-		bufferSize = value;
-	}
-
 private:
-    int bufferSize;
-    float sampleRate;
+    int bufferSize; //number of lags in the NSDF
     
     float turningPointX, turningPointY;
     Array<float> nsdf;
@@ -189,17 +155,12 @@ private:
         }
     }
     
-    void nsdfTimeDomain(const float *audioBuffer)
+    void nsdfFromCorrelation()
     {
-        int tau;
-        for (tau = 0; tau < bufferSize; tau++) {
-            float acf = 0;
-            float divisorM = 0;
-            for (int i = 0; i < bufferSize - tau; ++i) {
-                acf += audioBuffer[i] * audioBuffer[i + tau];
-                divisorM += audioBuffer[i] * audioBuffer[i] + audioBuffer[i + tau] * audioBuffer[i + tau];
-            }
-            nsdf.setUnchecked(tau, 2 * acf / divisorM);
+        computeCorrelation(false);
+        for (int tau = 0; tau < bufferSize; tau++)
+        {
+            nsdf.setUnchecked(tau, energy[tau] > 0 ? 2 * correlation[tau] / energy[tau] : 0);
         }
     }
 
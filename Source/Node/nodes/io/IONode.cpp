@@ -117,7 +117,9 @@ void IONode::updateIO()
 	//remove surplus
 	while (channelsCC.controllableContainers.size() > numChannels)
 	{
-		channelsCC.removeChildControllableContainer(channelsCC.controllableContainers[channelsCC.controllableContainers.size() - 1]);
+		ControllableContainer* cc = channelsCC.controllableContainers[channelsCC.controllableContainers.size() - 1];
+		unregisterAudioVolume((VolumeControl*)cc);
+		channelsCC.removeChildControllableContainer(cc);
 	}
 
 	//rename existing
@@ -138,6 +140,7 @@ void IONode::updateIO()
 		VolumeControl * channel = new VolumeControl(s, true);
 		channelsCC.addChildControllableContainer(channel, true);
 		if (index < channelsGhostData.size()) channel->loadJSONData(channelsGhostData[index]);
+		registerAudioVolume(channel);
 	}
 }
 
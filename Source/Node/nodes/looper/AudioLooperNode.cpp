@@ -11,11 +11,15 @@
 #include "Node/NodeIncludes.h"
 
 AudioLooperNode::AudioLooperNode(var params) :
-	LooperNode(getTypeString(), params, AUDIO)
+	LooperNode(getTypeString(), params, AUDIO),
+	stretchPool(jlimit(1, 4, SystemStats::getNumCpus() / 2))
 {
 	numChannelsPerTrack = addIntParameter("Channel Per Track", "Number of channel to use for each track", 2, 1, 8);
 	trackOutputMode = addEnumParameter("Output Mode", "How to output the channels");
 	trackOutputMode->addOption("Mixed only", MIXED_ONLY)->addOption("Tracks only", SEPARATE_ONLY)->addOption("Mixed and tracks", ALL);
+	streamToDisk = addBoolParameter("Stream To Disk", "If checked, recorded loops are kept in a temporary file instead of memory, so they can be as long as needed. Streamed loops are not time-stretched.", false);
+
+	streamThread.startThread();
 
 	setAudioInputs(numChannelsPerTrack->intValue());
 	AudioManager::getInstance()->addAudioManagerListener(this);
@@ -24,6 +28,12 @@ AudioLooperNode::AudioLooperNode(var params) :
 AudioLooperNode::~AudioLooperNode()
 {
 	AudioManager::getInstance()->removeAudioManagerListener(this);
+	for (auto& cc : tracksCC.controllableContainers) //tracks are deleted after stretchPool and streamThread
+	{
+		((AudioLooperTrack*)cc.get())->cancelStretchJob();
+		((AudioLooperTrack*)cc.get())->stream.reset();
+	}
+	streamThread.stopThread(1000);
 }
 
 void AudioLooperNode::initInternal()
@@ -128,7 +138,14 @@ void AudioLooperNode::onContainerParameterChangedInternal(Parameter* p)
 
 		updateRingBuffer();
 	}
-
+	else if (p == streamToDisk)
+	{
+		ScopedSuspender sp(processor);
+		for (auto& cc : tracksCC.controllableContainers)
+		{
+			((AudioLooperTrack*)cc.get())->setStreaming(streamToDisk->boolValue());
+		}
+	}
 }
 
 void AudioLooperNode::onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c)
@@ -162,8 +179,8 @@ void AudioLooperNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffe
 	if (fadeTimeMS->intValue() > 0) ringBuffer->writeSamples(buffer, 0, jmin(buffer.getNumSamples(), ringBuffer->bufferSize));
 	if (retroRingBuffer != nullptr) retroRingBuffer->writeSamples(buffer, 0, jmin(buffer.getNumSamples(), retroRingBuffer->bufferSize));
 
-	AudioBuffer<float> tmpBuffer;
-	tmpBuffer.makeCopyOf(buffer);
+	ScopedScratchBuffer tmpBuffer(scratchBuffers, buffer.getNumChannels(), buffer.getNumSamples(), false);
+	for (int i = 0; i < buffer.getNumChannels(); i++) tmpBuffer.buffer.copyFrom(i, 0, buffer, i, 0, buffer.getNumSamples());
 
 	if (mm == OFF || tom == SEPARATE_ONLY || (mm == RECORDING_ONLY && !oneIsRecording))
 	{
@@ -173,6 +190,6 @@ void AudioLooperNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffe
 	bool outputIfRecording = mm == RECORDING_ONLY || mm == ALWAYS;
 	for (int i = 0; i < numTracks->intValue(); i++)
 	{
-		((AudioLooperTrack*)tracksCC.controllableContainers[i].get())->processBlock(tmpBuffer, buffer, numMainChannels, outputIfRecording);
+		((AudioLooperTrack*)tracksCC.controllableContainers[i].get())->processBlock(tmpBuffer.buffer, buffer, numMainChannels, outputIfRecording);
 	}
 }
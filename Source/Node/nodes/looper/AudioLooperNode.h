@@ -25,6 +25,10 @@ public:
     enum TrackOutputMode { MIXED_ONLY, SEPARATE_ONLY, ALL };
     EnumParameter* trackOutputMode;
 
+    BoolParameter* streamToDisk;
+    ThreadPool stretchPool; //renders stretched loops in the background
+    TimeSliceThread streamThread{ "Looper Streaming Thread" }; //writes recordings to disk and reads loops ahead when streaming
+
 
     void initInternal() override;
 
@@ -0,0 +1,430 @@
+/*
+  ==============================================================================
+
+	AudioLooperStream.cpp
+	Created: 17 Oct 2026 4:12:37pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Node/NodeIncludes.h"
+
+AudioLooperStream::AudioLooperStream(int numChannels, double sampleRate, int maxBlockSize, TimeSliceThread& thread) :
+	numChannels(numChannels),
+	thread(thread),
+	state(IDLE),
+	recordFifo((int)(jmax(sampleRate, 8000.0) * 4)),
+	pushedTotal(0),
+	recordStartTotal(0),
+	numDropped(0),
+	numRecorded(0),
+	maxBlockSize(maxBlockSize),
+	windowStart(0),
+	windowEnd(0),
+	playGeneration(0),
+	windowGeneration(-1),
+	readPosition(0),
+	numMissed(0),
+	lastVirtualPosition(0),
+	drainedTotal(0),
+	currentRecordStart(0),
+	numWritten(0)
+{
+	int secondSamples = (int)jmax(sampleRate, 8000.0);
+
+	recordFifoBuffer.setSize(numChannels, recordFifo.getTotalSize());
+	headCache.setSize(numChannels, secondSamples * 2);
+	tailCache.setSize(numChannels, secondSamples * 4);
+	fadeBuffer.setSize(numChannels, secondSamples);
+	window.setSize(numChannels, secondSamples * 4);
+	ioBuffer.setSize(numChannels, ioChunkSize);
+	interleaved.allocate(ioChunkSize * numChannels, true);
+
+	File dir = File::getSpecialLocation(File::tempDirectory).getChildFile("LGML");
+	dir.createDirectory();
+	file = dir.getNonexistentChildFile("looperStream", ".raw", false);
+
+	thread.addTimeSliceClient(this);
+}
+
+AudioLooperStream::~AudioLooperStream()
+{
+	thread.removeTimeSliceClient(this);
+	outStream.reset();
+	inStream.reset();
+	file.deleteFile();
+}
+
+void AudioLooperStream::startRecording()
+{
+	numRecorded = 0;
+	numDropped = 0;
+	recordStartTotal.store(pushedTotal.load(), std::memory_order_release);
+	publishLoop(Loop());
+	state = RECORDING;
+}
+
+bool AudioLooperStream::write(const AudioBuffer<float>& input, int numSamples)
+{
+	if (state.load() != RECORDING) return false;
+
+	int numInputChannels = jmin(numChannels, input.getNumChannels());
+
+	int start1, size1, start2, size2;
+	recordFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+	if (size1 + size2 < numSamples)
+	{
+		numDropped += numSamples; //the disk can't keep up, better lose this block than shift everything after it
+		return false;
+	}
+
+	for (int i = 0; i < numInputChannels; i++)
+	{
+		if (size1 > 0) recordFifoBuffer.copyFrom(i, start1, input, i, 0, size1);
+		if (size2 > 0) recordFifoBuffer.copyFrom(i, start2, input, i, size1, size2);
+	}
+	recordFifo.finishedWrite(size1 + size2);
+	pushedTotal.store(pushedTotal.load() + numSamples, std::memory_order_release);
+
+	//caches, so the loop can be played before the streaming thread has read it back
+	int headNum = jmin(numSamples, headCache.getNumSamples() - numRecorded);
+	for (int i = 0; i < numInputChannels && headNum > 0; i++) headCache.copyFrom(i, numRecorded, input, i, 0, headNum);
+
+	int tailSize = tailCache.getNumSamples();
+	int tailStart = numRecorded % tailSize;
+	int tail1 = jmin(numSamples, tailSize - tailStart);
+	for (int i = 0; i < numInputChannels; i++)
+	{
+		tailCache.copyFrom(i, tailStart, input, i, 0, tail1);
+		if (tail1 < numSamples) tailCache.copyFrom(i, 0, input, i, tail1, numSamples - tail1);
+	}
+
+	numRecorded += numSamples;
+	return true;
+}
+
+void AudioLooperStream::finishRecording(int loopLength, int rotation, const AudioBuffer<float>* preRecBuffer, int fadeLength)
+{
+	Loop l;
+	l.length = jmax(loopLength, 0);
+	l.rotation = jlimit(0, jmax(l.length - 1, 0), rotation);
+	l.numRecorded = numRecorded;
+
+	l.fadeLength = preRecBuffer != nullptr ? jmin(fadeLength, preRecBuffer->getNumSamples(), fadeBuffer.getNumSamples(), l.length) : 0;
+	if (l.fadeLength > 0)
+	{
+		int preRecStart = preRecBuffer->getNumSamples() - l.fadeLength;
+		for (int i = 0; i < jmin(numChannels, preRecBuffer->getNumChannels()); i++) fadeBuffer.copyFrom(i, 0, *preRecBuffer, i, preRecStart, l.fadeLength);
+	}
+
+	lastVirtualPosition = 0;
+	readPosition = 0;
+	publishLoop(l);
+	state = l.length > 0 ? PLAYING : IDLE;
+}
+
+void AudioLooperStream::clear()
+{
+	state = IDLE;
+	numRecorded = 0;
+	publishLoop(Loop());
+}
+
+void AudioLooperStream::publishLoop(const Loop& newLoop)
+{
+	int generation = playGeneration.load() + 1;
+	loop = newLoop;
+	loopSlots[generation & 1] = newLoop;
+	playGeneration.store(generation, std::memory_order_release);
+}
+
+bool AudioLooperStream::getLoop(int generation, Loop& result) const
+{
+	//the slot of this generation is only written again two generations later, after the next one has been published
+	result = loopSlots[generation & 1];
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return playGeneration.load(std::memory_order_relaxed) == generation;
+}
+
+bool AudioLooperStream::read(AudioBuffer<float>& dest, int loopSample, int numSamples)
+{
+	if (state.load() != PLAYING || loop.length <= 0)
+	{
+		dest.clear(0, numSamples);
+		return false;
+	}
+
+	//virtual position : next occurence of this loop sample from where we were
+	int64 v = lastVirtualPosition - (lastVirtualPosition % loop.length) + loopSample;
+	if (v < lastVirtualPosition) v += loop.length;
+	lastVirtualPosition = v;
+	readPosition.store(v, std::memory_order_release);
+
+	int numDestChannels = jmin(numChannels, dest.getNumChannels());
+
+	if (windowGeneration.load(std::memory_order_acquire) == playGeneration.load())
+	{
+		int64 start = windowStart.load(std::memory_order_acquire);
+		int64 end = windowEnd.load(std::memory_order_acquire);
+
+		if (v >= start && v + numSamples <= end)
+		{
+			int windowSize = window.getNumSamples();
+			int readStart = (int)(v % windowSize);
+			int read1 = jmin(numSamples, windowSize - readStart);
+			for (int i = 0; i < numDestChannels; i++)
+			{
+				dest.copyFrom(i, 0, window, i, readStart, read1);
+				if (read1 < numSamples) dest.copyFrom(i, read1, window, i, 0, numSamples - read1);
+			}
+			return true;
+		}
+	}
+
+	//not prefetched yet (just after recording or after a jump), the caches may have it
+	if (readLoop(loop, dest, 0, loopSample, numSamples, nullptr, nullptr)) return true;
+
+	dest.clear(0, numSamples);
+	numMissed++;
+	return false;
+}
+
+void AudioLooperStream::readForSave(AudioBuffer<float>& dest, int loopSample, int numSamples)
+{
+	Loop l;
+	FileInputStream fs(file);
+	if (!getLoop(playGeneration.load(std::memory_order_acquire), l) || l.length <= 0 || !fs.openedOk())
+	{
+		dest.clear(0, numSamples);
+		return;
+	}
+
+	HeapBlock<float> scratch(ioChunkSize * numChannels, true);
+	readLoop(l, dest, 0, loopSample, numSamples, &fs, &scratch);
+}
+
+bool AudioLooperStream::readLoop(const Loop& l, AudioBuffer<float>& dest, int destStart, int loopSample, int numSamples, FileInputStream* stream, HeapBlock<float>* ioScratch)
+{
+	bool result = true;
+	int done = 0;
+	while (done < numSamples)
+	{
+		int s = (loopSample + done) % l.length;
+		int segmentEnd = (l.rotation > 0 && s < l.rotation) ? l.rotation : l.length;
+		int num = jmin(numSamples - done, segmentEnd - s);
+		int recordedSample = s < l.rotation ? l.length - l.rotation + s : s - l.rotation;
+
+		result &= readRecorded(l, dest, destStart + done, recordedSample, num, stream, ioScratch);
+		applyFade(l, dest, destStart + done, s, num);
+		done += num;
+	}
+
+	return result;
+}
+
+bool AudioLooperStream::readRecorded(const Loop& l, AudioBuffer<float>& dest, int destStart, int recordedSample, int numSamples, FileInputStream* stream, HeapBlock<float>* ioScratch)
+{
+	int numDestChannels = jmin(numChannels, dest.getNumChannels());
+
+	if (stream != nullptr)
+	{
+		int64 written = numWritten.load();
+		int done = 0;
+		while (done < numSamples)
+		{
+			int64 pos = recordedSample + done;
+			int num = jmin(numSamples - done, ioChunkSize);
+			int numAvailable = (int)jlimit<int64>(0, num, written - pos);
+
+			if (numAvailable > 0 && stream->setPosition(pos * numChannels * (int64)sizeof(float)))
+			{
+				const float* data = ioScratch->get();
+				int numRead = stream->read(ioScratch->get(), numAvailable * numChannels * (int)sizeof(float)) / (numChannels * (int)sizeof(float));
+				for (int i = 0; i < numDestChannels; i++)
+				{
+					float* d = dest.getWritePointer(i, destStart + done);
+					for (int j = 0; j < numRead; j++) d[j] = data[j * numChannels + i];
+				}
+				numAvailable = numRead;
+			}
+			else numAvailable = 0;
+
+			//beyond what has been recorded : silence
+			if (numAvailable < num) dest.clear(destStart + done + numAvailable, num - numAvailable);
+			done += num;
+		}
+		return true;
+	}
+
+	//caches
+	int numFromRecording = jlimit(0, numSamples, l.numRecorded - recordedSample);
+	if (numFromRecording < numSamples) dest.clear(destStart + numFromRecording, numSamples - numFromRecording);
+	if (numFromRecording == 0) return true;
+
+	int headFilled = jmin(l.numRecorded, headCache.getNumSamples());
+	int tailSize = tailCache.getNumSamples();
+	int tailFilledStart = jmax(0, l.numRecorded - tailSize);
+
+	if (recordedSample + numFromRecording <= headFilled)
+	{
+		for (int i = 0; i < numDestChannels; i++) dest.copyFrom(i, destStart, headCache, i, recordedSample, numFromRecording);
+		return true;
+	}
+
+	if (recordedSample >= tailFilledStart)
+	{
+		int tailStart = recordedSample % tailSize;
+		int tail1 = jmin(numFromRecording, tailSize - tailStart);
+		for (int i = 0; i < numDestChannels; i++)
+		{
+			dest.copyFrom(i, destStart, tailCache, i, tailStart, tail1);
+			if (tail1 < numFromRecording) dest.copyFrom(i, destStart + tail1, tailCache, i, 0, numFromRecording - tail1);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void AudioLooperStream::applyFade(const Loop& l, AudioBuffer<float>& dest, int destStart, int loopSample, int numSamples)
+{
+	//same as the in-memory track : the end of the loop fades out while the pre-recording snapshot fades in
+	int fadeStart = l.length - l.fadeLength;
+	if (l.fadeLength <= 0 || loopSample + numSamples <= fadeStart) return;
+
+	int offset = jmax(fadeStart - loopSample, 0);
+	int numDestChannels = jmin(numChannels, dest.getNumChannels());
+
+	for (int i = 0; i < numDestChannels; i++)
+	{
+		float* d = dest.getWritePointer(i, destStart);
+		const float* pre = fadeBuffer.getReadPointer(i);
+		for (int j = offset; j < numSamples; j++)
+		{
+			int k = loopSample + j - fadeStart;
+			float g = k * 1.0f / l.fadeLength;
+			d[j] = d[j] * (1 - g) + pre[k] * g;
+		}
+	}
+}
+
+void AudioLooperStream::drainRecordFifo()
+{
+	//only drain what was pushed before we look at the recording start, so nothing from a new recording ends up in the previous file
+	int64 pushed = pushedTotal.load(std::memory_order_acquire);
+	int64 recordStart = recordStartTotal.load(std::memory_order_acquire);
+
+	if (recordStart != currentRecordStart && recordStart <= pushed)
+	{
+		int numOld = (int)(recordStart - drainedTotal);
+		recordFifo.finishedRead(jmin(numOld, recordFifo.getNumReady())); //leftovers of the previous recording
+		drainedTotal = recordStart;
+
+		outStream.reset();
+		inStream.reset();
+		file.deleteFile();
+		numWritten = 0;
+		currentRecordStart = recordStart;
+	}
+
+	if (pushed <= drainedTotal) return;
+
+	if (outStream == nullptr)
+	{
+		outStream = file.createOutputStream();
+		if (outStream == nullptr) return;
+	}
+
+	while (drainedTotal < pushed)
+	{
+		int num = (int)jmin<int64>(pushed - drainedTotal, ioChunkSize);
+
+		int start1, size1, start2, size2;
+		recordFifo.prepareToRead(num, start1, size1, start2, size2);
+		num = size1 + size2;
+		if (num == 0) break;
+
+		float* data = interleaved.get();
+		for (int i = 0; i < numChannels; i++)
+		{
+			const float* s1 = recordFifoBuffer.getReadPointer(i, start1);
+			for (int j = 0; j < size1; j++) data[j * numChannels + i] = s1[j];
+			if (size2 > 0)
+			{
+				const float* s2 = recordFifoBuffer.getReadPointer(i, start2);
+				for (int j = 0; j < size2; j++) data[(size1 + j) * numChannels + i] = s2[j];
+			}
+		}
+		recordFifo.finishedRead(num);
+
+		outStream->write(data, num * numChannels * sizeof(float));
+		drainedTotal += num;
+		numWritten += num;
+	}
+
+	outStream->flush();
+}
+
+void AudioLooperStream::fillWindow()
+{
+	//one consistent copy of the loop for the whole fill, nothing to read for an empty one
+	int generation = playGeneration.load(std::memory_order_acquire);
+	Loop l;
+	if (!getLoop(generation, l) || l.length <= 0) return;
+
+	int windowSize = window.getNumSamples();
+
+	int64 position = readPosition.load(std::memory_order_acquire);
+	int64 start = windowStart.load();
+	int64 end = windowEnd.load();
+
+	if (windowGeneration.load() != generation || position < start || position > end)
+	{
+		//restart from the play position, end first so the audio thread never sees old samples as valid
+		windowEnd.store(position, std::memory_order_release);
+		windowStart.store(position, std::memory_order_release);
+		windowGeneration.store(generation, std::memory_order_release);
+		start = end = position;
+	}
+	else if (position > start)
+	{
+		windowStart.store(position, std::memory_order_release);
+		start = position;
+	}
+
+	if (inStream == nullptr)
+	{
+		inStream = file.createInputStream();
+		if (inStream == nullptr) return;
+	}
+
+	//keep a margin so the part being written is never the part being read
+	int64 target = position + windowSize - maxBlockSize * 2;
+
+	while (end < target)
+	{
+		if (playGeneration.load() != generation || thread.threadShouldExit()) return;
+
+		int num = (int)jmin<int64>(target - end, ioChunkSize);
+		readLoop(l, ioBuffer, 0, (int)(end % l.length), num, inStream.get(), &interleaved);
+
+		int writeStart = (int)(end % windowSize);
+		int write1 = jmin(num, windowSize - writeStart);
+		for (int i = 0; i < numChannels; i++)
+		{
+			window.copyFrom(i, writeStart, ioBuffer, i, 0, write1);
+			if (write1 < num) window.copyFrom(i, 0, ioBuffer, i, write1, num - write1);
+		}
+
+		end += num;
+		windowEnd.store(end, std::memory_order_release);
+	}
+}
+
+int AudioLooperStream::useTimeSlice()
+{
+	drainRecordFifo();
+	if (state.load() == PLAYING) fillWindow();
+	return state.load() == IDLE ? 50 : 2;
+}
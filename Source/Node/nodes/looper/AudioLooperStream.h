@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+	AudioLooperStream.h
+	Created: 17 Oct 2026 4:12:37pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Disk storage for an audio looper track, so a loop can be as long as needed without keeping it all in memory.
+
+   Recording : the audio thread pushes the input into a lock-free fifo, and the looper's streaming thread writes it to a temporary file.
+   Playing : the streaming thread reads the loop ahead of the play position into a circular window, and the audio thread copies from it.
+   The first and last seconds of the recording are also kept in memory, so the loop can start playing right after recording,
+   before the window has been filled.
+
+   Positions in the window are "virtual" : they keep increasing when the loop wraps, so the window doesn't have to know about loop boundaries.
+   The loop's geometry is published with its generation : the audio thread fills the slot of the next generation before publishing it,
+   and the streaming thread copies the slot once and checks the generation didn't move while it was copying.
+   Only the audio thread and the streaming thread touch this, the rest of the looper talks to it through the track on the audio thread.
+*/
+class AudioLooperStream :
+	public TimeSliceClient
+{
+public:
+	AudioLooperStream(int numChannels, double sampleRate, int maxBlockSize, TimeSliceThread& thread);
+	~AudioLooperStream();
+
+	enum State { IDLE, RECORDING, PLAYING };
+
+	int numChannels;
+	TimeSliceThread& thread;
+	File file;
+	std::atomic<int> state;
+
+	//Record (audio thread -> disk)
+	AbstractFifo recordFifo;
+	AudioBuffer<float> recordFifoBuffer;
+	std::atomic<int64> pushedTotal; //samples ever pushed in the fifo
+	std::atomic<int64> recordStartTotal; //value of pushedTotal when the current recording started
+	std::atomic<int> numDropped; //samples the writer couldn't keep up with
+	int numRecorded; //audio thread
+
+	AudioBuffer<float> headCache; //first seconds of the recording
+	AudioBuffer<float> tailCache; //last seconds of the recording, circular
+
+	//Loop, set in finishRecording
+	struct Loop
+	{
+		int length = 0;
+		int rotation = 0; //the loop starts at recorded sample (length - rotation), to align free recordings to the bar
+		int fadeLength = 0;
+		int numRecorded = 0;
+	};
+
+	Loop loop; //audio thread
+	Loop loopSlots[2]; //by generation parity, written before the generation is published
+	AudioBuffer<float> fadeBuffer; //pre-recording snapshot, crossfaded at the end of the loop
+
+	//Play (disk -> audio thread)
+	AudioBuffer<float> window;
+	int maxBlockSize;
+	std::atomic<int64> windowStart;
+	std::atomic<int64> windowEnd;
+	std::atomic<int> playGeneration; //incremented for each new loop
+	std::atomic<int> windowGeneration; //loop the window has been filled for
+	std::atomic<int64> readPosition; //virtual position, published by the audio thread
+	std::atomic<int> numMissed; //blocks that were not there in time
+	int64 lastVirtualPosition; //audio thread
+
+	//Streaming thread only
+	std::unique_ptr<FileOutputStream> outStream;
+	std::unique_ptr<FileInputStream> inStream;
+	int64 drainedTotal;
+	int64 currentRecordStart;
+	std::atomic<int64> numWritten; //samples in the file, also read when saving
+	AudioBuffer<float> ioBuffer;
+	HeapBlock<float> interleaved;
+
+	//audio thread
+	void startRecording();
+	bool write(const AudioBuffer<float>& input, int numSamples);
+	void finishRecording(int loopLength, int rotation, const AudioBuffer<float>* preRecBuffer, int fadeLength);
+	void clear();
+	bool read(AudioBuffer<float>& dest, int loopSample, int numSamples); //false if the samples were not available in time, dest is silent then
+
+	bool hasContent() const { return state.load() == PLAYING; }
+
+	//any thread but the audio one, to save the loop
+	void readForSave(AudioBuffer<float>& dest, int loopSample, int numSamples);
+
+	int useTimeSlice() override;
+
+private:
+	static const int ioChunkSize = 8192;
+
+	void publishLoop(const Loop& newLoop); //audio thread, starts a new generation
+	bool getLoop(int generation, Loop& result) const; //other threads, false if the generation changed while copying
+
+	//stream == nullptr reads from the caches (audio thread), and fails if they don't have it
+	bool readLoop(const Loop& l, AudioBuffer<float>& dest, int destStart, int loopSample, int numSamples, FileInputStream* stream, HeapBlock<float>* ioScratch);
+	bool readRecorded(const Loop& l, AudioBuffer<float>& dest, int destStart, int recordedSample, int numSamples, FileInputStream* stream, HeapBlock<float>* ioScratch);
+	void applyFade(const Loop& l, AudioBuffer<float>& dest, int destStart, int loopSample, int numSamples);
+
+	void drainRecordFifo();
+	void fillWindow();
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioLooperStream)
+};
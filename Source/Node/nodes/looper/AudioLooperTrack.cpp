@@ -14,15 +14,18 @@ AudioLooperTrack::AudioLooperTrack(AudioLooperNode* looper, int index, int numCh
 	LooperTrack(looper, index),
 	audioLooper(looper),
 	numChannels(numChannels),
-	rtStretchBuffer(numChannels, Transport::getInstance()->blockSize),
+	streamReadBuffer(numChannels, Transport::getInstance()->blockSize),
 	antiClickFadeBeforeClear(true), //needs that otherwise first clear doesn't work
 	antiClickFadeBeforeStop(false),
-	antiClickFadeBeforePause(false)
+	antiClickFadeBeforePause(false),
+	isStreamed(false)
 {
+	if (looper->streamToDisk->boolValue()) setStreaming(true);
 }
 
 AudioLooperTrack::~AudioLooperTrack()
 {
+	if (stretchJob != nullptr) cancelStretchJob();
 }
 
 
@@ -32,6 +35,15 @@ void AudioLooperTrack::setNumChannels(int num)
 	numChannels = num;
 	updateBufferSize(buffer.getNumSamples());
 	clearBuffer();
+	if (stream != nullptr) setStreaming(true);
+}
+
+void AudioLooperTrack::setStreaming(bool value)
+{
+	if (isStreamed) clearBuffer(); //the loop is in the stream that is replaced
+
+	if (value) stream.reset(new AudioLooperStream(numChannels, AudioManager::getInstance()->currentSampleRate, Transport::getInstance()->blockSize, audioLooper->streamThread));
+	else stream.reset();
 }
 
 void AudioLooperTrack::updateBufferSize(int newSize)
@@ -43,29 +55,38 @@ void AudioLooperTrack::updateStretch(bool force)
 {
 	LooperTrack::updateStretch(force);
 
-	if (bpmAtRecord == 0 || (!isPlaying(true) && !force) || stretch == 1)
+	if (isStreamed) stretch = 1; //the stretcher needs the loop in memory
+
+	if (bpmAtRecord == 0 || stretch == 1)
 	{
+		cancelStretchJob();
 		stretchedBuffer.clear();
-		stretcher.reset();
 		return;
 	}
 
-	if (stretcher == nullptr)
+	if (!isPlaying(true) && !force) return;
+
+	//Render the whole stretched loop in the background, the original keeps playing until it's ready
+	cancelStretchJob();
+
+	StretchJob* job = new StretchJob(buffer, bufferNumSamples, looper->processor->getSampleRate(), stretch, stretchedNumSamples);
+	{
+		const ScopedLock sl(looper->processor->getCallbackLock());
+		stretchJob.reset(job);
+	}
+
+	audioLooper->stretchPool.addJob(job, false);
+}
+
+void AudioLooperTrack::cancelStretchJob()
+{
+	std::unique_ptr<StretchJob> job;
 	{
-		stretcher.reset(new RubberBand::RubberBandStretcher(looper->processor->getSampleRate(), numChannels,
-			RubberBand::RubberBandStretcher::OptionProcessRealTime
-			| RubberBand::RubberBandStretcher::OptionStretchPrecise
-			| RubberBand::RubberBandStretcher::OptionFormantPreserved
-			| RubberBand::RubberBandStretcher::OptionWindowStandard
-			| RubberBand::RubberBandStretcher::OptionTransientsCrisp
-			| RubberBand::RubberBandStretcher::OptionChannelsTogether
-		));
-		stretcher->setMaxProcessSize(looper->processor->getBlockSize());
+		const ScopedLock sl(looper->processor->getCallbackLock());
+		job = std::move(stretchJob);
 	}
-	else stretcher->reset();
 
-	stretcher->setTimeRatio(stretch);
-	stretchedBuffer.setSize(numChannels, stretchedNumSamples);
+	if (job != nullptr) audioLooper->stretchPool.removeJob(job.get(), true, -1); //stops between two chunks
 }
 
 void AudioLooperTrack::stopPlaying()
@@ -84,6 +105,8 @@ void AudioLooperTrack::stopPlaying()
 void AudioLooperTrack::clearBuffer(bool setIdle)
 {
 	buffer.clear();
+	if (stream != nullptr) stream->clear();
+	isStreamed = false;
 	LooperTrack::clearBuffer(setIdle);
 }
 
@@ -104,8 +127,18 @@ void AudioLooperTrack::startRecordingInternal()
 {
 	antiClickFadeBeforeClear = false;
 
-	int recNumSamples = looper->processor->getSampleRate() * 60; // 1 min rec samples
-	updateBufferSize(recNumSamples);
+	if (stream != nullptr)
+	{
+		updateBufferSize(0);
+		stream->startRecording();
+		isStreamed = true;
+	}
+	else
+	{
+		int recNumSamples = looper->processor->getSampleRate() * 60; // 1 min rec samples
+		updateBufferSize(recNumSamples);
+		isStreamed = false;
+	}
 
 	//Store a snapshot of the ring buffer that will be faded at the end of the recorded buffer
 	int fadeNumSamples = audioLooper->getFadeNumSamples();
@@ -121,6 +154,19 @@ void AudioLooperTrack::finishRecordingAndPlayInternal()
 	Transport::Quantization q = looper->getQuantization();
 	Transport::Quantization fillMode = looper->getFreeFillMode();
 
+	if (isStreamed)
+	{
+		//same alignment and fade as below, applied by the stream when reading
+		int rotation = (q == Transport::FREE && fillMode != Transport::FREE) ? freeRecStartOffset : 0;
+		bool fade = q != Transport::FREE || fillMode == Transport::FREE;
+		stream->finishRecording(bufferNumSamples, rotation, &preRecBuffer, fade ? audioLooper->getFadeNumSamples() : 0);
+		preRecBuffer.clear();
+
+		if (stream->numDropped > 0) NLOGWARNING(looper->niceName, "Disk was too slow while recording, " << (int)stream->numDropped << " samples were lost");
+		stretch = 1;
+		return;
+	}
+
 	if (isRecording(false)) updateBufferSize(bufferNumSamples); //update size of buffer, will fill with silence if buffer is larger than what has been recorded
 
 	if (freeRecStartOffset > 0 && q == Transport::FREE && fillMode != Transport::FREE) //This is made to align recorded content to bar/beat by offsetting the data with freeRecStartOffset
@@ -168,6 +214,10 @@ void AudioLooperTrack::retroRecAndPlayInternal()
 {
 	antiClickFadeBeforeClear = false; //force after rec to avoid clear the track
 
+	//retro recordings are short by nature, they stay in memory
+	if (stream != nullptr) stream->clear();
+	isStreamed = false;
+
 	updateBufferSize(bufferNumSamples); //update size of buffer, will fill with silence if buffer is larger than what has been recorded
 
 
@@ -222,7 +272,7 @@ void AudioLooperTrack::processBlock(AudioBuffer<float>& inputBuffer, AudioBuffer
 		}
 	}
 
-	if (buffer.getNumSamples() == 0)
+	if (buffer.getNumSamples() == 0 && !isStreamed)
 	{
 		return;
 	}
@@ -233,7 +283,12 @@ void AudioLooperTrack::processBlock(AudioBuffer<float>& inputBuffer, AudioBuffer
 	{
 		if (!finishRecordLock)
 		{
-			if (buffer.getNumSamples() >= curSample + blockSize)
+			if (isStreamed)
+			{
+				stream->write(inputBuffer, blockSize); //drops the block if the disk can't keep up
+				if (outputIfRecording) outputToMainTrack = true;
+			}
+			else if (buffer.getNumSamples() >= curSample + blockSize)
 			{
 				for (int i = 0; i < numChannels; i++)
 				{
@@ -275,6 +330,22 @@ void AudioLooperTrack::processBlock(AudioBuffer<float>& inputBuffer, AudioBuffer
 		}
 	}
 
+	//Switch to the stretched loop as soon as it has been rendered, the original fades out from where it was
+	int stretchGhostSample = -1;
+	if (stretch != 1 && stretchSample == -1 && stretchJob != nullptr && stretchJob->isReady.load())
+	{
+		std::swap(stretchedBuffer, stretchJob->result); //no allocation here, the previous buffer is freed with the job
+		stretchSample = -2;
+
+		if (isReallyPlaying && playQuantization != Transport::FREE)
+		{
+			stretchGhostSample = curSample;
+			int loopSample = Transport::getInstance()->getRelativeBarSamples() + loopBar->intValue() * Transport::getInstance()->getBarNumSamples();
+			curSample = Transport::getInstance()->getBlockPerfectNumSamples(loopSample);
+			if (curSample >= stretchedNumSamples) curSample = 0;
+		}
+	}
+
 	AudioBuffer<float>* targetBuffer = &buffer;
 	int totalSamples = bufferNumSamples;
 
@@ -291,7 +362,7 @@ void AudioLooperTrack::processBlock(AudioBuffer<float>& inputBuffer, AudioBuffer
 			outputBuffer.clear(trackChannel, 0, blockSize);
 		}
 
-		float vol = getGain();
+		float vol = audioGain;
 
 		if (firstPlayAfterRecord)
 		{
@@ -325,6 +396,8 @@ void AudioLooperTrack::processBlock(AudioBuffer<float>& inputBuffer, AudioBuffer
 
 
 
+		if (isStreamed) jumpGhostSample = -1; //only the current position is prefetched
+
 		if (jumpGhostSample > 0 && jumpGhostSample + blockSize < totalSamples)
 		{
 			firstPlayAfterStop = false;
@@ -348,52 +421,26 @@ void AudioLooperTrack::processBlock(AudioBuffer<float>& inputBuffer, AudioBuffer
 			jumpGhostSample = -1;
 		}
 
-
-
-		int targetSample = curSample;
-		if (stretch != 0 && stretch != 1 && stretcher != nullptr)
+		if (stretchGhostSample >= 0 && stretchGhostSample + blockSize <= bufferNumSamples)
 		{
-			if (stretchSample == -2) //use stretchedBuffer instead of calculating
+			for (int i = 0; i < numChannels; i++)
 			{
-				targetBuffer = &stretchedBuffer;
+				if (outputToMainTrack) outputBuffer.addFromWithRamp(i, 0, buffer.getReadPointer(i, stretchGhostSample), blockSize, prevGain, 0);
+				if (outputToSeparateTrack) outputBuffer.addFromWithRamp(trackChannel, 0, buffer.getReadPointer(i, stretchGhostSample), blockSize, prevGain, 0);
 			}
-			else
-			{
-				if (stretchSample == 0 && curSample == 0) //set from handleNewBeat in LooperTrack
-				{
-					DBG("Start storing stretched here " << curSample << "/" << Transport::getInstance()->getRelativeBarSamples());
-					stretcher->reset();
-				}
-
-				rtStretchBuffer.clear();
-				rtStretchBuffer.setSize(numChannels, blockSize);
-				AudioBuffer<float> tmpBuffer(buffer.getNumChannels(), blockSize);
-				auto readPointers = tmpBuffer.getArrayOfReadPointers();
 
-				while (stretcher->available() < blockSize)
-				{
-					for (int i = 0; i < numChannels; i++) tmpBuffer.copyFrom(i, 0, buffer.getReadPointer(i, curSample), blockSize);
-
-					stretcher->process(readPointers, tmpBuffer.getNumSamples(), false);
-
-					curSample += blockSize;
-					if (curSample >= buffer.getNumSamples()) curSample = 0;
-				}
-
-				stretcher->retrieve(rtStretchBuffer.getArrayOfWritePointers(), rtStretchBuffer.getNumSamples());
-
-				if (stretchSample >= 0)
-				{
-					for (int i = 0; i < numChannels; i++) stretchedBuffer.copyFrom(i, stretchSample, rtStretchBuffer, i, 0, rtStretchBuffer.getNumSamples());
+			prevGain = 0;
+		}
 
-					stretchSample += rtStretchBuffer.getNumSamples();
 
-					if (stretchSample >= stretchedNumSamples) stretchSample = -2; //if a full loop is written, set -2 to start using the stored buffer
-				}
 
-				targetBuffer = &rtStretchBuffer;
-				targetSample = 0;
-			}
+		int targetSample = curSample;
+		if (isStreamed)
+		{
+			streamReadBuffer.setSize(numChannels, blockSize, false, false, true);
+			stream->read(streamReadBuffer, curSample, blockSize);
+			targetBuffer = &streamReadBuffer;
+			targetSample = 0;
 		}
 
 		//DBG("Play here " << targetSample << ",prevGain " << prevGain << " / " << (int)antiClickFadeBeforePause);
@@ -466,6 +513,9 @@ void AudioLooperTrack::loadSampleFile(File dir)
 	auto reader = format.createReaderFor(f);
 	if (reader == nullptr) return;
 
+	if (stream != nullptr) stream->clear();
+	isStreamed = false; //loaded loops stay in memory
+
 	buffer.setSize(numChannels, reader->lengthInSamples);
 	reader->read(buffer.getArrayOfWritePointers(), numChannels, 0, reader->lengthInSamples);
 
@@ -499,7 +549,7 @@ void AudioLooperTrack::saveSampleFile(File dir)
 {
 	File f = dir.getChildFile(String(index + 1) + ".wav");
 	if (f.existsAsFile()) f.deleteFile();
-	if (buffer.getNumSamples() == 0) return;
+	if (buffer.getNumSamples() == 0 && !isStreamed) return;
 
 	WavAudioFormat format;
 	auto os = f.createOutputStream();
@@ -507,7 +557,17 @@ void AudioLooperTrack::saveSampleFile(File dir)
 	metaData.set(WavAudioFormat::riffInfoTitle, String(bpmAtRecord) + ";" + String(numBeats) + ";" + String((int)playQuantization));
 
 	auto writer = format.createWriterFor(os.get(), looper->processor->getSampleRate(), numChannels, 16, metaData, 0);
-	writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+	if (isStreamed)
+	{
+		AudioBuffer<float> tmpBuffer(numChannels, 65536);
+		for (int i = 0; i < bufferNumSamples; i += tmpBuffer.getNumSamples())
+		{
+			int num = jmin(tmpBuffer.getNumSamples(), bufferNumSamples - i);
+			stream->readForSave(tmpBuffer, i, num);
+			writer->writeFromAudioSampleBuffer(tmpBuffer, 0, num);
+		}
+	}
+	else writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
 	writer->flush();
 
 	os.release();
@@ -521,3 +581,92 @@ bool AudioLooperTrack::hasContent(bool includeRecordPhase) const
 	if (s == PLAYING && antiClickFadeBeforeClear) return false;
 	return true;
 }
+
+
+AudioLooperTrack::StretchJob::StretchJob(const AudioBuffer<float>& sourceBuffer, int numSourceSamples, double sampleRate, double ratio, int numTargetSamples) :
+	ThreadPoolJob("Looper Stretch"),
+	source(sourceBuffer.getNumChannels(), numSourceSamples),
+	result(sourceBuffer.getNumChannels(), numTargetSamples),
+	sampleRate(sampleRate),
+	ratio(ratio),
+	isReady(false)
+{
+	for (int i = 0; i < source.getNumChannels(); i++) source.copyFrom(i, 0, sourceBuffer, i, 0, numSourceSamples);
+	result.clear();
+}
+
+ThreadPoolJob::JobStatus AudioLooperTrack::StretchJob::runJob()
+{
+	const int chunkSize = 4096;
+	int numChannels = source.getNumChannels();
+	int numSourceSamples = source.getNumSamples();
+	if (numSourceSamples == 0 || numChannels == 0) return jobHasFinished;
+
+	//the end of the loop is put before and the start after, so the stretcher sees the loop boundary like any other part
+	int padding = jmin(numSourceSamples, (int)(sampleRate / 2));
+	int numInputSamples = numSourceSamples + padding * 2;
+	int numSkippedSamples = roundToInt(padding * ratio);
+	int numOutputSamples = 0;
+
+	RubberBand::RubberBandStretcher stretcher(sampleRate, numChannels,
+		RubberBand::RubberBandStretcher::OptionProcessOffline
+		| RubberBand::RubberBandStretcher::OptionStretchPrecise
+		| RubberBand::RubberBandStretcher::OptionFormantPreserved
+		| RubberBand::RubberBandStretcher::OptionWindowStandard
+		| RubberBand::RubberBandStretcher::OptionTransientsCrisp
+		| RubberBand::RubberBandStretcher::OptionChannelsTogether
+	);
+
+	stretcher.setTimeRatio(ratio);
+	stretcher.setExpectedInputDuration(numInputSamples);
+	stretcher.setMaxProcessSize(chunkSize);
+
+	AudioBuffer<float> inBuffer(numChannels, chunkSize);
+	AudioBuffer<float> outBuffer(numChannels, chunkSize);
+
+	auto retrieve = [&]()
+	{
+		int available;
+		while ((available = stretcher.available()) > 0)
+		{
+			int num = (int)stretcher.retrieve(outBuffer.getArrayOfWritePointers(), jmin(available, chunkSize));
+
+			int start = jmax(numSkippedSamples - numOutputSamples, 0);
+			int targetStart = numOutputSamples + start - numSkippedSamples;
+			int numToCopy = jmin(num - start, result.getNumSamples() - targetStart);
+			for (int i = 0; i < numChannels && numToCopy > 0; i++) result.copyFrom(i, targetStart, outBuffer, i, start, numToCopy);
+
+			numOutputSamples += num;
+		}
+	};
+
+	for (int pass = 0; pass < 2; pass++) //study, then process
+	{
+		for (int pos = 0; pos < numInputSamples; pos += chunkSize)
+		{
+			if (shouldExit()) return jobHasFinished;
+
+			int num = jmin(chunkSize, numInputSamples - pos);
+			for (int j = 0; j < num;)
+			{
+				int sourceSample = (pos + j - padding + numSourceSamples) % numSourceSamples;
+				int numContiguous = jmin(num - j, numSourceSamples - sourceSample);
+				for (int i = 0; i < numChannels; i++) inBuffer.copyFrom(i, j, source, i, sourceSample, numContiguous);
+				j += numContiguous;
+			}
+
+			bool isFinal = pos + num >= numInputSamples;
+			if (pass == 0) stretcher.study(inBuffer.getArrayOfReadPointers(), num, isFinal);
+			else
+			{
+				stretcher.process(inBuffer.getArrayOfReadPointers(), num, isFinal);
+				retrieve();
+			}
+		}
+	}
+
+	retrieve();
+
+	isReady = true;
+	return jobHasFinished;
+}
@@ -23,7 +23,7 @@ public:
 
     int numChannels;
     AudioBuffer<float> buffer;
-    AudioBuffer<float> rtStretchBuffer;
+    AudioBuffer<float> streamReadBuffer;
     AudioBuffer<float> stretchedBuffer;
     AudioBuffer<float> preRecBuffer; //a snapshot of the looper's ringbuffer just before recording. This allows for delay adjustement and nice fades for the end of the loop
     
@@ -33,12 +33,33 @@ public:
     bool recordOnNextSample;
 
 
-     std::unique_ptr<RubberBand::RubberBandStretcher> stretcher;
+    //Offline RubberBand rendering of the whole stretched loop, run on the looper's stretch pool
+    class StretchJob :
+        public ThreadPoolJob
+    {
+    public:
+        StretchJob(const AudioBuffer<float>& sourceBuffer, int numSourceSamples, double sampleRate, double ratio, int numTargetSamples);
+
+        AudioBuffer<float> source;
+        AudioBuffer<float> result;
+        double sampleRate;
+        double ratio;
+        std::atomic<bool> isReady;
+
+        JobStatus runJob() override;
+    };
+
+    std::unique_ptr<StretchJob> stretchJob; //swapped under the callback lock, the audio thread takes the result when ready
+
+    std::unique_ptr<AudioLooperStream> stream; //when the looper streams to disk
+    bool isStreamed; //current loop is in the stream, not in buffer
 
     void setNumChannels(int num);
+    void setStreaming(bool value);
     void updateBufferSize(int newSize);
 
     void updateStretch(bool force = false) override;
+    void cancelStretchJob();
 
     void stopPlaying() override;
     void clearTrack() override;
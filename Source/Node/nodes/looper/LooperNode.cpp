@@ -126,13 +126,16 @@ void LooperNode::updateLooperTracks()
 	{
 		LooperTrack* t = getTrackForIndex(tracksCC.controllableContainers.size() - 1);
 
+		unregisterAudioVolume(t);
 		tracksCC.removeChildControllableContainer(t);
 	}
 
 	Array<ControllableContainer*> tracksToAdd;
 	for (int i = tracksCC.controllableContainers.size(); i < numTracks->intValue(); i++)
 	{
-		tracksCC.addChildControllableContainer(createLooperTrack(i), true);
+		LooperTrack* t = createLooperTrack(i);
+		tracksCC.addChildControllableContainer(t, true);
+		registerAudioVolume(t);
 	}
 
 	setCurrentTrackToFirstEmpty();
@@ -361,6 +364,15 @@ void LooperNode::onControllableFeedbackUpdateInternal(ControllableContainer* cc,
 	}
 }
 
+void LooperNode::handleAudioCommand(const AudioCommand& command, int sampleOffset)
+{
+	if (command.type != TRACK_STATE_COMMAND) return;
+
+	//the looper is block quantized, the state machine runs at the start of the block
+	LooperTrack* t = getTrackForIndex(command.index);
+	if (t != nullptr && (int)t->trackState->getValueDataAsEnum<LooperTrack::TrackState>() == (int)command.value) t->stateChanged(); //skip states that have already been replaced
+}
+
 void LooperNode::bpmChanged()
 {
 	prepareToPlay(Transport::getInstance()->sampleRate, Transport::getInstance()->blockSize);
@@ -88,6 +88,8 @@ public:
 	//tmp mute
 	Array<LooperTrack*> tmpMuteTracks;
 
+	enum LooperCommandType { TRACK_STATE_COMMAND }; //index is the track, value the state it was set to
+
 	virtual void initInternal() override;
 
 	virtual void updateLooperTracks();
@@ -96,6 +98,7 @@ public:
 	virtual void setCurrentTrack(LooperTrack* t);
 
 	virtual void onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c) override;
+	virtual void handleAudioCommand(const AudioCommand& command, int sampleOffset) override;
 
 	virtual void bpmChanged() override;
 	virtual void beatChanged(bool isNewBar, bool isFirstLoopBeat) override;
@@ -424,7 +424,8 @@ void LooperTrack::onContainerParameterChanged(Parameter* p)
 {
 	if (p == trackState)
 	{
-		stateChanged();
+		//changes from the UI, mappings or OSC go through the node's queue, so the state machine only runs on the audio thread
+		if (AudioManager::isAudioThread || !looper->sendAudioCommand(LooperNode::TRACK_STATE_COMMAND, index, (float)trackState->getValueDataAsEnum<TrackState>())) stateChanged();
 	}
 	else if (p == numStretchedBeats)
 	{
@@ -466,17 +467,6 @@ void LooperTrack::handleBeatChanged(bool isNewBar, bool isFirstLoop)
 			}
 		}
 	}
-
-	if (stretch != 1 && stretchSample == -1)
-	{
-		int nBeats = numStretchedBeats->intValue() == 0 ? numBeats : numStretchedBeats->intValue();
-		int relLoopBeat = (Transport::getInstance()->getTotalBeatCount() - globalBeatAtStart) % nBeats;
-		if (relLoopBeat == 0) //here set for start storing stretched buffer
-		{
-			stretchSample = 0;
-			curSample = 0;
-		}
-	}
 }
 
 void LooperTrack::updateStretch(bool force)
@@ -532,22 +522,19 @@ void LooperTrack::processTrack(int blockSize, bool forcePlaying)
 		}
 		else //bar, beat
 		{
-			if (stretch == 1 || stretchSample == -2)
-			{
-				if (stretchSample == -2) totalSamples = stretchedNumSamples;
+			if (stretch != 1 && stretchSample == -2) totalSamples = stretchedNumSamples; //while the stretched loop is not ready, the original is played
 
-				if (!forcePlaying && !Transport::getInstance()->isCurrentlyPlaying->boolValue()) return;
+			if (!forcePlaying && !Transport::getInstance()->isCurrentlyPlaying->boolValue()) return;
 
 
-				if (curSample >= totalSamples) curSample = 0;
-				else curSample += blockSize;// / stretch;
-				jassert(curSample <= totalSamples);
+			if (curSample >= totalSamples) curSample = 0;
+			else curSample += blockSize;// / stretch;
+			jassert(curSample <= totalSamples);
 
-				if (curSample >= totalSamples)
-				{
-					curSample = 0;
-					firstPlayAfterStop = false;
-				}
+			if (curSample >= totalSamples)
+			{
+				curSample = 0;
+				firstPlayAfterStop = false;
 			}
 
 			int nBeats = numStretchedBeats->intValue() == 0 ? numBeats : numStretchedBeats->intValue();
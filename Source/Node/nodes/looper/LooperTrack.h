@@ -66,7 +66,7 @@ public:
 	//stretching
 	double stretch;
 	int stretchedNumSamples;
-	int stretchSample; //for storing one full stretched loop in real time
+	int stretchSample; //-1 : the stretched loop is not ready yet, the original plays. -2 : playing the stretched loop
 
 	virtual void stateChanged();
 
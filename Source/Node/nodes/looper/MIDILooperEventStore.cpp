@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+	MIDILooperEventStore.cpp
+	Created: 17 Oct 2026 8:41:17pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Node/NodeIncludes.h"
+
+MIDILooperEventStore::MIDILooperEventStore(int maxEvents, int maxNotes) :
+	maxEvents(maxEvents),
+	numEvents(0),
+	maxNotes(maxNotes),
+	numNotes(0),
+	numOpenNotes(0),
+	numDropped(0),
+	numPassEvents(0),
+	inPass(false),
+	playCursor(0),
+	playCursorSample(-1)
+{
+	events.malloc(maxEvents);
+	notes.malloc(maxNotes);
+	maxEndBefore.malloc(maxNotes);
+	openNotes.malloc(maxOpenNotes);
+	passEvents.malloc(maxPassEvents);
+}
+
+MIDILooperEventStore::~MIDILooperEventStore()
+{
+}
+
+void MIDILooperEventStore::clear()
+{
+	numEvents = 0;
+	numNotes = 0;
+	numOpenNotes = 0;
+	numDropped = 0;
+	numPassEvents = 0;
+	inPass = false;
+	playCursor = 0;
+	playCursorSample = -1;
+}
+
+bool MIDILooperEventStore::addEvent(const uint8* data, int size, int sample)
+{
+	if (size <= 0 || size > 3)
+	{
+		numDropped++; //sysex can't be stored without allocating
+		return false;
+	}
+
+	Event e;
+	e.sample = sample;
+	e.size = (uint8)size;
+	memcpy(e.data, data, size);
+
+	int status = data[0] & 0xf0;
+	int channel = (data[0] & 0x0f) + 1;
+	bool isNoteOn = size == 3 && status == 0x90 && data[2] > 0;
+	bool isNoteOff = size == 3 && (status == 0x80 || (status == 0x90 && data[2] == 0));
+
+	if (isNoteOff)
+	{
+		//only the note-offs of recorded notes, their room is kept
+		if (!endNote(channel, data[1], sample)) return false;
+		insertEvent(e);
+		return true;
+	}
+
+	int neededEvents = isNoteOn ? 2 : 1;
+	if (numEvents + numPassEvents + numOpenNotes + neededEvents > maxEvents || (isNoteOn && (numNotes >= maxNotes || numOpenNotes >= maxOpenNotes)))
+	{
+		numDropped++;
+		return false;
+	}
+
+	insertEvent(e);
+	if (isNoteOn) startNote(channel, data[1], sample);
+	return true;
+}
+
+void MIDILooperEventStore::closeOpenNotes(int sample)
+{
+	while (numOpenNotes > 0)
+	{
+		const Note& n = notes[openNotes[0]];
+		uint8 noteOff[3] = { (uint8)(0x80 | (n.channel - 1)), (uint8)n.noteNumber, 0 };
+		addEvent(noteOff, 3, sample); //ends the note and removes it from the open ones
+	}
+}
+
+void MIDILooperEventStore::truncate(int length)
+{
+	if (length <= 0)
+	{
+		clear();
+		return;
+	}
+
+	int lastSample = length - 1;
+
+	numEvents = findFirstEvent(length);
+	numNotes = findFirstNoteAfter(lastSample);
+	numOpenNotes = 0;
+	playCursorSample = -1;
+
+	//notes sounding over the loop end lost their note-off with the events after it, or never had one. They end on the last sample
+	int firstChanged = numNotes;
+	for (int i = numNotes - 1; i >= 0 && maxEndBefore[i] > lastSample; i--)
+	{
+		Note& n = notes[i];
+		if (n.endSample <= lastSample) continue;
+
+		n.endSample = lastSample;
+		firstChanged = i;
+
+		Event e = { lastSample, { (uint8)(0x80 | (n.channel - 1)), (uint8)n.noteNumber, 0 }, 3 };
+		insertEvent(e); //there is room, the removed note-offs and the open notes' reserve
+	}
+
+	updateMaxEnd(firstChanged);
+}
+
+void MIDILooperEventStore::beginPass()
+{
+	jassert(numOpenNotes == 0); //recordings and passes end their notes
+	inPass = true;
+}
+
+void MIDILooperEventStore::commitPass(int length)
+{
+	if (!inPass) return;
+	closeOpenNotes(jmax(length - 1, 0));
+	mergePass();
+	inPass = false;
+}
+
+void MIDILooperEventStore::mergePass()
+{
+	if (numPassEvents == 0) return;
+
+	//from the end, so it's done in place. Pass events go after the loop's events of the same sample
+	int i = numEvents - 1;
+	int j = numPassEvents - 1;
+	int k = numEvents + numPassEvents - 1;
+	while (j >= 0)
+	{
+		if (i >= 0 && events[i].sample > passEvents[j].sample) events[k--] = events[i--];
+		else events[k--] = passEvents[j--];
+	}
+
+	numEvents += numPassEvents;
+	numPassEvents = 0;
+	playCursorSample = -1; //indices moved, search again on the next block
+}
+
+void MIDILooperEventStore::renderEvents(MidiBuffer& buffer, int startSample, int numSamples)
+{
+	if (startSample != playCursorSample) playCursor = findFirstEvent(startSample); //the play position jumped
+
+	int endSample = startSample + numSamples;
+	while (playCursor < numEvents && events[playCursor].sample < endSample)
+	{
+		const Event& e = events[playCursor];
+		buffer.addEvent(e.data, e.size, e.sample - startSample);
+		playCursor++;
+	}
+
+	playCursorSample = endSample;
+}
+
+void MIDILooperEventStore::getNotesAt(int sample, Array<Note>& result) const
+{
+	for (int i = findFirstNoteAfter(sample) - 1; i >= 0 && maxEndBefore[i] >= sample; i--)
+	{
+		if (notes[i].endSample >= sample) result.add(notes[i]);
+	}
+}
+
+int MIDILooperEventStore::findFirstEvent(int sample) const
+{
+	return (int)(std::lower_bound(events.get(), events.get() + numEvents, sample, [](const Event& e, int s) { return e.sample < s; }) - events.get());
+}
+
+int MIDILooperEventStore::findFirstNoteAfter(int sample) const
+{
+	return (int)(std::upper_bound(notes.get(), notes.get() + numNotes, sample, [](int s, const Note& n) { return s < n.startSample; }) - notes.get());
+}
+
+void MIDILooperEventStore::insertEvent(const Event& e)
+{
+	if (inPass)
+	{
+		if (numPassEvents >= maxPassEvents) mergePass();
+
+		int index = (int)(std::upper_bound(passEvents.get(), passEvents.get() + numPassEvents, e.sample, [](int s, const Event& ev) { return s < ev.sample; }) - passEvents.get());
+		if (index < numPassEvents) memmove(passEvents + index + 1, passEvents + index, (numPassEvents - index) * sizeof(Event));
+		passEvents[index] = e;
+		numPassEvents++;
+		return;
+	}
+
+	jassert(numEvents < maxEvents);
+
+	//after the events of the same sample, to keep the order they came in
+	int index = (int)(std::upper_bound(events.get(), events.get() + numEvents, e.sample, [](int s, const Event& ev) { return s < ev.sample; }) - events.get());
+	if (index < numEvents) memmove(events + index + 1, events + index, (numEvents - index) * sizeof(Event));
+	events[index] = e;
+	numEvents++;
+
+	if (index < playCursor) playCursor++;
+}
+
+void MIDILooperEventStore::startNote(int channel, int noteNumber, int sample)
+{
+	int index = findFirstNoteAfter(sample);
+	if (index < numNotes) memmove(notes + index + 1, notes + index, (numNotes - index) * sizeof(Note));
+	notes[index] = { channel, noteNumber, sample, openEnd };
+	numNotes++;
+
+	for (int i = 0; i < numOpenNotes; i++) if (openNotes[i] >= index) openNotes[i]++;
+	openNotes[numOpenNotes++] = index;
+
+	updateMaxEnd(index);
+}
+
+bool MIDILooperEventStore::endNote(int channel, int noteNumber, int sample)
+{
+	//oldest held note first, if the same note was hit twice
+	for (int i = 0; i < numOpenNotes; i++)
+	{
+		Note& n = notes[openNotes[i]];
+		if (n.channel != channel || n.noteNumber != noteNumber) continue;
+
+		n.endSample = sample;
+		int index = openNotes[i];
+		for (int j = i + 1; j < numOpenNotes; j++) openNotes[j - 1] = openNotes[j];
+		numOpenNotes--;
+
+		updateMaxEnd(index);
+		return true;
+	}
+
+	return false;
+}
+
+void MIDILooperEventStore::updateMaxEnd(int fromIndex)
+{
+	for (int i = fromIndex; i < numNotes; i++) maxEndBefore[i] = i > 0 ? jmax(maxEndBefore[i - 1], notes[i].endSample) : notes[i].endSample;
+}
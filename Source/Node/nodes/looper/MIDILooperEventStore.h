@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+	MIDILooperEventStore.h
+	Created: 17 Oct 2026 8:41:17pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Recorded content of a MIDI looper track : the events sorted by sample, and the notes they make as intervals.
+
+   Everything is allocated once when the track is created, recording and playing never allocate.
+   When full, new note-ons and other events are dropped, but there is always room for the note-offs of the notes already recorded.
+
+   Overdub passes are recorded on the side and merged into the sorted events in one go at the end of the pass, so the loop
+   keeps playing what it had while a new layer is recorded over it.
+
+   Playback keeps a cursor in the event array, it only binary-searches again when the play position jumps (wrap, restart).
+   Notes are sorted by start sample with a running maximum of their end, so the notes sounding at a sample are found
+   by searching the last note started before it and walking back only while an earlier note can still be sounding.
+*/
+class MIDILooperEventStore
+{
+public:
+	MIDILooperEventStore(int maxEvents = defaultMaxEvents, int maxNotes = defaultMaxNotes);
+	~MIDILooperEventStore();
+
+	static const int defaultMaxEvents = 1 << 15;
+	static const int defaultMaxNotes = 1 << 13;
+	static const int maxPassEvents = 1 << 12; //merged earlier if a pass is longer
+	static const int maxOpenNotes = 16 * 128;
+	static const int openEnd = std::numeric_limits<int>::max(); //end of a note still held
+
+	struct Event
+	{
+		int sample;
+		uint8 data[3];
+		uint8 size;
+	};
+
+	struct Note
+	{
+		int channel;
+		int noteNumber;
+		int startSample;
+		int endSample;
+	};
+
+	SpinLock lock; //short sections only, the audio thread takes it too
+
+	void clear();
+
+	//Recording, events must be short messages
+	bool addEvent(const uint8* data, int size, int sample);
+	void closeOpenNotes(int sample); //adds a note-off for each held note
+	void truncate(int length); //drops what is after the loop end, held notes end at the last sample
+	//Overdub, events added between begin and commit are merged at commit
+	void beginPass();
+	void commitPass(int length); //held notes end on the last sample of the loop
+	bool isInPass() const { return inPass; }
+
+	int getNumOpenNotes() const { return numOpenNotes; }
+	int getNumDropped() const { return numDropped; }
+
+	//Playback, adds the events in [startSample, startSample + numSamples) to the buffer, relative to startSample
+	void renderEvents(MidiBuffer& buffer, int startSample, int numSamples);
+
+	void getNotesAt(int sample, Array<Note>& result) const; //message thread
+
+	int getNumEvents() const { return numEvents; }
+	const Event& getEvent(int index) const { return events[index]; }
+
+private:
+	HeapBlock<Event> events;
+	int maxEvents;
+	int numEvents;
+
+	HeapBlock<Note> notes;
+	HeapBlock<int> maxEndBefore; //highest end of the notes up to each index
+	int maxNotes;
+	int numNotes;
+	HeapBlock<int> openNotes; //indices of the held notes, oldest first
+	int numOpenNotes;
+	int numDropped;
+
+	HeapBlock<Event> passEvents;
+	int numPassEvents;
+	bool inPass;
+
+	int playCursor; //next event to play
+	int playCursorSample; //sample the cursor is valid for
+
+	int findFirstEvent(int sample) const; //first event at or after sample
+	int findFirstNoteAfter(int sample) const; //first note starting after sample
+	void insertEvent(const Event& e);
+	void mergePass();
+	void startNote(int channel, int noteNumber, int sample);
+	bool endNote(int channel, int noteNumber, int sample);
+	void updateMaxEnd(int fromIndex);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MIDILooperEventStore)
+};
@@ -11,12 +11,18 @@
 #include "Node/NodeIncludes.h"
 
 MIDILooperNode::MIDILooperNode(var params) :
-	LooperNode(getTypeString(), params, MIDI)
+	LooperNode(getTypeString(), params, MIDI),
+	recordQuantizeDivision(0)
 {
+	recordQuantize = recordCC.addEnumParameter("Record Quantize", "Moves the recorded notes to the closest step of this grid, on the first recording and on overdubs. Their length is kept. Not applied to free loops");
+	recordQuantize->addOption("Off", 0)->addOption("1/4", 1)->addOption("1/8", 2)->addOption("1/16", 4)->addOption("1/32", 8);
+
+	startTimerHz(10);
 }
 
 MIDILooperNode::~MIDILooperNode()
 {
+	stopTimer();
 
 }
 
@@ -31,7 +37,6 @@ void MIDILooperNode::midiMessageReceived(MIDIInterface* i, const MidiMessage& m)
 
 	if (m.isNoteOnOrOff())
 	{
-		for (auto& t : tracksCC.controllableContainers) ((MIDILooperTrack*)t.get())->handleNoteReceived(m);
 		if (m.isNoteOn()) currentNoteOns.add({ m.getChannel(), m.getNoteNumber() });
 		else if (m.isNoteOff()) currentNoteOns.removeAllInstancesOf({ m.getChannel(), m.getNoteNumber() });
 	}
@@ -41,6 +46,8 @@ void MIDILooperNode::onControllableFeedbackUpdateInternal(ControllableContainer*
 {
 	LooperNode::onControllableFeedbackUpdateInternal(cc, c);
 
+	if (c == recordQuantize) recordQuantizeDivision = (int)recordQuantize->getValueData();
+
 	if (MIDILooperTrack* mt = c->getParentAs<MIDILooperTrack>())
 	{
 		bool shouldClearNotes = c == mt->active;
@@ -55,7 +62,7 @@ void MIDILooperNode::onControllableFeedbackUpdateInternal(ControllableContainer*
 
 		if (shouldClearNotes)
 		{
-			Array<MIDILooperTrack::SampledNoteInfo> notes = mt->getNoteOnsAtSample(mt->curSample);
+			Array<MIDILooperEventStore::Note> notes = mt->getNoteOnsAtSample(mt->curSample);
 			for (auto& info : notes) cleanupCollector.addMessageToQueue(MidiMessage(MidiMessage::noteOff(info.channel, info.noteNumber), processor->getBlockSize() - 1));
 		}
 	}
@@ -66,6 +73,7 @@ void MIDILooperNode::prepareToPlay(double sampleRate, int maximumExpectedSamples
 {
 	LooperNode::prepareToPlay(sampleRate, maximumExpectedSamplesPerBlock);
 	if (sampleRate != 0) cleanupCollector.reset(sampleRate);
+	outBuffer.ensureSize(outBufferBytes);
 }
 
 void MIDILooperNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
@@ -74,7 +82,7 @@ void MIDILooperNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer
 
 	int blockSize = buffer.getNumSamples();
 
-	MidiBuffer outBuffer;
+	outBuffer.clear(); //keeps its storage
 	cleanupCollector.removeNextBlockOfMessages(outBuffer, blockSize);
 
 	for (int i = 0; i < numTracks->intValue(); i++)
@@ -92,3 +100,16 @@ void MIDILooperNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer
 
 	midiMessages.addEvents(outBuffer, 0, buffer.getNumSamples(), 0);
 }
+
+
+void MIDILooperNode::timerCallback()
+{
+	for (auto& cc : tracksCC.controllableContainers)
+	{
+		MIDILooperTrack* t = (MIDILooperTrack*)cc.get();
+		if (t == nullptr) continue;
+
+		int numDropped = t->numDroppedToLog.exchange(0);
+		if (numDropped > 0) NLOGWARNING(niceName, "Track " << t->index + 1 << " is full or received sysex, " << numDropped << " events were not recorded");
+	}
+}
@@ -11,13 +11,19 @@
 #pragma once
 
 class MIDILooperNode :
-    public LooperNode
+    public LooperNode,
+    public Timer
 {
 public:
     MIDILooperNode(var params= var());
     ~MIDILooperNode();
 
     MidiMessageCollector cleanupCollector;
+    MidiBuffer outBuffer; //tracks output, sized in prepareToPlay
+
+    EnumParameter* recordQuantize;
+    std::atomic<int> recordQuantizeDivision; //grid steps per beat, 0 to record as played
+    static const int outBufferBytes = 16384;
 
     struct NoteInfo { 
         int channel;  
@@ -36,6 +42,8 @@ public:
     void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
 
     virtual void processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
+
+    void timerCallback() override; //warnings from the tracks' recordings
     
     String getTypeString() const override { return getTypeStringStatic(); }
     static String getTypeStringStatic() { return "MIDI Looper"; }
@@ -10,9 +10,12 @@
 
 MIDILooperTrack::MIDILooperTrack(MIDILooperNode* looper, int index) :
     LooperTrack(looper, index),
-	midiLooper(looper)
+	midiLooper(looper),
+	isOverdubbing(false),
+	numDroppedToLog(0)
 {
-	
+	overdub = addBoolParameter("Overdub", "When checked while the track is playing, what comes in is layered over the loop. Each pass is merged at the end of the loop", false);
+	zeromem(noteShifts, sizeof(noteShifts));
 }
 
 MIDILooperTrack::~MIDILooperTrack()
@@ -21,76 +24,121 @@ MIDILooperTrack::~MIDILooperTrack()
 
 void MIDILooperTrack::clearBuffer(bool setIdle)
 {
-    buffer.clear();
+	{
+		const SpinLock::ScopedLockType sl(events.lock);
+		events.clear();
+	}
+
 	LooperTrack::clearBuffer(setIdle);
 }
 
 void MIDILooperTrack::startRecordingInternal()
 {
+	const SpinLock::ScopedLockType sl(events.lock);
+	events.clear();
+	isOverdubbing = false;
+	zeromem(noteShifts, sizeof(noteShifts));
 }
 
 void MIDILooperTrack::finishRecordingAndPlayInternal()
 {
-	for (auto& i : recNoteIndices) //add current noteOns from looper to noteToClean array
+	int numDropped = 0;
+
 	{
-		MidiMessage m = MidiMessage::noteOff(noteInfos[i]->channel, noteInfos[i]->noteNumber);
-		buffer.addEvent(m, curSample - 1);
+		const SpinLock::ScopedLockType sl(events.lock);
+		events.truncate(bufferNumSamples); //also ends the notes still held, at the end of the loop
+		numDropped = events.getNumDropped();
 	}
 
-	recNoteIndices.clear();
+	if (numDropped > 0) numDroppedToLog = numDropped; //may be on the audio thread, logged from the node's timer
 }
 
-void MIDILooperTrack::handleNoteReceived(const MidiMessage& m)
+Array<MIDILooperEventStore::Note> MIDILooperTrack::getNoteOnsAtSample(int sample)
 {
-	if (isRecording(false))
+	Array<MIDILooperEventStore::Note> result;
+	const SpinLock::ScopedLockType sl(events.lock);
+	events.getNotesAt(sample, result);
+	return result;
+}
+
+
+void MIDILooperTrack::recordEvents(MidiBuffer& inputBuffer, int startSample, int grid, int loopLength)
+{
+	for (const auto metadata : inputBuffer)
 	{
-		if (m.isNoteOn())
-		{
-			SampledNoteInfo * info = new SampledNoteInfo({m.getChannel(), m.getNoteNumber(), curSample, -1 });
-			noteInfos.add(info);
-			recNoteIndices.add(noteInfos.size()-1);
-		}
-		else
+		const uint8* data = metadata.data;
+		int sample = startSample + metadata.samplePosition;
+
+		if (metadata.numBytes == 3 && ((data[0] & 0xf0) == 0x90 || (data[0] & 0xf0) == 0x80))
 		{
-			for (auto& i : recNoteIndices)
+			int key = (data[0] & 0x0f) * 128 + data[1];
+			bool isNoteOn = (data[0] & 0xf0) == 0x90 && data[2] > 0;
+
+			if (isNoteOn)
 			{
-				SampledNoteInfo* info = noteInfos[i];
-				if (info->channel == m.getChannel() && info->noteNumber == m.getNoteNumber())
+				noteShifts[key] = 0;
+				if (grid > 0)
 				{
-					info->endSample = curSample;
-					recNoteIndices.removeAllInstancesOf(i);
-					break;
+					int quantized = roundToInt(sample * 1.0 / grid) * grid;
+					if (loopLength > 0 && quantized >= loopLength) quantized -= grid; //stays in this pass
+					noteShifts[key] = quantized - sample;
+					sample = quantized;
 				}
 			}
+			else
+			{
+				sample += noteShifts[key]; //keeps the length that was played
+				if (loopLength > 0) sample = jmin(sample, loopLength - 1);
+			}
 		}
-	}
-}
 
-Array<MIDILooperTrack::SampledNoteInfo> MIDILooperTrack::getNoteOnsAtSample(int sample)
-{
-	Array<SampledNoteInfo> result;
-	for (auto& n : noteInfos)
-	{
-		if (n->startSample <= sample && (n->endSample >= sample || n->endSample == -1)) result.add({ n->channel, n->noteNumber });
+		events.addEvent(data, metadata.numBytes, jmax(sample, 0));
 	}
-	return result;
 }
 
-
 void MIDILooperTrack::processBlock(MidiBuffer& inputBuffer, MidiBuffer& outputBuffer, int blockSize)
 {
+	int division = midiLooper->recordQuantizeDivision;
+	int grid = division > 0 ? Transport::getInstance()->getBeatNumSamples() / division : 0;
+
 	if (isRecording(false))
 	{
 		if (!finishRecordLock)
 		{
-			buffer.addEvents(inputBuffer, 0, blockSize, curSample);
+			const SpinLock::ScopedLockType sl(events.lock);
+			recordEvents(inputBuffer, curSample, looper->getQuantization() != Transport::FREE ? grid : 0, -1);
 		}
 	}
 	
+	int prevSample = curSample;
 	LooperTrack::processTrack(blockSize);
 
-	if (active->boolValue() && isPlaying(false))
+	bool playing = isPlaying(false);
+	bool shouldOverdub = playing && overdub->boolValue() && bufferNumSamples > 0;
+
+	const SpinLock::ScopedLockType sl(events.lock);
+
+	//a pass ends when overdub is released or the loop wraps, the next one starts right away
+	if (isOverdubbing && (!shouldOverdub || curSample < prevSample))
+	{
+		events.commitPass(bufferNumSamples);
+		isOverdubbing = false;
+	}
+
+	if (shouldOverdub)
+	{
+		if (!isOverdubbing)
+		{
+			events.beginPass();
+			zeromem(noteShifts, sizeof(noteShifts));
+			isOverdubbing = true;
+		}
+
+		recordEvents(inputBuffer, curSample, playQuantization != Transport::FREE ? grid : 0, bufferNumSamples);
+	}
+
+	if (active->boolValue() && playing)
 	{
-		outputBuffer.addEvents(buffer, curSample, blockSize, -curSample);
+		events.renderEvents(outputBuffer, curSample, blockSize);
 	}
 }
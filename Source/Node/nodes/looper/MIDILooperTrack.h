@@ -21,27 +21,20 @@ public:
 
     MIDILooperNode* midiLooper;
 
-    MidiBuffer buffer;
-   
-    //for cleaning note Ons
-    struct SampledNoteInfo
-    {
-        int channel;
-        int noteNumber;
-        int startSample;
-        int endSample;
-    };
-
-    OwnedArray<SampledNoteInfo> noteInfos;
-    Array<int> recNoteIndices; 
-
-    Array<SampledNoteInfo> getNoteOnsAtSample(int sample);
+    MIDILooperEventStore events;
+
+    BoolParameter* overdub;
+    bool isOverdubbing; //audio thread, a pass is being recorded
+    std::atomic<int> numDroppedToLog; //events lost by the last recording, logged by the node's timer
+
+    int noteShifts[16 * 128]; //quantization applied to each held note, its note-off is moved as much
+
+    Array<MIDILooperEventStore::Note> getNoteOnsAtSample(int sample); //for cleaning note ons
 
     void clearBuffer(bool setIdle = true) override;
     void startRecordingInternal() override;
     void finishRecordingAndPlayInternal() override;
 
-    void handleNoteReceived(const MidiMessage& m);
-
+    void recordEvents(MidiBuffer& inputBuffer, int startSample, int grid, int loopLength);
     void processBlock(MidiBuffer & inputBuffer, MidiBuffer & outputBuffer, int blockSize);
 };
\ No newline at end of file
@@ -11,7 +11,9 @@
 #include "Node/NodeIncludes.h"
 
 MixerNode::MixerNode(var params) :
-	Node(getTypeString(), params, true, true, true, true)
+	Node(getTypeString(), params, true, true, true, true),
+	matrixInputs(0),
+	matrixTiles(0)
 {
 	showOutputGains = viewCC.addBoolParameter("Show Outputs Gain", "Show Output Gain", true);
 	showOutputRMS = viewCC.addBoolParameter("Show Outputs RMS", "Show Output RMS", true);
@@ -41,6 +43,7 @@ void MixerNode::updateAudioInputsInternal()
 	}
 
 	reorderContainers();
+	rebuildMixMatrix();
 }
 
 void MixerNode::updateAudioOutputsInternal()
@@ -50,6 +53,7 @@ void MixerNode::updateAudioOutputsInternal()
 	while (mainOuts.size() > getNumAudioOutputs())
 	{
 		VolumeControl* vc = mainOuts[mainOuts.size() - 1];
+		unregisterAudioVolume(vc);
 		removeChildControllableContainer(vc);
 		mainOuts.removeAllInstancesOf(vc);
 	}
@@ -59,9 +63,11 @@ void MixerNode::updateAudioOutputsInternal()
 		VolumeControl* o = new VolumeControl("Out" + String(mainOuts.size() + 1));
 		addChildControllableContainer(o, true);
 		mainOuts.add(o);
+		registerAudioVolume(o);
 	}
 
 	reorderContainers();
+	rebuildMixMatrix();
 }
 
 MixerItem* MixerNode::getMixerItem(int inputIndex, int outputIndex)
@@ -80,34 +86,121 @@ void MixerNode::reorderContainers()
 	controllableContainerListeners.call(&ControllableContainerListener::controllableContainerReordered, this);
 }
 
+void MixerNode::rebuildMixMatrix()
+{
+	int newInputs = inputLines.size();
+	int newTiles = (getNumAudioOutputs() + tileSize - 1) / tileSize;
+	int stride = newTiles * tileSize;
+
+	HeapBlock<float> newCurrentGains(jmax(newInputs * stride, 1), true);
+
+	//keep the running gains of the items that are still there, so resizing doesn't jump
+	for (int i = 0; i < jmin(newInputs, matrixInputs); i++)
+	{
+		for (int o = 0; o < jmin(stride, matrixTiles * tileSize); o++) newCurrentGains[i * stride + o] = currentGains[i * matrixTiles * tileSize + o];
+	}
+
+	currentGains.swapWith(newCurrentGains);
+	targetGains.allocate(jmax(newInputs * stride, 1), true);
+	tileMasks.allocate(jmax(newInputs * newTiles, 1), true);
+	matrixInputs = newInputs;
+	matrixTiles = newTiles;
+
+	syncAudioValues();
+}
+
+void MixerNode::setMatrixGain(int inputIndex, int outputIndex, float gain)
+{
+	if (inputIndex >= matrixInputs || outputIndex >= matrixTiles * tileSize) return;
+
+	targetGains[inputIndex * matrixTiles * tileSize + outputIndex] = gain;
+
+	uint8& mask = tileMasks[inputIndex * matrixTiles + outputIndex / tileSize];
+	uint8 bit = (uint8)(1 << (outputIndex % tileSize));
+	if (gain != 0) mask |= bit;
+	else mask &= (uint8)~bit;
+}
+
+bool MixerNode::getAudioValueCommand(Parameter* p, float value, AudioCommand& command)
+{
+	if (MixerItem* mi = dynamic_cast<MixerItem*>(p->parentContainer.get()))
+	{
+		if (p != mi->gain && p != mi->active) return false;
+
+		command.type = ITEM_GAIN_COMMAND;
+		command.index = (mi->inputIndex << 16) | mi->outputIndex;
+		command.value = mi->getGainForValue(p, value);
+		return true;
+	}
+
+	return Node::getAudioValueCommand(p, value, command);
+}
+
+void MixerNode::syncAudioValues()
+{
+	Node::syncAudioValues();
+
+	for (auto& il : inputLines)
+	{
+		for (auto& mi : il->mixerItems) setMatrixGain(mi->inputIndex, mi->outputIndex, mi->getGain());
+	}
+}
+
+void MixerNode::handleAudioCommand(const AudioCommand& command, int sampleOffset)
+{
+	if (command.type == ITEM_GAIN_COMMAND) setMatrixGain(command.index >> 16, command.index & 0xffff, command.value);
+}
+
 void MixerNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
 	int numSamples = buffer.getNumSamples();
-	tmpBuffer.setSize(numAudioOutputs->intValue(), numSamples);
-	tmpBuffer.clear();
+	int numInputs = jmin(numAudioInputs->intValue(), matrixInputs, buffer.getNumChannels());
+	int numOutputs = jmin(numAudioOutputs->intValue(), mainOuts.size(), matrixTiles * tileSize);
+	if (numOutputs == 0 || numSamples == 0) return;
+
+	int stride = matrixTiles * tileSize;
 
-	for (int inputIndex = 0; inputIndex < numAudioInputs->intValue(); inputIndex++)
+	//inputs and outputs share the buffer, so everything is mixed aside before being copied back
+	ScopedScratchBuffer mix(scratchBuffers, numOutputs, numSamples, false);
+
+	for (int firstOutput = 0; firstOutput < numOutputs; firstOutput += tileSize)
 	{
-		for (int outputIndex = 0; outputIndex < numAudioOutputs->intValue(); outputIndex++)
+		int tileOutputs = jmin(tileSize, numOutputs - firstOutput);
+		uint8 validMask = (uint8)((1 << tileOutputs) - 1);
+
+		float* tile[tileSize] = {};
+		for (int k = 0; k < tileOutputs; k++)
 		{
-			MixerItem* mi = getMixerItem(inputIndex, outputIndex);
-			float newGain = mi->getGain();
-			tmpBuffer.addFromWithRamp(outputIndex, 0, buffer.getReadPointer(inputIndex), numSamples, mi->prevGain, newGain);
-			mi->prevGain = newGain;
+			tile[k] = mix.buffer.getWritePointer(firstOutput + k);
+			FloatVectorOperations::clear(tile[k], numSamples);
 		}
-	}
 
+		for (int inputIndex = 0; inputIndex < numInputs; inputIndex++)
+		{
+			int cell = inputIndex * stride + firstOutput;
+			uint8 mask = tileMasks[inputIndex * matrixTiles + firstOutput / tileSize];
+			for (int k = 0; k < tileOutputs; k++) if (currentGains[cell + k] != 0) mask |= (uint8)(1 << k); //still fading out
 
-	for (int outputIndex = 0; outputIndex < numAudioOutputs->intValue(); outputIndex++)
-	{
-		VolumeControl* outMI = mainOuts[outputIndex];
-		float newGain = outMI->getGain();
-		buffer.clear(outputIndex, 0, numSamples);
-		buffer.addFromWithRamp(outputIndex, 0, tmpBuffer.getReadPointer(outputIndex), numSamples, outMI->prevGain, newGain);
-		outMI->prevGain = newGain;
+			mask &= validMask;
+			if (mask == 0) continue;
 
-		outMI->updateRMS(buffer, outputIndex);
+			GainMatrixHelpers::mixInputIntoTile(buffer.getReadPointer(inputIndex), tile, currentGains + cell, targetGains + cell, mask, numSamples);
+		}
+
+		for (int k = 0; k < tileOutputs; k++)
+		{
+			VolumeControl* outMI = mainOuts[firstOutput + k];
+			float newGain = outMI->audioGain;
+			bool computeRMS = outMI->shouldComputeRMS();
+
+			float sum = GainMatrixHelpers::applyRampAndGetSumOfSquares(tile[k], outMI->prevGain, newGain, numSamples, computeRMS);
+			outMI->prevGain = newGain;
+
+			if (computeRMS) outMI->updateRMSLevel(std::sqrt(sum / numSamples), numSamples);
+		}
 	}
+
+	for (int outputIndex = 0; outputIndex < numOutputs; outputIndex++) buffer.copyFrom(outputIndex, 0, mix.buffer, outputIndex, 0, numSamples);
 }
 
 var MixerNode::getJSONData()
@@ -138,7 +231,7 @@ void MixerNode::loadJSONDataItemInternal(var data)
 
 void MixerNode::afterLoadJSONDataInternal()
 {
-
+	Node::afterLoadJSONDataInternal();
 }
 
 BaseNodeViewUI* MixerNode::createViewUI()
@@ -60,8 +60,17 @@ public:
 	BoolParameter* showItemGains;
 	BoolParameter* showItemActives;
 
-	AudioBuffer<float> tmpBuffer;
-	
+	//Gain matrix read by the mix kernel, outputs are grouped in tiles so each input is read once per tile instead of once per item.
+	//Items' gain changes are sent as ITEM_GAIN_COMMANDs, the audio thread writes them in targetGains with tileMasks (one bit per non-zero item in the tile).
+	//The matrix is only resized and synced from the items with processing suspended.
+	enum MixerCommandType { ITEM_GAIN_COMMAND }; //index is (inputIndex << 16) | outputIndex
+	static const int tileSize = GainMatrixHelpers::tileSize;
+	int matrixInputs;
+	int matrixTiles;
+	HeapBlock<float> targetGains; //audio thread only
+	HeapBlock<float> currentGains; //audio thread only
+	HeapBlock<uint8> tileMasks; //audio thread only
+
 	void updateAudioInputsInternal() override;
 	void updateAudioOutputsInternal() override;
 
@@ -69,6 +78,13 @@ public:
 
 	void reorderContainers();
 
+	void rebuildMixMatrix();
+	void setMatrixGain(int inputIndex, int outputIndex, float gain);
+
+	bool getAudioValueCommand(Parameter* p, float value, AudioCommand& command) override;
+	void syncAudioValues() override;
+	void handleAudioCommand(const AudioCommand& command, int sampleOffset) override;
+
 	void processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
 
 	var getJSONData() override;
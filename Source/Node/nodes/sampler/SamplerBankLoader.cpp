@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+	SamplerBankLoader.cpp
+	Created: 17 Oct 2026 6:02:41pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Node/NodeIncludes.h"
+
+SamplerBankLoader::SamplerBankLoader(SamplerNode* sampler, TimeSliceThread& thread) :
+	sampler(sampler),
+	thread(thread),
+	hasRequest(false),
+	requestGeneration(0),
+	requestedMapped(false),
+	requestedResidentSeconds(1),
+	loadedGeneration(-1)
+{
+	thread.addTimeSliceClient(this);
+}
+
+SamplerBankLoader::~SamplerBankLoader()
+{
+	thread.removeTimeSliceClient(this);
+	cancelPendingUpdate();
+}
+
+void SamplerBankLoader::loadBank(const File& folder, bool memoryMapped, float residentSeconds)
+{
+	{
+		const ScopedLock sl(requestLock);
+		requestGeneration++;
+		hasRequest = true;
+		requestedFolder = folder;
+		requestedMapped = memoryMapped;
+		requestedResidentSeconds = residentSeconds;
+	}
+
+	thread.moveToFrontOfQueue(this);
+}
+
+void SamplerBankLoader::cancel()
+{
+	{
+		const ScopedLock sl(requestLock);
+		requestGeneration++;
+		hasRequest = false;
+	}
+
+	cancelPendingUpdate();
+}
+
+int SamplerBankLoader::useTimeSlice()
+{
+	int generation = -1;
+	File folder;
+	bool memoryMapped = false;
+	float residentSeconds = 0;
+
+	{
+		const ScopedLock sl(requestLock);
+		if (hasRequest)
+		{
+			hasRequest = false;
+			generation = requestGeneration;
+			folder = requestedFolder;
+			memoryMapped = requestedMapped;
+			residentSeconds = requestedResidentSeconds;
+		}
+	}
+
+	if (generation != -1)
+	{
+		OwnedArray<LoadedNote> result;
+		if (readBank(generation, folder, memoryMapped, residentSeconds, result))
+		{
+			const ScopedLock sl(requestLock);
+			if (generation == requestGeneration)
+			{
+				loadedNotes.swapWith(result);
+				loadedFolder = folder;
+				loadedGeneration = generation;
+				triggerAsyncUpdate();
+			}
+		}
+
+		return 0; //a newer request may be waiting
+	}
+
+	prefetchMappedNotes();
+	return prefetchIntervalMS;
+}
+
+void SamplerBankLoader::handleAsyncUpdate()
+{
+	OwnedArray<LoadedNote> notes;
+	File folder;
+
+	{
+		const ScopedLock sl(requestLock);
+		if (loadedGeneration != requestGeneration) return; //cancelled or replaced in the meantime
+		notes.swapWith(loadedNotes);
+		folder = loadedFolder;
+	}
+
+	if (notes.isEmpty()) return;
+	sampler->applyLoadedBank(notes, folder); //the previous bank is freed with notes, out of the callback lock
+}
+
+bool SamplerBankLoader::readBank(int generation, const File& folder, bool memoryMapped, float residentSeconds, OwnedArray<LoadedNote>& result)
+{
+	for (int i = 0; i < 128; i++)
+	{
+		{
+			const ScopedLock sl(requestLock);
+			if (generation != requestGeneration) return false;
+		}
+
+		File f = folder.getChildFile(String(i) + ".wav");
+		result.add(f.existsAsFile() ? readNote(f, memoryMapped, residentSeconds) : nullptr);
+	}
+
+	return true;
+}
+
+SamplerBankLoader::LoadedNote* SamplerBankLoader::readNote(const File& f, bool memoryMapped, float residentSeconds)
+{
+	WavAudioFormat wavFormat;
+
+	if (memoryMapped)
+	{
+		std::unique_ptr<MemoryMappedAudioFormatReader> reader(wavFormat.createMemoryMappedReader(f));
+		if (reader != nullptr && reader->numChannels <= maxMappedChannels && reader->mapEntireFile())
+		{
+			int length = (int)reader->lengthInSamples;
+			int numResident = jmin(length, jmax(1, roundToInt(residentSeconds * reader->sampleRate)));
+
+			LoadedNote* n = new LoadedNote();
+			n->buffer.setSize(reader->numChannels, numResident);
+			reader->read(n->buffer.getArrayOfWritePointers(), reader->numChannels, 0, numResident);
+
+			if (numResident < length)
+			{
+				touchAhead(reader.get(), numResident, roundToInt(reader->sampleRate)); //the note may be hit as soon as the bank is swapped
+				n->mappedReader = std::move(reader);
+			}
+
+			return n;
+		}
+
+		//not a mappable wav, read it all
+	}
+
+	if (auto fileStream = std::unique_ptr<FileInputStream>(f.createInputStream()))
+	{
+		if (std::unique_ptr<AudioFormatReader> reader = std::unique_ptr<AudioFormatReader>(wavFormat.createReaderFor(fileStream.get(), false)))
+		{
+			fileStream.release(); // (passes responsibility for deleting the stream to the reader object that is now using it)
+			LoadedNote* n = new LoadedNote();
+			n->buffer.setSize(reader->numChannels, (int)reader->lengthInSamples);
+			reader->read(n->buffer.getArrayOfWritePointers(), reader->numChannels, 0, n->buffer.getNumSamples());
+			return n;
+		}
+	}
+
+	return nullptr;
+}
+
+void SamplerBankLoader::prefetchMappedNotes()
+{
+	const ScopedLock sl(sampler->mappedLock);
+
+	for (auto& n : sampler->samplerNotes)
+	{
+		if (n->adsr.getState() == CurvedADSR::env_idle && n->playingSample == 0) continue; //silent and not peeking, the attack is in memory
+
+		//auto key proxies read their source note at their own position
+		SamplerNode::SamplerNote* source = n->autoKeyFromNote != nullptr ? n->autoKeyFromNote : n;
+		int64 position = n->autoKeyFromNote != nullptr ? n->rtPitchReadSample : n->playingSample;
+		if (source->mappedReader == nullptr) continue;
+
+		int64 start = jmax(position, (int64)source->buffer.getNumSamples());
+		touchAhead(source->mappedReader.get(), start, roundToInt(source->mappedReader->sampleRate));
+	}
+}
+
+void SamplerBankLoader::touchAhead(MemoryMappedAudioFormatReader* reader, int64 startSample, int numSamples)
+{
+	//one read per page is enough for the system to load it
+	int bytesPerFrame = jmax(1, (int)(reader->bitsPerSample * reader->numChannels / 8));
+	int step = jmax(1, 4096 / bytesPerFrame);
+
+	int64 end = jmin(reader->lengthInSamples, startSample + numSamples);
+	for (int64 s = startSample; s < end; s += step) reader->touchSample(s);
+}
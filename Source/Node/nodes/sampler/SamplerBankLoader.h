@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+	SamplerBankLoader.h
+	Created: 17 Oct 2026 6:02:41pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class SamplerNode;
+
+/* Loads sampler banks on the sampler's bank thread, so the message and audio threads never wait on the disk.
+
+   A bank is read into its own set of buffers while the current one keeps playing, then handed to the message thread
+   which swaps it in with the sampler's notes in one short callback lock.
+   A new request while loading drops the bank being read.
+
+   Memory mapped banks only keep the attack of each sample in memory, the rest is read from the mapped file.
+   The same thread touches the pages ahead of every playing mapped note, so the audio thread doesn't have to wait for them.
+*/
+class SamplerBankLoader :
+	public TimeSliceClient,
+	public AsyncUpdater
+{
+public:
+	SamplerBankLoader(SamplerNode* sampler, TimeSliceThread& thread);
+	~SamplerBankLoader();
+
+	struct LoadedNote
+	{
+		AudioSampleBuffer buffer; //the whole sample, or only its attack when mapped
+		std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader;
+	};
+
+	static const int maxMappedChannels = 64;
+
+	SamplerNode* sampler;
+	TimeSliceThread& thread;
+
+	//message thread
+	void loadBank(const File& folder, bool memoryMapped, float residentSeconds);
+	void cancel();
+
+	int useTimeSlice() override;
+	void handleAsyncUpdate() override;
+
+private:
+	static const int prefetchIntervalMS = 20;
+
+	CriticalSection requestLock;
+	bool hasRequest;
+	int requestGeneration;
+	File requestedFolder;
+	bool requestedMapped;
+	float requestedResidentSeconds;
+
+	OwnedArray<LoadedNote> loadedNotes; //under requestLock until handed to the message thread
+	File loadedFolder;
+	int loadedGeneration;
+
+	//bank thread
+	bool readBank(int generation, const File& folder, bool memoryMapped, float residentSeconds, OwnedArray<LoadedNote>& result);
+	LoadedNote* readNote(const File& f, bool memoryMapped, float residentSeconds);
+	void prefetchMappedNotes();
+
+	static void touchAhead(MemoryMappedAudioFormatReader* reader, int64 startSample, int numSamples);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerBankLoader)
+};
@@ -13,12 +13,15 @@
 SamplerNode::SamplerNode(var params) :
 	Node(getTypeStringStatic(), params, true, true, false, true, true, true),
 	recordingNote(-1),
+	finishedRecordingNote(-1),
 	lastRecordedNote(-1),
 	lastPlayedNote(-1),
 	recordedSamples(0),
+	processThreadID(nullptr),
 	noteStatesCC("Notes"),
 	viewStartKey(20),
 	isUpdatingLibrary(false),
+	isUpdatingBank(false),
 	controlsCC("Controls"),
 	playCC("Play"),
 	recordCC("Record"),
@@ -92,6 +95,11 @@ SamplerNode::SamplerNode(var params) :
 	bankDescription = libraryCC.addStringParameter("Bank Description", "Description for this bank if available", "");
 
 	autoLoadBank = libraryCC.addBoolParameter("Auto Load Bank", "If checked, the bank will be loaded when the current bank is changed", true);
+	memoryMapSamples = libraryCC.addBoolParameter("Memory Map Samples", "If checked, only the start of each sample is loaded in memory and the rest is read from the file while playing. Applies to the next loaded bank", false);
+	residentTime = libraryCC.addFloatParameter("Resident Attack", "When memory mapping, time in seconds at the start of each sample that is kept in memory", 1, .1f, 10);
+	residentTime->defaultUI = FloatParameter::TIME;
+	isLoadingBank = libraryCC.addBoolParameter("Loading Bank", "Is a bank being loaded ? The previous bank keeps playing until the new one is ready", false);
+	isLoadingBank->setControllableFeedbackOnly(true);
 	loadBankTrigger = libraryCC.addTrigger("Load Bank", "Load all samples from the current bank");
 	saveBankTrigger = libraryCC.addTrigger("Save Bank", "Export all samples at once to this bank's folder");
 	showFolderTrigger = libraryCC.addTrigger("Show Folder", "Show the folder in explorer");
@@ -126,34 +134,45 @@ SamplerNode::SamplerNode(var params) :
 	setAudioInputs(numChannels->intValue());
 	setAudioOutputs(numChannels->intValue());
 
+	bankLoader.reset(new SamplerBankLoader(this, bankThread));
+	bankThread.startThread();
+
 	addChildControllableContainer(&noteStatesCC);
 	noteStatesCC.hideInEditor = true;
 
 	setMIDIIO(true, true);
+
+	startTimerHz(20); //recording state and takes, from the audio thread
 }
 
 SamplerNode::~SamplerNode()
 {
+	bankLoader.reset();
+	bankThread.stopThread(1000);
 	samplerNotes.clear();
 }
 
 void SamplerNode::clearNote(int note)
 {
 	if (note == -1) return;
+	const ScopedLock ml(mappedLock);
 	ScopedSuspender sp(processor);
 	samplerNotes[note]->adsr.reset();
 	samplerNotes[note]->buffer.setSize(0, 0);
+	samplerNotes[note]->mappedReader.reset();
 	samplerNotes[note]->state->setValueWithData(EMPTY);
 
 }
 
 void SamplerNode::clearAllNotes()
 {
+	const ScopedLock ml(mappedLock);
 	ScopedSuspender sp(processor);
 	for (auto& n : samplerNotes)
 	{
 		n->adsr.reset();
 		n->buffer.setSize(0, 0);
+		n->mappedReader.reset();
 		n->state->setValueWithData(EMPTY);
 	}
 }
@@ -170,6 +189,7 @@ void SamplerNode::resetAllNotes()
 void SamplerNode::computeAutoKeys()
 {
 	//ScopedSuspender sp(processor);
+	makeNotesResident(); //offline pitching works on whole buffers
 
 	for (int i = 0; i < samplerNotes.size(); i++)
 	{
@@ -220,75 +240,83 @@ void SamplerNode::updateBuffers()
 	ScopedSuspender sp(processor);
 	updateRingBuffer();
 	for (auto& n : samplerNotes)  n->buffer.setSize(getNumAudioInputs(), n->buffer.getNumSamples(), false, true);
+	updateRecordBuffer(processor->getSampleRate());
+	mappedReadBuffer.setSize(getNumAudioInputs(), processor->getBlockSize());
+	mappedGhostBuffer.setSize(getNumAudioInputs(), processor->getBlockSize());
 }
 
 void SamplerNode::updateRingBuffer()
 {
 	ScopedSuspender sp(processor);
-	ringBuffer.reset(new RingBuffer<float>(getNumAudioInputs(), getFadeNumSamples(fadeTimeMS->intValue()) * 2)); //double to not have overlapping read and write
-
+	int fadeNumSamples = getFadeNumSamples(fadeTimeMS->intValue());
+	ringBuffer.reset(new RingBuffer<float>(getNumAudioInputs(), fadeNumSamples * 2)); //double to not have overlapping read and write
+	preRecBuffer.setSize(getNumAudioInputs(), jmax(fadeNumSamples, 0), false, true);
 }
 
-void SamplerNode::startRecording(int note)
+void SamplerNode::updateRecordBuffer(double sampleRate)
 {
-	if (recordingNote != -1) return;
+	int recNumSamples = (int)(sampleRate * 60); // 1 min rec samples
+	if (recBuffer.getNumChannels() == getNumAudioInputs() && recBuffer.getNumSamples() == recNumSamples) return;
 
-	//ScopedSuspender sp(processor);
-
-	GenericScopedLock<SpinLock> lock(recLock);
-
-	isRecording->setValue(true);
-	recordingNote = note;
-
-	int recNumSamples = processor->getSampleRate() * 60; // 1 min rec samples
+	ScopedSuspender sp(processor);
+	if (recordingNote != -1) //the take is lost with the old buffer
+	{
+		recordedSamples = 0;
+		finishedRecordingNote = recordingNote.load();
+		recordingNote = -1;
+	}
 
-	SamplerNote* samplerNote = samplerNotes[note];
-	samplerNote->state->setValueWithData(RECORDING);
+	if (finishedRecordingNote != -1) finishRecording();
+	recBuffer.setSize(getNumAudioInputs(), recNumSamples);
+}
 
-	samplerNote->buffer.setSize(getNumAudioInputs(), recNumSamples, false, true);
+void SamplerNode::startRecording(int note)
+{
+	if (recordingNote != -1 || finishedRecordingNote != -1 || recBuffer.getNumSamples() == 0) return;
 
-	int fadeNumSamples = getFadeNumSamples(fadeTimeMS->intValue());
-	if (fadeNumSamples > 0)
-	{
-		preRecBuffer.setSize(samplerNote->buffer.getNumChannels(), fadeNumSamples, false, true);
-		ringBuffer->readSamples(preRecBuffer, fadeNumSamples);
-	}
+	if (preRecBuffer.getNumSamples() > 0) ringBuffer->readSamples(preRecBuffer, preRecBuffer.getNumSamples());
 
 	recordedSamples = 0;
+	recordingNote = note;
 }
 
 void SamplerNode::stopRecording()
 {
 	if (recordingNote == -1) return;
 
-	//ScopedSuspender sp(processor);
-
-	GenericScopedTryLock<SpinLock> lock(recLock);
-
-	SamplerNote* samplerNote = samplerNotes[recordingNote];
 	recordedSamples = recordedSamples - (recordedSamples % processor->getBlockSize()); //fit to blockSize
+	finishedRecordingNote = recordingNote.load();
+	recordingNote = -1;
+}
+
+void SamplerNode::finishRecording()
+{
+	int note = finishedRecordingNote;
+	SamplerNote* samplerNote = samplerNotes[note];
 
 	if (recordedSamples > 0)
 	{
-		//fade with ring buffer using looper fadeTimeMS
-		int fadeNumSamples = getFadeNumSamples(fadeTimeMS->intValue());
-		samplerNote->buffer.setSize(samplerNote->buffer.getNumChannels(), recordedSamples, true);
+		AudioSampleBuffer take(recBuffer.getNumChannels(), recordedSamples);
+		for (int i = 0; i < take.getNumChannels(); i++) take.copyFrom(i, 0, recBuffer, i, 0, recordedSamples);
 
-		if (fadeNumSamples > 0)
+		//fade with ring buffer using looper fadeTimeMS
+		int cropFadeNumSamples = jmin(recordedSamples, preRecBuffer.getNumSamples());
+		if (cropFadeNumSamples > 0)
 		{
-			int cropFadeNumSamples = jmin(recordedSamples, fadeNumSamples);
 			int bufferStartSample = recordedSamples - cropFadeNumSamples;
-
 			int preRecStartSample = preRecBuffer.getNumSamples() - cropFadeNumSamples;
 
-			samplerNote->buffer.applyGainRamp(bufferStartSample, cropFadeNumSamples, 1, 0);
+			take.applyGainRamp(bufferStartSample, cropFadeNumSamples, 1, 0);
 
-			for (int i = 0; i < samplerNote->buffer.getNumChannels(); i++)
+			for (int i = 0; i < take.getNumChannels(); i++)
 			{
-				samplerNote->buffer.addFromWithRamp(i, bufferStartSample, preRecBuffer.getReadPointer(i, preRecStartSample), cropFadeNumSamples, 0, 1);
+				take.addFromWithRamp(i, bufferStartSample, preRecBuffer.getReadPointer(i, preRecStartSample), cropFadeNumSamples, 0, 1);
 			}
+		}
 
-			preRecBuffer.clear();
+		{
+			ScopedSuspender sp(processor);
+			samplerNote->buffer = std::move(take);
 		}
 
 		samplerNote->state->setValueWithData(FILLED);
@@ -298,12 +326,24 @@ void SamplerNode::stopRecording()
 		samplerNote->state->setValueWithData(EMPTY);
 	}
 
-	lastRecordedNote = recordingNote;
-	lastPlayedNote = recordingNote;
-	recordingNote = -1;
+	lastRecordedNote = note;
+	lastPlayedNote = note;
+	finishedRecordingNote = -1;
 	isRecording->setValue(false);
 }
 
+void SamplerNode::timerCallback()
+{
+	int note = recordingNote;
+	if (note != -1 && !isRecording->boolValue())
+	{
+		isRecording->setValue(true);
+		samplerNotes[note]->state->setValueWithData(RECORDING);
+	}
+
+	if (finishedRecordingNote != -1) finishRecording();
+}
+
 
 void SamplerNode::onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c)
 {
@@ -390,10 +430,17 @@ void SamplerNode::onControllableFeedbackUpdateInternal(ControllableContainer* cc
 	}
 	else if (c == bankDescription)
 	{
-		if (!bankFolder.exists() && bankFolder != File()) bankFolder.createDirectory();
-		File newFolder = bankFolder.getParentDirectory().getChildFile(currentBank->stringValue() + "-" + bankDescription->stringValue());
-		bankFolder.moveFileTo(newFolder);
-		bankFolder = newFolder;
+		if (!isUpdatingBank)
+		{
+			if (!bankFolder.exists() && bankFolder != File()) bankFolder.createDirectory();
+			File newFolder = bankFolder.getParentDirectory().getChildFile(currentBank->stringValue() + "-" + bankDescription->stringValue());
+			if (newFolder != bankFolder)
+			{
+				if (mappedFolder == bankFolder) makeNotesResident(); //mapped files can't be moved on every system
+				bankFolder.moveFileTo(newFolder);
+				bankFolder = newFolder;
+			}
+		}
 	}
 	else if (c == playMode)
 	{
@@ -441,6 +488,28 @@ void SamplerNode::controllableStateChanged(Controllable* c)
 
 
 void SamplerNode::handleNoteOn(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity)
+{
+	if (Thread::getCurrentThreadId() != processThreadID.load()) sendAudioCommand(NOTE_ON_COMMAND, midiNoteNumber, velocity);
+	else processNoteOn(midiNoteNumber, velocity);
+}
+
+void SamplerNode::handleNoteOff(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity)
+{
+	if (Thread::getCurrentThreadId() != processThreadID.load()) sendAudioCommand(NOTE_OFF_COMMAND, midiNoteNumber, velocity);
+	else processNoteOff(midiNoteNumber);
+}
+
+void SamplerNode::handleAudioCommand(const AudioCommand& command, int sampleOffset)
+{
+	switch (command.type)
+	{
+	case NOTE_ON_COMMAND: processNoteOn(command.index, command.value); break;
+	case NOTE_OFF_COMMAND: processNoteOff(command.index); break;
+	default: break;
+	}
+}
+
+void SamplerNode::processNoteOn(int midiNoteNumber, float velocity)
 {
 	PlayMode pm = playMode->getValueDataAsEnum<PlayMode>();
 	HitMode hm = hitMode->getValueDataAsEnum<HitMode>();
@@ -497,6 +566,7 @@ void SamplerNode::handleNoteOn(MidiKeyboardState* source, int midiChannel, int m
 
 				sn->velocity = velocity;
 				sn->adsr.gate(1);
+				activateNote(midiNoteNumber);
 				lastPlayedNote = midiNoteNumber;
 				sn->state->setValueWithData(PLAYING);
 			}
@@ -540,17 +610,25 @@ void SamplerNode::handleNoteOn(MidiKeyboardState* source, int midiChannel, int m
 
 			sn->velocity = velocity;
 			sn->adsr.gate(1);
+			activateNote(midiNoteNumber);
 			lastPlayedNote = midiNoteNumber;
 			sn->state->setValueWithData(PLAYING);
 		}
 	}
 }
 
-void SamplerNode::handleNoteOff(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity)
+void SamplerNode::activateNote(int note)
+{
+	if (isNoteActive[note]) return;
+	isNoteActive[note] = true;
+	activeNotes[numActiveNotes++] = note;
+}
+
+void SamplerNode::processNoteOff(int midiNoteNumber)
 {
 	HitMode hm = hitMode->getValueDataAsEnum<HitMode>();
 
-	if (samplerNotes[midiNoteNumber]->state->getValueDataAsEnum<NoteState>() == RECORDING) stopRecording();
+	if (midiNoteNumber == recordingNote) stopRecording();
 	else if (samplerNotes[midiNoteNumber]->hasContent() || samplerNotes[midiNoteNumber]->isProxyNote())
 	{
 		if (hm != PIANO) return;
@@ -626,13 +704,16 @@ void SamplerNode::updateBank()
 	}
 
 	bankFolder = bFolder;
+	isUpdatingBank = true; //the folder already has this name
 	bankDescription->setValue(desc);
+	isUpdatingBank = false;
 
 	if (autoLoadBank->boolValue()) loadBankSamples();
 }
 
 void SamplerNode::saveBankSamples()
 {
+	makeNotesResident(); //the bank's files are rewritten
 	if (!bankFolder.exists()) bankFolder.createDirectory();
 
 	Array<File> filesToDelete = bankFolder.findChildFiles(File::TypesOfFileToFind::findFiles, false);
@@ -689,31 +770,76 @@ void SamplerNode::loadBankSamples()
 
 	LOG("Importing samples...");
 
-	int numSamplesImported = 0;
+	isLoadingBank->setValue(true);
+	bankLoader->loadBank(bankFolder, memoryMapSamples->boolValue(), residentTime->floatValue());
+}
+
+void SamplerNode::applyLoadedBank(OwnedArray<SamplerBankLoader::LoadedNote>& loadedNotes, const File& folder)
+{
+	//allocate the empty slots first, so the swap below only moves pointers
 	for (int i = 0; i < samplerNotes.size(); i++)
+	{
+		if (loadedNotes[i] == nullptr) loadedNotes.set(i, new SamplerBankLoader::LoadedNote());
+	}
+
+	Array<int> swappedNotes;
+	{
+		const ScopedLock ml(mappedLock);
+		const ScopedLock sl(processor->getCallbackLock());
+
+		for (int i = 0; i < samplerNotes.size(); i++)
+		{
+			SamplerNote* n = samplerNotes[i];
+			NoteState ns = n->state->getValueDataAsEnum<NoteState>();
+			if (ns == RECORDING || ns == PROCESSING || i == recordingNote || i == finishedRecordingNote) continue;
+
+			SamplerBankLoader::LoadedNote* ln = loadedNotes[i];
+			std::swap(n->buffer, ln->buffer);
+			std::swap(n->mappedReader, ln->mappedReader);
+
+			n->adsr.reset();
+			n->setAutoKey(nullptr);
+			n->jumpGhostSample = -1;
+			n->playingSample = 0;
+			n->oneShotted = false;
+			swappedNotes.add(i);
+		}
+	}
+
+	int numSamplesImported = 0;
+	mappedFolder = File();
+	for (auto& n : samplerNotes) if (n->isMapped()) mappedFolder = folder;
+
+	for (auto& i : swappedNotes)
 	{
 		SamplerNote* n = samplerNotes[i];
-		if (n->hasContent()) clearNote(i);
+		n->state->setValueWithData(n->hasContent() ? FILLED : EMPTY);
+		if (n->hasContent()) numSamplesImported++;
+	}
 
-		File f = bankFolder.getChildFile(String(i) + ".wav");
+	isLoadingBank->setValue(false);
+	NLOG(niceName, numSamplesImported << " sampler notes imported from " << folder.getFullPathName());
+}
+
+void SamplerNode::makeNotesResident()
+{
+	for (auto& n : samplerNotes)
+	{
+		if (!n->isMapped()) continue;
 
-		if (!f.existsAsFile()) continue;
+		AudioSampleBuffer fullBuffer(n->buffer.getNumChannels(), n->getLength());
+		n->readSamples(fullBuffer, 0, 0, fullBuffer.getNumSamples());
 
-		if (auto fileStream = std::unique_ptr<FileInputStream>(f.createInputStream()))
+		std::unique_ptr<MemoryMappedAudioFormatReader> oldReader;
 		{
-			WavAudioFormat wavFormat;
-			if (std::unique_ptr<AudioFormatReader> reader = std::unique_ptr<AudioFormatReader>(wavFormat.createReaderFor(fileStream.get(), false)))
-			{
-				fileStream.release(); // (passes responsibility for deleting the stream to the writer object that is now using it)
-				n->buffer.setSize(reader->numChannels, reader->lengthInSamples);
-				reader->read(n->buffer.getArrayOfWritePointers(), reader->numChannels, 0, n->buffer.getNumSamples());
-				n->state->setValueWithData(FILLED);
-				numSamplesImported++;
-			}
+			const ScopedLock ml(mappedLock);
+			const ScopedLock sl(processor->getCallbackLock());
+			std::swap(n->buffer, fullBuffer);
+			std::swap(n->mappedReader, oldReader);
 		}
 	}
 
-	NLOG(niceName, numSamplesImported << " sampler notes imported from " << bankFolder.getFullPathName());
+	mappedFolder = File();
 }
 
 
@@ -734,6 +860,12 @@ void SamplerNode::prepareToPlay(double sampleRate, int maximumExpectedSamplesPer
 {
 	if (sampleRate != 0) midiCollector.reset(sampleRate);
 
+	mappedReadBuffer.setSize(getNumAudioInputs(), maximumExpectedSamplesPerBlock);
+	mappedGhostBuffer.setSize(getNumAudioInputs(), maximumExpectedSamplesPerBlock);
+	if (sampleRate != 0) updateRecordBuffer(sampleRate);
+	voiceGains.setSize(3, maximumExpectedSamplesPerBlock);
+	rampNumSamples = 0;
+
 	for (int i = 0; i < 128; i++)
 	{
 		samplerNotes[i]->adsr.setAttackRate(attack->floatValue() * sampleRate);
@@ -752,17 +884,14 @@ void SamplerNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& m
 
 	int blockSize = buffer.getNumSamples();
 
-	if (isRecording->boolValue())
+	if (recordingNote != -1)
 	{
-		GenericScopedTryLock<SpinLock> lock(recLock);
-
-		if (lock.isLocked())
+		if (recordedSamples + blockSize > recBuffer.getNumSamples()) stopRecording(); //full
+		else
 		{
-			SamplerNote* samplerNote = samplerNotes[recordingNote];
-
-			for (int i = 0; i < buffer.getNumChannels(); i++)
+			for (int i = 0; i < jmin(buffer.getNumChannels(), recBuffer.getNumChannels()); i++)
 			{
-				samplerNote->buffer.copyFrom(i, recordedSamples, buffer, i, 0, blockSize);
+				recBuffer.copyFrom(i, recordedSamples, buffer, i, 0, blockSize);
 			}
 
 			recordedSamples += blockSize;
@@ -770,29 +899,48 @@ void SamplerNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& m
 	}
 
 	if (!monitor->boolValue()) buffer.clear();
+	processThreadID = Thread::getCurrentThreadId();
 	keyboardState.processNextMidiBuffer(midiMessages, 0, buffer.getNumSamples(), false);
 
-	AudioSampleBuffer tmpNoteBuffer(buffer.getNumChannels(), blockSize);
-
 	PlayMode pm = playMode->getValueDataAsEnum<PlayMode>();
 
-	for (int i = 0; i < 128; i++)
+	if (pm == PEEK)
 	{
-		SamplerNote* s = samplerNotes[i];
+		//silent notes keep moving when peeking
+		for (int i = 0; i < 128; i++)
+		{
+			SamplerNote* s = samplerNotes[i];
+			if (s->adsr.getState() != CurvedADSR::env_idle) continue;
 
-		NoteState st = s->state->getValueDataAsEnum<NoteState>();
-		if (st == EMPTY || st == RECORDING || st == PROCESSING) continue;
+			NoteState st = s->state->getValueDataAsEnum<NoteState>();
+			if (st == EMPTY || st == RECORDING || st == PROCESSING) continue;
+
+			s->playingSample += blockSize;
+			if (s->playingSample >= s->getLength()) s->playingSample = 0;
+		}
+	}
+
+	jassert(voiceGains.getNumSamples() >= blockSize);
+	if (voiceGains.getNumSamples() < blockSize) return;
 
+	if (rampNumSamples != blockSize)
+	{
+		float* ramp = voiceGains.getWritePointer(2);
+		for (int i = 0; i < blockSize; i++) ramp[i] = i * 1.0f / blockSize;
+		rampNumSamples = blockSize;
+	}
 
+	for (int a = 0; a < numActiveNotes;)
+	{
+		int i = activeNotes[a];
+		SamplerNote* s = samplerNotes[i];
 
 		if (s->adsr.getState() == CurvedADSR::env_idle)
 		{
-			if (pm == PEEK)
-			{
-				s->playingSample += blockSize;
-				if (s->playingSample >= s->buffer.getNumSamples()) s->playingSample = 0;
-			}
-			else if (s->isProxyNote())
+			isNoteActive[i] = false;
+			activeNotes[a] = activeNotes[--numActiveNotes];
+
+			if (pm != PEEK && s->isProxyNote())
 			{
 				s->setAutoKey(nullptr);
 				s->state->setValueWithData(EMPTY);
@@ -801,28 +949,38 @@ void SamplerNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& m
 			continue;
 		}
 
+		a++;
+
+		NoteState st = s->state->getValueDataAsEnum<NoteState>();
+		if (st == EMPTY || st == RECORDING || st == PROCESSING) continue;
 
 		if (pm != HIT_ONESHOT || !s->oneShotted)
 		{
 			AudioSampleBuffer* targetBuffer = &s->buffer;
 			int targetReadSample = s->playingSample;
+			int targetLength = s->getLength();
+
+			AudioSampleBuffer* ghostBuffer = &s->buffer;
+			int ghostReadSample = s->jumpGhostSample;
+			bool hasGhost = s->jumpGhostSample != -1 && s->jumpGhostSample != s->playingSample && s->jumpGhostSample < targetLength;
 
 			if (s->isProxyNote())
 			{
 
-				AudioBuffer<float> tmpBuffer(s->autoKeyFromNote->buffer.getNumChannels(), blockSize);
+				ScopedScratchBuffer tmpPitch(scratchBuffers, s->autoKeyFromNote->buffer.getNumChannels(), blockSize);
+				AudioBuffer<float>& tmpBuffer = tmpPitch.buffer;
 				auto readPointers = tmpBuffer.getArrayOfReadPointers();
 
 				DBG("Rt pitch sample before");
-				GenericScopedLock pLock(s->pitcherLock);
+				RTCheckedScopedLock<SpinLock> pLock(s->pitcherLock, "SamplerNote::pitcherLock");
 				while (s->pitcher->available() < blockSize)
 				{
 
-					for (int ch = 0; ch < buffer.getNumChannels(); ch++) tmpBuffer.copyFrom(ch, 0, s->autoKeyFromNote->buffer.getReadPointer(ch, s->rtPitchReadSample), blockSize);
+					s->autoKeyFromNote->readSamples(tmpBuffer, 0, s->rtPitchReadSample, blockSize);
 					s->pitcher->process(readPointers, tmpBuffer.getNumSamples(), false);
 					s->rtPitchReadSample += blockSize;
 
-					if (s->rtPitchReadSample >= s->autoKeyFromNote->buffer.getNumSamples())
+					if (s->rtPitchReadSample >= s->autoKeyFromNote->getLength())
 					{
 						DBG("Reset RT read sample");
 						s->rtPitchReadSample = 0;
@@ -845,60 +1003,42 @@ void SamplerNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& m
 
 				targetBuffer = &s->rtPitchedBuffer;
 				targetReadSample = 0; //read from rtbuffer
+				targetLength = targetBuffer->getNumSamples();
+				ghostBuffer = targetBuffer;
 			}
-
-
-			//String dbg;
-			//dbg << "[" << i << "] Jump ghost sample : " << s->jumpGhostSample << ", playingSample : " << s->playingSample << ", adsr : " << s->adsr.getOutput() << ", velocity " << s->velocity;
-
-			if (s->jumpGhostSample != -1 && s->jumpGhostSample != s->playingSample && s->jumpGhostSample < s->buffer.getNumSamples())
+			else if (s->isMapped())
 			{
-				//dbg += " > Interpolate";
-				for (int j = 0; j < buffer.getNumChannels(); j++)
-				{
-					tmpNoteBuffer.copyFromWithRamp(j, 0, targetBuffer->getReadPointer(j, s->jumpGhostSample), blockSize, 1, 0);
-					tmpNoteBuffer.addFromWithRamp(j, 0, targetBuffer->getReadPointer(j, s->playingSample), blockSize, 0, 1);
-				}
+				//the block may be past the attack, read it through the mapping
+				mappedReadBuffer.setSize(buffer.getNumChannels(), blockSize, false, false, true);
+				s->readSamples(mappedReadBuffer, 0, s->playingSample, blockSize);
+				targetBuffer = &mappedReadBuffer;
+				targetReadSample = 0;
 
-				s->jumpGhostSample = -1;
-			}
-			else
-			{
-				for (int j = 0; j < buffer.getNumChannels(); j++)
+				if (hasGhost)
 				{
-					if (pm == HIT_ONESHOT)
-					{
-						if (s->playingSample == targetBuffer->getNumSamples() - blockSize)
-						{
-							tmpNoteBuffer.copyFromWithRamp(j, 0, targetBuffer->getReadPointer(j, targetReadSample), blockSize, 1, 0);
-						}
-						else if (s->playingSample == 0)
-						{
-							tmpNoteBuffer.copyFromWithRamp(j, 0, targetBuffer->getReadPointer(j, targetReadSample), blockSize, 0, 1);
-						}
-						else
-						{
-							tmpNoteBuffer.copyFrom(j, 0, *targetBuffer, j, targetReadSample, blockSize);
-						}
-					}
-					else
-					{
-						tmpNoteBuffer.copyFrom(j, 0, *targetBuffer, j, targetReadSample, blockSize);
-					}
+					mappedGhostBuffer.setSize(buffer.getNumChannels(), blockSize, false, false, true);
+					s->readSamples(mappedGhostBuffer, 0, s->jumpGhostSample, blockSize);
+					ghostBuffer = &mappedGhostBuffer;
+					ghostReadSample = 0;
 				}
 			}
 
-			s->adsr.applyEnvelopeToBuffer(tmpNoteBuffer, 0, blockSize);
-			for (int j = 0; j < buffer.getNumChannels(); j++)
+
+			int fade = 0;
+			if (!hasGhost && pm == HIT_ONESHOT)
 			{
-				buffer.addFromWithRamp(j, 0, tmpNoteBuffer.getReadPointer(j), blockSize, s->prevVelocity, s->velocity);
+				if (s->playingSample == targetLength - blockSize) fade = -1;
+				else if (s->playingSample == 0) fade = 1;
 			}
 
+			mixNote(buffer, s, targetBuffer, targetReadSample, hasGhost ? ghostBuffer : nullptr, ghostReadSample, fade);
+			if (hasGhost) s->jumpGhostSample = -1;
+
 			s->prevVelocity = s->velocity;
 
 			s->playingSample += blockSize;
 
-			int numSamplesToCheck = s->isProxyNote() ? s->autoKeyFromNote->buffer.getNumSamples() : targetBuffer->getNumSamples();
+			int numSamplesToCheck = s->isProxyNote() ? s->autoKeyFromNote->getLength() : targetLength;
 			if (!s->isProxyNote() && s->playingSample >= numSamplesToCheck)
 			{
 				if (pm == HIT_ONESHOT)
@@ -919,6 +1059,44 @@ void SamplerNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& m
 }
 
 
+void SamplerNode::mixNote(AudioBuffer<float>& buffer, SamplerNote* s, const AudioSampleBuffer* source, int sourceSample,
+	const AudioSampleBuffer* ghost, int ghostSample, int fade)
+{
+	int blockSize = buffer.getNumSamples();
+	float* gain = voiceGains.getWritePointer(0);
+	const float* ramp = voiceGains.getReadPointer(2);
+
+	//envelope, velocity ramp and one shot fade in a single gain curve, applied while mixing
+	s->adsr.renderEnvelope(gain, blockSize);
+
+	if (s->prevVelocity == s->velocity) FloatVectorOperations::multiply(gain, s->velocity, blockSize);
+	else
+	{
+		float velocityDelta = s->velocity - s->prevVelocity;
+		for (int i = 0; i < blockSize; i++) gain[i] *= s->prevVelocity + velocityDelta * ramp[i];
+	}
+
+	if (fade > 0) FloatVectorOperations::multiply(gain, ramp, blockSize);
+	else if (fade < 0) for (int i = 0; i < blockSize; i++) gain[i] *= 1 - ramp[i];
+
+	if (ghost == nullptr)
+	{
+		for (int j = 0; j < buffer.getNumChannels(); j++) FloatVectorOperations::addWithMultiply(buffer.getWritePointer(j), source->getReadPointer(j, sourceSample), gain, blockSize);
+		return;
+	}
+
+	//crossfade from the position before the jump
+	float* ghostGain = voiceGains.getWritePointer(1);
+	for (int i = 0; i < blockSize; i++) ghostGain[i] = gain[i] * (1 - ramp[i]);
+	FloatVectorOperations::multiply(gain, ramp, blockSize);
+
+	for (int j = 0; j < buffer.getNumChannels(); j++)
+	{
+		FloatVectorOperations::addWithMultiply(buffer.getWritePointer(j), ghost->getReadPointer(j, ghostSample), ghostGain, blockSize);
+		FloatVectorOperations::addWithMultiply(buffer.getWritePointer(j), source->getReadPointer(j, sourceSample), gain, blockSize);
+	}
+}
+
 BaseNodeViewUI* SamplerNode::createViewUI()
 {
 	return new SamplerNodeViewUI(this);
@@ -963,7 +1141,7 @@ void SamplerNode::SamplerNote::setAutoKey(SamplerNote* remoteNote, double shift)
 	pitcher->setPitchScale(shift);
 	//LOG("Set with pitchScale : " << shift);
 	rtPitchReadSample = 0;
-	rtPitchedBuffer.setSize(autoKeyFromNote->buffer.getNumChannels(), Transport::getInstance()->blockSize);
+	rtPitchedBuffer.setSize(autoKeyFromNote->buffer.getNumChannels(), Transport::getInstance()->blockSize, false, false, true);
 }
 
 void SamplerNode::SamplerNote::computeAutoKey(SamplerNote* remoteNote, double shift, int fadeSamples)
@@ -1033,6 +1211,39 @@ void SamplerNode::SamplerNote::run()
 	state->setValueWithData(NoteState::FILLED);
 }
 
+void SamplerNode::SamplerNote::readSamples(AudioBuffer<float>& dest, int destStartSample, int startSample, int numSamples)
+{
+	int numChannels = jmin(dest.getNumChannels(), buffer.getNumChannels());
+	for (int ch = numChannels; ch < dest.getNumChannels(); ch++) dest.clear(ch, destStartSample, numSamples);
+
+	int numResident = jlimit(0, numSamples, buffer.getNumSamples() - startSample);
+	for (int ch = 0; ch < numChannels && numResident > 0; ch++) dest.copyFrom(ch, destStartSample, buffer, ch, startSample, numResident);
+
+	startSample += numResident;
+	destStartSample += numResident;
+	numSamples -= numResident;
+
+	if (numSamples > 0 && mappedReader != nullptr)
+	{
+		int numMapped = jlimit(0, numSamples, getLength() - startSample);
+		if (numMapped > 0)
+		{
+			//one pointer per file channel so the reader doesn't allocate, the ones we don't need are skipped
+			float* channels[SamplerBankLoader::maxMappedChannels] = {};
+			int numFileChannels = jmin((int)mappedReader->numChannels, (int)SamplerBankLoader::maxMappedChannels);
+			for (int ch = 0; ch < jmin(numChannels, numFileChannels); ch++) channels[ch] = dest.getWritePointer(ch, destStartSample);
+			for (int ch = numFileChannels; ch < numChannels; ch++) dest.clear(ch, destStartSample, numMapped);
+
+			mappedReader->read(channels, numFileChannels, startSample, numMapped);
+
+			destStartSample += numMapped;
+			numSamples -= numMapped;
+		}
+	}
+
+	for (int ch = 0; ch < numChannels && numSamples > 0; ch++) dest.clear(ch, destStartSample, numSamples);
+}
+
 void SamplerNode::SamplerNote::reset()
 {
 	//adsr.reset();
@@ -12,7 +12,8 @@
 
 class SamplerNode :
 	public Node,
-	public MidiKeyboardStateListener
+	public MidiKeyboardStateListener,
+	public Timer
 {
 public:
 	SamplerNode(var params);
@@ -61,6 +62,9 @@ public:
 	IntParameter* currentBank;
 	StringParameter* bankDescription;
 	BoolParameter* autoLoadBank;
+	BoolParameter* memoryMapSamples;
+	FloatParameter* residentTime;
+	BoolParameter* isLoadingBank;
 	Trigger* loadBankTrigger;
 	Trigger* saveBankTrigger;
 	Trigger* showFolderTrigger;
@@ -71,24 +75,47 @@ public:
 	BoolParameter* showKeyboard;
 
 
-	int recordingNote;
+	std::atomic<int> recordingNote; //started and stopped on the audio thread
+	std::atomic<int> finishedRecordingNote; //take waiting to be copied to its note on the message thread, no new recording until then
 	int lastRecordedNote;
 	int lastPlayedNote;
 
 	int viewStartKey;
 
-	SpinLock recLock;
+	std::atomic<Thread::ThreadID> processThreadID; //keyboard events from any other thread (UI keyboard) are sent as commands
+
+	enum CommandType { NOTE_ON_COMMAND, NOTE_OFF_COMMAND };
 
 	bool isUpdatingLibrary;
+	bool isUpdatingBank;
 	File bankFolder;
+	File mappedFolder; //folder the mapped notes read from, empty when every note is in memory
 	int curBankIndex;
 
 	std::unique_ptr<RingBuffer<float>> ringBuffer;
-	AudioSampleBuffer preRecBuffer;
+	AudioSampleBuffer recBuffer; //allocated when the channels or the sample rate change, recording never resizes it
+	AudioSampleBuffer preRecBuffer; //input just before the recording, to crossfade the end of the take
 	int recordedSamples;
 
 	MidiKeyboardState keyboardState;
 
+	TimeSliceThread bankThread{ "Sampler Bank Thread" }; //loads banks and pages in mapped samples
+	std::unique_ptr<SamplerBankLoader> bankLoader;
+	CriticalSection mappedLock; //held when a note's mapped reader changes, and by the bank thread while it touches them
+	AudioSampleBuffer mappedReadBuffer; //audio thread, block read from a mapped note
+	AudioSampleBuffer mappedGhostBuffer; //same for the crossfaded jump position
+
+	//audio thread, notes with a running envelope. The others are not visited, unless peeking
+	int activeNotes[128];
+	int numActiveNotes = 0;
+	bool isNoteActive[128] = {};
+	void activateNote(int note);
+
+	AudioSampleBuffer voiceGains; //envelope, velocity and fades of the note being mixed, and the crossfade of its jump
+	int rampNumSamples = 0; //voiceGains channel 2 holds i / rampNumSamples
+	void mixNote(AudioBuffer<float>& buffer, SamplerNote* s, const AudioSampleBuffer* source, int sourceSample,
+		const AudioSampleBuffer* ghost, int ghostSample, int fade);
+
 
 	enum NoteState { EMPTY, RECORDING, FILLED, PROCESSING, PLAYING };
 	class SamplerNote :
@@ -106,6 +133,7 @@ public:
 		bool oneShotted = false;
 
 		AudioSampleBuffer buffer;
+		std::unique_ptr<MemoryMappedAudioFormatReader> mappedReader; //when set, buffer only holds the attack and the rest is read from the file
 
 		//offline pitching
 		double shifting = 0;
@@ -126,7 +154,12 @@ public:
 
 		void reset();
 
+		//reads from buffer and then from the mapped file, silence after the end
+		void readSamples(AudioBuffer<float>& dest, int destStartSample, int startSample, int numSamples);
+
 		bool hasContent() const { return buffer.getNumSamples() > 0; }
+		bool isMapped() const { return mappedReader != nullptr; }
+		int getLength() const { return isMapped() ? (int)mappedReader->lengthInSamples : buffer.getNumSamples(); }
 		bool isProxyNote() const { return autoKeyFromNote != nullptr; }
 	};
 
@@ -137,19 +170,27 @@ public:
 	void resetAllNotes();
 
 	void computeAutoKeys();
+	void makeNotesResident(); //reads mapped samples entirely in memory, before working on whole buffers or touching the bank's files
 
 
 	void updateBuffers();
 	void updateRingBuffer();
+	void updateRecordBuffer(double sampleRate);
+
+	void startRecording(int note); //audio thread
+	void stopRecording(); //audio thread
+	void finishRecording(); //message thread, trims and fades the take into its note
 
-	void startRecording(int note);
-	void stopRecording();
+	void timerCallback() override;
 
 	void onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c) override;
 	void controllableStateChanged(Controllable* c) override;
 
 	virtual void handleNoteOn(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
 	virtual void handleNoteOff(MidiKeyboardState* source, int midiChannel, int midiNoteNumber, float velocity) override;
+	void processNoteOn(int midiNoteNumber, float velocity); //audio thread
+	void processNoteOff(int midiNoteNumber); //audio thread
+	void handleAudioCommand(const AudioCommand& command, int sampleOffset) override;
 
 	virtual int getFadeNumSamples(int fadeMS); //for ring buffer fade
 
@@ -158,6 +199,7 @@ public:
 
 	void saveBankSamples();
 	void loadBankSamples();
+	void applyLoadedBank(OwnedArray<SamplerBankLoader::LoadedNote>& loadedNotes, const File& folder);
 
 
 	var getJSONData() override;
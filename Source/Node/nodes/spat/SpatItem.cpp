@@ -19,13 +19,20 @@ SpatItem::SpatItem(const String& name, var params) :
 	//hideInEditor = true;
 	position = addPoint2DParameter("Position", "Position of this point");
 	position->setBounds(0, 0, 1, 1);
-
+	height = addFloatParameter("Height", "Height of this point, 0 is the listener's level. Used for distance and 3D panning", 0, -1, 1);
 }
 
 SpatItem::~SpatItem()
 {
 }
 
+Vector3D<float> SpatItem::getPosition3D()
+{
+	//the 2D position is in 0..1, rescaled to the range of the height
+	Point<float> p = position->getPoint();
+	return Vector3D<float>(p.x * 2 - 1, p.y * 2 - 1, height->floatValue());
+}
+
 
 SpatSource::SpatSource() :
 	SpatItem(getTypeString()),
@@ -34,7 +41,7 @@ SpatSource::SpatSource() :
 	controlAngle(nullptr),
 	controlRadius(nullptr),
 	controlCurTime(0),
-	lastControlUpdate(0)
+	lastControlUpdate(-1)
 {
 	setHasCustomColor(true);
 
@@ -60,7 +67,7 @@ void SpatSource::onContainerTriggerTriggered(Trigger* t)
 	{
 		GenericScopedLock lock(controlLock);
 		controlCurTime = 0;
-		lastControlUpdate = Time::getMillisecondCounter() / 1000.0f;
+		lastControlUpdate = -1;
 	}
 }
 
@@ -149,17 +156,16 @@ void SpatSource::updateControlMode()
 	}
 }
 
-void SpatSource::update()
+void SpatSource::update(double time)
 {
 	ControlMode m = controlMode->getValueDataAsEnum<ControlMode>();
 
 	if (m == FREE_2D || m == FREE_POLAR) return;
 
 	GenericScopedLock lock(controlLock);
-	float t = Time::getMillisecondCounter() / 1000.0f;
-	float dt = t - lastControlUpdate;
+	float dt = lastControlUpdate >= 0 ? (float)(time - lastControlUpdate) : 0;
 	controlCurTime += controlSpeed->floatValue() * dt;
-	lastControlUpdate = t;
+	lastControlUpdate = time;
 
 	switch (m)
 	{
@@ -20,8 +20,11 @@ public:
 	int index;
 
 	Point2DParameter* position;
+	FloatParameter* height;
 	FloatParameter* radius;
 
+	Vector3D<float> getPosition3D(); //centered on the listener, all axes in -1..1
+
 	void setIndex(int i) { index = i; setNiceName(getTypeString() + " " + String(i)); }
 };
 
@@ -46,13 +49,13 @@ public:
 	Array<Parameter*> controlParams;
 
 	float controlCurTime;
-	float lastControlUpdate;
+	double lastControlUpdate; //audio time of the last update, -1 to start from the next one
 
 	void onContainerTriggerTriggered(Trigger* t) override;
 	void onContainerParameterChangedInternal(Parameter* p) override;
 
 	void updateControlMode();
-	void update();
+	void update(double time); //time in seconds of audio, so animations follow the rendered audio
 
 	DECLARE_TYPE("Source");
 };
@@ -16,7 +16,13 @@ SpatNode::SpatNode(var params) :
 	fadeCurve("Fade Curve", nullptr),
 	layoutCC("Layout"),
 	sources("Sources"),
-	targets("Targets")
+	targets("Targets"),
+	matrixSources(0),
+	matrixTiles(0),
+	hasPendingWeights(false),
+	weightsDirty(true),
+	layoutDirty(true),
+	animationTime(0)
 {
 	saveAndLoadRecursiveData = true;
 
@@ -30,6 +36,10 @@ SpatNode::SpatNode(var params) :
 	circleArc = layoutCC.addFloatParameter("Circle Arc", "Arc of the circle if in circle mode", 1, -1, 1);
 	firstIsCentered = layoutCC.addBoolParameter("First is Centered", "If checked, the first target will be centered", false);
 
+	panningMode = layoutCC.addEnumParameter("Panning", "How sources are spread on targets. Distance uses the radius and fade curve, VBAP pans between the closest pair or triplet of targets as seen from the center, Ambisonics encodes the sources and decodes them on all targets.");
+	panningMode->addOption("Distance", DISTANCE)->addOption("VBAP", VBAP)->addOption("Ambisonics", AMBISONICS);
+	ambisonicOrder = layoutCC.addIntParameter("Ambisonic Order", "Order of the ambisonic encoding, higher orders are more precise but need more targets", 3, 1, SpatPanning::maxAmbisonicOrder, false);
+
 	AutomationKey* k = fadeCurve.addKey(0, 1);
 	k->easingType->setValueWithData(Easing::BEZIER);
 	fadeCurve.addKey(1, 0);
@@ -62,6 +72,14 @@ SpatNode::SpatNode(var params) :
 
 	viewUISize->setPoint(300, 300);
 
+	Transport::getInstance()->addBlockListener(this);
+	startTimerHz(50); //control rate for animated sources and weight updates
+}
+
+SpatNode::~SpatNode()
+{
+	if (Transport* t = Transport::getInstanceWithoutCreating()) t->removeBlockListener(this);
+	stopTimer();
 }
 
 void SpatNode::placeTargets()
@@ -101,8 +119,102 @@ void SpatNode::updateRadiuses()
 	for (auto& si : targets.items) si->radius->setValue(spatRadius->floatValue());
 }
 
+void SpatNode::updateLayout()
+{
+	layoutDirty = false;
+
+	Array<SpatPanning::Vec> speakerDirections;
+	for (auto& t : targets.items) speakerDirections.add(t->getPosition3D());
+
+	PanningMode m = panningMode->getValueDataAsEnum<PanningMode>();
+	vbapTriplets = m == VBAP ? SpatPanning::computeVBAPTriplets(speakerDirections) : Array<SpatPanning::Triplet>();
+	if (m == AMBISONICS) SpatPanning::computeAmbisonicDecoder(speakerDirections, ambisonicOrder->intValue(), ambisonicDecoder);
+	else ambisonicDecoder.clear();
+}
+
+void SpatNode::getSourceGains(SpatSource* s, float* gains, int numTargets)
+{
+	PanningMode m = panningMode->getValueDataAsEnum<PanningMode>();
+	SpatPanning::Vec direction = s->getPosition3D();
+
+	switch (m)
+	{
+	case VBAP:
+		SpatPanning::getVBAPGains(vbapTriplets, direction, gains, numTargets);
+		break;
+
+	case AMBISONICS:
+		SpatPanning::getAmbisonicGains(ambisonicDecoder, ambisonicOrder->intValue(), direction, gains, numTargets);
+		break;
+
+	default:
+	{
+		Vector3D<float> pos = s->getPosition3D();
+		for (int targetIndex = 0; targetIndex < numTargets; targetIndex++)
+		{
+			SpatTarget* si = targets.items[targetIndex];
+			float dist = (pos - si->getPosition3D()).length() / 2; //radius is in 2D position units, half of the -1..1 range
+			float rad = si->radius->floatValue();
+			float relDist = jlimit<float>(0, 1, rad == 0 ? 1 : dist / rad);
+			gains[targetIndex] = jmax(fadeCurve.getValueAtPosition(relDist), 0.0f);
+		}
+	}
+	break;
+	}
+}
+
 void SpatNode::updateWeights()
 {
+	weightsDirty = false;
+	if (layoutDirty) updateLayout();
+
+	int numSources = jmin(sources.items.size(), matrixSources);
+	int numTargets = jmin(targets.items.size(), matrixTiles * tileSize);
+	int stride = matrixTiles * tileSize;
+	int size = jmax(matrixSources * stride, 1);
+
+	//computed outside of the lock, the audio thread only misses the copy
+	FloatVectorOperations::clear(computedWeights.get(), size);
+	for (int sourceIndex = 0; sourceIndex < numSources; sourceIndex++) getSourceGains(sources.items[sourceIndex], computedWeights + sourceIndex * stride, numTargets);
+
+	{
+		const SpinLock::ScopedLockType lock(weightsLock);
+		FloatVectorOperations::clear(pendingWeights.get(), size);
+		for (int sourceIndex = 0; sourceIndex < numSources; sourceIndex++)
+		{
+			if (sources.items[sourceIndex]->enabled->boolValue()) FloatVectorOperations::copy(pendingWeights + sourceIndex * stride, computedWeights + sourceIndex * stride, numTargets);
+		}
+		hasPendingWeights = true;
+	}
+
+	//feedback after releasing the lock, listeners of the weights can do anything
+	for (int targetIndex = 0; targetIndex < numTargets; targetIndex++)
+	{
+		SpatTarget* si = targets.items[targetIndex];
+		for (int sourceIndex = 0; sourceIndex < numSources && sourceIndex < si->weights.size(); sourceIndex++)
+		{
+			si->weights[sourceIndex]->setValue(std::abs(computedWeights[sourceIndex * stride + targetIndex])); //ambisonics can give inverted gains
+		}
+	}
+}
+
+void SpatNode::resizeWeightMatrix()
+{
+	//called with processing suspended
+	matrixSources = getNumAudioInputs();
+	matrixTiles = (getNumAudioOutputs() + tileSize - 1) / tileSize;
+	layoutDirty = true;
+	int size = jmax(matrixSources * matrixTiles * tileSize, 1);
+
+	computedWeights.allocate(size, true);
+	{
+		const SpinLock::ScopedLockType lock(weightsLock);
+		pendingWeights.allocate(size, true);
+		targetWeights.allocate(size, true);
+		currentWeights.allocate(size, true);
+	}
+
+	updateWeights();
 }
 
 void SpatNode::updateAudioInputsInternal()
@@ -110,6 +222,13 @@ void SpatNode::updateAudioInputsInternal()
 	Array<Colour> colors;
 	for (auto& s : sources.items) colors.add(s->itemColor->getColor());
 	for (auto& t : targets.items) t->setSources(colors);
+
+	resizeWeightMatrix();
+}
+
+void SpatNode::updateAudioOutputsInternal()
+{
+	resizeWeightMatrix();
 }
 
 
@@ -132,6 +251,26 @@ void SpatNode::onControllableFeedbackUpdateInternal(ControllableContainer* cc, C
 	{
 		updateRadiuses();
 	}
+	else if (c == panningMode || c == ambisonicOrder)
+	{
+		if (c == panningMode) ambisonicOrder->setEnabled(panningMode->getValueDataAsEnum<PanningMode>() == AMBISONICS);
+		layoutDirty = true;
+		weightsDirty = true;
+	}
+	else if (fadeCurve.containsControllable(c))
+	{
+		weightsDirty = true;
+	}
+	else if (SpatTarget* si = c->getParentAs<SpatTarget>())
+	{
+		//rms and weights are computed feedback, not inputs of the weights
+		if (c == si->position || c == si->height) layoutDirty = true;
+		if (c == si->position || c == si->height || c == si->radius || c == si->enabled) weightsDirty = true;
+	}
+	else if (SpatSource* s = c->getParentAs<SpatSource>())
+	{
+		if (c == s->position || c == s->height || c == s->enabled) weightsDirty = true;
+	}
 }
 
 void SpatNode::itemAdded(SpatSource* s)
@@ -165,22 +304,61 @@ void SpatNode::itemRemoved(SpatTarget* s)
 	setAudioOutputs(targets.items.size());
 }
 
+void SpatNode::transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS)
+{
+	int sampleRate = Transport::getInstance()->sampleRate;
+	if (sampleRate > 0) animationTime = animationTime.load() + numSamples * 1.0 / sampleRate;
+}
+
+void SpatNode::timerCallback()
+{
+	double time = animationTime.load();
+	for (auto& s : sources.items) s->update(time); //animated sources, the position changes will set weightsDirty
+	if (weightsDirty) updateWeights();
+}
+
 void SpatNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
 	int numSamples = buffer.getNumSamples();
 
-	int numInputs = jmin(getNumAudioInputs(), sources.items.size());
-	int numOutputs = jmin(getNumAudioOutputs(), targets.items.size());
+	int numInputs = jmin(getNumAudioInputs(), sources.items.size(), matrixSources);
+	int numOutputs = jmin(getNumAudioOutputs(), targets.items.size(), matrixTiles * tileSize);
+	int stride = matrixTiles * tileSize;
+
+	//pick up the new weights if the message thread is not writing them, otherwise keep ramping to the previous ones
+	if (weightsLock.tryEnter())
+	{
+		if (hasPendingWeights)
+		{
+			FloatVectorOperations::copy(targetWeights.get(), pendingWeights.get(), jmax(matrixSources * stride, 1));
+			hasPendingWeights = false;
+		}
+		weightsLock.exit();
+	}
+
+	ScopedScratchBuffer targetBuffer(scratchBuffers, numOutputs, numSamples);
 
-	AudioSampleBuffer targetBuffer(numOutputs, numSamples);
-	targetBuffer.clear();
+	for (int firstOutput = 0; firstOutput < numOutputs; firstOutput += tileSize)
+	{
+		int tileOutputs = jmin(tileSize, numOutputs - firstOutput);
+
+		float* tile[tileSize] = {};
+		for (int k = 0; k < tileOutputs; k++) tile[k] = targetBuffer.buffer.getWritePointer(firstOutput + k);
 
-	for (int i = 0; i < numInputs; i++) processSource(i, buffer, targetBuffer);
+		for (int i = 0; i < numInputs; i++)
+		{
+			int cell = i * stride + firstOutput;
+			uint8 mask = 0;
+			for (int k = 0; k < tileOutputs; k++) if (targetWeights[cell + k] != 0 || currentWeights[cell + k] != 0) mask |= (uint8)(1 << k);
+			if (mask == 0) continue;
+
+			GainMatrixHelpers::mixInputIntoTile(buffer.getReadPointer(i), tile, currentWeights + cell, targetWeights + cell, mask, numSamples);
+		}
+	}
 
 	for (int outputIndex = 0; outputIndex < numOutputs; outputIndex++)
 	{
-		buffer.clear(outputIndex, 0, numSamples);
-		buffer.addFrom(outputIndex, 0, targetBuffer.getReadPointer(outputIndex), numSamples);
+		buffer.copyFrom(outputIndex, 0, targetBuffer.buffer, outputIndex, 0, numSamples);
 
 		jassert(!processor->isSuspended());
 		SpatTarget* si = targets.items[outputIndex];
@@ -192,33 +370,6 @@ void SpatNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midi
 	}
 }
 
-void SpatNode::processSource(int index, AudioBuffer<float>& sourceBuffer, AudioBuffer<float>& targetBuffer)
-{
-	if (index >= sources.items.size()) return;
-
-	SpatSource* s = sources.items[index];
-	if (!s->enabled->boolValue()) return;
-
-	s->update();
-
-	Point<float> pos = s->position->getPoint();
-	int numOutputs = targets.items.size();
-	int numSamples = sourceBuffer.getNumSamples();
-
-	for (int outputIndex = 0; outputIndex < numOutputs; outputIndex++)
-	{
-		SpatTarget* si = targets.items[outputIndex];
-		float dist = pos.getDistanceFrom(si->position->getPoint());
-		float rad = si->radius->floatValue();
-		float relDist = jlimit<float>(0, 1, rad == 0 ? 1 : dist / rad);
-		float weight = fadeCurve.getValueAtPosition(relDist);
-
-		if (weight > 0) targetBuffer.addFrom(outputIndex, 0, sourceBuffer.getReadPointer(index), numSamples, weight);
-
-		if (index < si->weights.size()) si->weights[index]->setValue(weight);
-	}
-}
-
 void SpatNode::afterLoadJSONDataInternal()
 {
 	Node::afterLoadJSONDataInternal();
@@ -13,17 +13,23 @@
 class SpatNode :
 	public Node,
 	public BaseManager<SpatSource>::ManagerListener,
-	public BaseManager<SpatTarget>::ManagerListener
+	public BaseManager<SpatTarget>::ManagerListener,
+	public Transport::BlockListener,
+	public Timer
 {
 public:
 	SpatNode(var params = var());
-	~SpatNode() {}
+	~SpatNode();
 
 	ControllableContainer layoutCC;
 
 	enum SpatMode { FREE, CIRCLE };
 	EnumParameter* spatMode;
 
+	enum PanningMode { DISTANCE, VBAP, AMBISONICS };
+	EnumParameter* panningMode;
+	IntParameter* ambisonicOrder;
+
 	FloatParameter* spatRadius;
 	Automation fadeCurve;
 	FloatParameter* circleRadius;
@@ -34,13 +40,35 @@ public:
 	BaseManager<SpatSource> sources;
 	BaseManager<SpatTarget> targets;
 
-	Array<float, CriticalSection> weights;
+	//Weight matrix, sources x targets with targets grouped in tiles. It is computed on the message thread when positions or radii change
+	//(animated sources are updated at control rate from the timer), and the audio thread ramps from the previous weights to it over the next block.
+	static const int tileSize = GainMatrixHelpers::tileSize;
+	int matrixSources;
+	int matrixTiles;
+	HeapBlock<float> computedWeights; //message thread only, computed before taking the lock
+	HeapBlock<float> pendingWeights; //written by the message thread, under weightsLock
+	HeapBlock<float> targetWeights; //audio thread only
+	HeapBlock<float> currentWeights; //audio thread only
+	SpinLock weightsLock;
+	bool hasPendingWeights;
+	std::atomic<bool> weightsDirty; //set by the inputs of the weights, from any thread that sets them
+
+	//speaker layout for VBAP and ambisonics, rebuilt when targets move
+	Array<SpatPanning::Triplet> vbapTriplets;
+	Array<float> ambisonicDecoder;
+	std::atomic<bool> layoutDirty;
+
+	std::atomic<double> animationTime; //seconds of audio since the node was created, animations follow it so they also run in offline renders
 
 	void placeTargets();
 	void updateRadiuses();
+	void updateLayout();
 	void updateWeights();
+	void getSourceGains(SpatSource* s, float* gains, int numTargets);
+	void resizeWeightMatrix();
 
 	void updateAudioInputsInternal() override;
+	void updateAudioOutputsInternal() override;
 
 	void onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c) override;
 	void itemAdded(SpatSource* s) override;
@@ -48,8 +76,10 @@ public:
 	void itemAdded(SpatTarget* s) override;
 	void itemRemoved(SpatTarget* s) override;
 
+	void transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS) override;
+	void timerCallback() override;
+
 	void processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
-	void processSource(int index, AudioBuffer<float>& sourceBuffer, AudioBuffer<float>& targetBuffer);
 
 
 	void afterLoadJSONDataInternal() override;
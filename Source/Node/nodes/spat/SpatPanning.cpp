@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+	SpatPanning.cpp
+	Created: 17 Oct 2026 4:12:08pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Node/NodeIncludes.h"
+
+static float dot(const SpatPanning::Vec& a, const SpatPanning::Vec& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static SpatPanning::Vec cross(const SpatPanning::Vec& a, const SpatPanning::Vec& b) { return SpatPanning::Vec(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+
+Array<SpatPanning::Triplet> SpatPanning::computeVBAPTriplets(const Array<Vec>& speakerDirections)
+{
+	Array<Triplet> result;
+
+	Array<int> validSpeakers;
+	Array<Vec> dirs;
+	bool isFlat = true;
+	for (int i = 0; i < speakerDirections.size(); i++)
+	{
+		Vec d = speakerDirections[i];
+		if (d.length() < 1e-4f) continue; //on the listener, no direction
+		validSpeakers.add(i);
+		dirs.add(d.normalised());
+		if (std::abs(dirs.getLast().z) > 1e-3f) isFlat = false;
+	}
+
+	int numValid = validSpeakers.size();
+
+	if (isFlat)
+	{
+		//pairs of neighbours by azimuth
+		Array<int> order;
+		for (int i = 0; i < numValid; i++) order.add(i);
+		std::sort(order.begin(), order.end(), [&dirs](int a, int b) { return std::atan2(dirs[a].y, dirs[a].x) < std::atan2(dirs[b].y, dirs[b].x); });
+
+		for (int i = 0; i < numValid; i++)
+		{
+			int a = order[i];
+			int b = order[(i + 1) % numValid];
+			if (a == b) continue;
+
+			float det = dirs[a].x * dirs[b].y - dirs[a].y * dirs[b].x;
+			if (det <= 1e-4f) continue; //opposite or identical speakers, or a gap wider than half a circle
+
+			Triplet t;
+			t.numSpeakers = 2;
+			t.speakers[0] = validSpeakers[a];
+			t.speakers[1] = validSpeakers[b];
+			t.speakers[2] = -1;
+			t.inverse[0] = dirs[b].y / det;  t.inverse[1] = -dirs[a].y / det;
+			t.inverse[2] = -dirs[b].x / det; t.inverse[3] = dirs[a].x / det;
+			result.add(t);
+		}
+
+		return result;
+	}
+
+	//faces of the convex hull of the speaker directions. Brute force, speaker counts are small and this only runs when the layout changes
+	for (int i = 0; i < numValid; i++)
+	{
+		for (int j = i + 1; j < numValid; j++)
+		{
+			for (int k = j + 1; k < numValid; k++)
+			{
+				Vec normal = cross(dirs[j] - dirs[i], dirs[k] - dirs[i]);
+				if (normal.length() < 1e-5f) continue;
+
+				bool hasAbove = false;
+				bool hasBelow = false;
+				for (int p = 0; p < numValid && !(hasAbove && hasBelow); p++)
+				{
+					if (p == i || p == j || p == k) continue;
+					float side = dot(normal, dirs[p] - dirs[i]);
+					if (side > 1e-4f) hasAbove = true;
+					else if (side < -1e-4f) hasBelow = true;
+				}
+
+				if (hasAbove && hasBelow) continue;
+
+				const Vec& a = dirs[i];
+				const Vec& b = dirs[j];
+				const Vec& c = dirs[k];
+				float det = dot(a, cross(b, c));
+				if (std::abs(det) < 1e-4f) continue; //plane going through the listener, can't pan in there
+
+				//inverse of the matrix with the speaker directions as rows
+				Vec bc = cross(b, c);
+				Vec ca = cross(c, a);
+				Vec ab = cross(a, b);
+
+				Triplet t;
+				t.numSpeakers = 3;
+				t.speakers[0] = validSpeakers[i];
+				t.speakers[1] = validSpeakers[j];
+				t.speakers[2] = validSpeakers[k];
+				t.inverse[0] = bc.x / det; t.inverse[1] = ca.x / det; t.inverse[2] = ab.x / det;
+				t.inverse[3] = bc.y / det; t.inverse[4] = ca.y / det; t.inverse[5] = ab.y / det;
+				t.inverse[6] = bc.z / det; t.inverse[7] = ca.z / det; t.inverse[8] = ab.z / det;
+				result.add(t);
+			}
+		}
+	}
+
+	return result;
+}
+
+void SpatPanning::getVBAPGains(const Array<Triplet>& triplets, Vec direction, float* gains, int numSpeakers)
+{
+	FloatVectorOperations::clear(gains, numSpeakers);
+	if (numSpeakers == 0) return;
+
+	bool isFlat = triplets.size() > 0 && triplets[0].numSpeakers == 2;
+	if (isFlat) direction.z = 0;
+
+	if (triplets.isEmpty() || direction.length() < 1e-4f)
+	{
+		//no layout or source on the listener, spread evenly
+		FloatVectorOperations::fill(gains, 1.0f / std::sqrt((float)numSpeakers), numSpeakers);
+		return;
+	}
+
+	Vec p = direction.normalised();
+
+	//the containing triplet has all gains positive, if the direction is outside the layout (e.g. below a dome) take the closest one
+	int bestIndex = -1;
+	float bestMin = -std::numeric_limits<float>::max();
+	float bestGains[3] = { 0, 0, 0 };
+
+	for (int i = 0; i < triplets.size(); i++)
+	{
+		const Triplet& t = triplets.getReference(i);
+		float g[3] = { 0, 0, 0 };
+		float minGain;
+
+		if (t.numSpeakers == 2)
+		{
+			g[0] = p.x * t.inverse[0] + p.y * t.inverse[2];
+			g[1] = p.x * t.inverse[1] + p.y * t.inverse[3];
+			minGain = jmin(g[0], g[1]);
+		}
+		else
+		{
+			for (int j = 0; j < 3; j++) g[j] = p.x * t.inverse[j] + p.y * t.inverse[3 + j] + p.z * t.inverse[6 + j];
+			minGain = jmin(g[0], g[1], g[2]);
+		}
+
+		if (minGain > bestMin)
+		{
+			bestMin = minGain;
+			bestIndex = i;
+			for (int j = 0; j < 3; j++) bestGains[j] = g[j];
+		}
+
+		if (minGain >= 0) break;
+	}
+
+	const Triplet& t = triplets.getReference(bestIndex);
+	float power = 0;
+	for (int j = 0; j < t.numSpeakers; j++)
+	{
+		bestGains[j] = jmax(bestGains[j], 0.0f);
+		power += bestGains[j] * bestGains[j];
+	}
+
+	if (power <= 0) return;
+
+	float norm = 1.0f / std::sqrt(power);
+	for (int j = 0; j < t.numSpeakers; j++) if (t.speakers[j] < numSpeakers) gains[t.speakers[j]] = bestGains[j] * norm;
+}
+
+void SpatPanning::getSphericalHarmonics(Vec direction, int order, float* result)
+{
+	order = jlimit(0, maxAmbisonicOrder, order);
+
+	float len = direction.length();
+	Vec d = len > 1e-4f ? direction * (1.0f / len) : Vec(1, 0, 0);
+
+	float azimuth = std::atan2(d.y, d.x);
+	float sinEl = jlimit(-1.0f, 1.0f, d.z);
+	float cosEl = std::sqrt(1 - sinEl * sinEl);
+
+	//associated Legendre functions P(n,m)(sin elevation), without the Condon-Shortley phase
+	float legendre[maxAmbisonicOrder + 1][maxAmbisonicOrder + 1] = {};
+	legendre[0][0] = 1;
+	for (int m = 1; m <= order; m++) legendre[m][m] = (2 * m - 1) * cosEl * legendre[m - 1][m - 1];
+	for (int m = 0; m < order; m++) legendre[m + 1][m] = (2 * m + 1) * sinEl * legendre[m][m];
+	for (int m = 0; m <= order; m++)
+	{
+		for (int n = m + 2; n <= order; n++) legendre[n][m] = ((2 * n - 1) * sinEl * legendre[n - 1][m] - (n + m - 1) * legendre[n - 2][m]) / (n - m);
+	}
+
+	for (int n = 0; n <= order; n++)
+	{
+		for (int m = -n; m <= n; m++)
+		{
+			int am = std::abs(m);
+
+			//N3D : sqrt((2n+1) * (2 - delta(m)) * (n-|m|)! / (n+|m|)!)
+			double factorialRatio = 1;
+			for (int f = n - am + 1; f <= n + am; f++) factorialRatio /= f;
+			float norm = (float)std::sqrt((2 * n + 1) * (m == 0 ? 1 : 2) * factorialRatio);
+
+			float angular = m >= 0 ? std::cos(am * azimuth) : std::sin(am * azimuth);
+			result[n * n + n + m] = norm * legendre[n][am] * angular;
+		}
+	}
+}
+
+void SpatPanning::computeAmbisonicDecoder(const Array<Vec>& speakerDirections, int order, Array<float>& decoder)
+{
+	order = jlimit(0, maxAmbisonicOrder, order);
+	int numHarmonics = getNumHarmonics(order);
+	int numSpeakers = speakerDirections.size();
+
+	decoder.clearQuick();
+	decoder.insertMultiple(0, 0, numSpeakers * numHarmonics);
+	if (numSpeakers == 0) return;
+
+	//max-rE weights, narrows the main lobe and lowers the side lobes
+	float rE = std::cos(degreesToRadians(137.9f) / (order + 1.51f));
+	float orderWeights[maxAmbisonicOrder + 1];
+	for (int n = 0; n <= order; n++) orderWeights[n] = getLegendre(n, rE);
+
+	float sh[(maxAmbisonicOrder + 1) * (maxAmbisonicOrder + 1)];
+	for (int s = 0; s < numSpeakers; s++)
+	{
+		getSphericalHarmonics(speakerDirections[s], order, sh);
+		for (int n = 0; n <= order; n++)
+		{
+			for (int m = -n; m <= n; m++)
+			{
+				int acn = n * n + n + m;
+				decoder.set(s * numHarmonics + acn, orderWeights[n] * sh[acn] / numSpeakers);
+			}
+		}
+	}
+}
+
+void SpatPanning::getAmbisonicGains(const Array<float>& decoder, int order, Vec direction, float* gains, int numSpeakers)
+{
+	order = jlimit(0, maxAmbisonicOrder, order);
+	int numHarmonics = getNumHarmonics(order);
+
+	FloatVectorOperations::clear(gains, numSpeakers);
+	if (decoder.size() < numSpeakers * numHarmonics) return;
+
+	//encoding and decoding are both linear and fixed for the block, so they collapse into one gain per speaker
+	float sh[(maxAmbisonicOrder + 1) * (maxAmbisonicOrder + 1)];
+	getSphericalHarmonics(direction, order, sh);
+
+	float power = 0;
+	for (int s = 0; s < numSpeakers; s++)
+	{
+		const float* row = decoder.begin() + s * numHarmonics;
+		float g = 0;
+		for (int h = 0; h < numHarmonics; h++) g += row[h] * sh[h];
+		gains[s] = g;
+		power += g * g;
+	}
+
+	if (power > 0) FloatVectorOperations::multiply(gains, 1.0f / std::sqrt(power), numSpeakers);
+}
+
+float SpatPanning::getLegendre(int n, float x)
+{
+	float p0 = 1;
+	if (n == 0) return p0;
+	float p1 = x;
+	for (int k = 2; k <= n; k++)
+	{
+		float p2 = ((2 * k - 1) * x * p1 - (k - 1) * p0) / k;
+		p0 = p1;
+		p1 = p2;
+	}
+	return p1;
+}
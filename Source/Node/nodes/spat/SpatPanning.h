@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+	SpatPanning.h
+	Created: 17 Oct 2026 4:12:08pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/* Panning laws for the spatializer, all computed on the message thread.
+   Directions are seen from the listener at the center of the layout, they are the items' SpatItem::getPosition3D().
+*/
+class SpatPanning
+{
+public:
+	typedef Vector3D<float> Vec;
+
+	//VBAP : a source is panned on the speaker pair (flat layout) or triplet (3D layout) that contains its direction
+	struct Triplet
+	{
+		int numSpeakers; //2 for pairs, 3 for triplets
+		int speakers[3];
+		float inverse[9]; //inverse of the speaker directions matrix, row major
+	};
+
+	static Array<Triplet> computeVBAPTriplets(const Array<Vec>& speakerDirections);
+	static void getVBAPGains(const Array<Triplet>& triplets, Vec direction, float* gains, int numSpeakers);
+
+	//Ambisonics : real spherical harmonics, ACN ordering, N3D normalization
+	static const int maxAmbisonicOrder = 5;
+	static int getNumHarmonics(int order) { return (order + 1) * (order + 1); }
+	static void getSphericalHarmonics(Vec direction, int order, float* result);
+
+	//Sampling decoder with max-rE weighting, numSpeakers x numHarmonics, row major
+	static void computeAmbisonicDecoder(const Array<Vec>& speakerDirections, int order, Array<float>& decoder);
+	static void getAmbisonicGains(const Array<float>& decoder, int order, Vec direction, float* gains, int numSpeakers);
+
+private:
+	static float getLegendre(int n, float x);
+};
@@ -17,6 +17,7 @@ VSTNode::VSTNode(var params) :
 	antiMacroFeedback(false),
 	isSettingVST(false),
 	prevWetDry(1),
+	audioDryWet(1),
 	vstNotifier(5)
 {
 	numAudioInputs->canBeDisabledByUser = true;
@@ -167,11 +168,18 @@ void VSTNode::setVSTState(const String& data)
 	if (data.isEmpty()) return;
 
 	MemoryBlock b;
-	if (b.fromBase64Encoding(data))
+	if (!b.fromBase64Encoding(data)) return;
+
+	if (isCurrentlyLoadingData || Engine::mainEngine->isLoadingFile)
 	{
-		GenericScopedLock lock(vstStateLock);
+		ScopedSuspender sp(processor); //session load, nothing is playing through this node yet
 		vst->setStateInformation(b.getData(), b.getSize());
+		return;
 	}
+
+	//live (presets) : only the plugin is skipped while its state changes, the node keeps running
+	const SpinLock::ScopedLockType lock(vstStateLock);
+	vst->setStateInformation(b.getData(), b.getSize());
 }
 
 void VSTNode::updatePresetEnum(const String& setPresetName)
@@ -352,6 +360,26 @@ void VSTNode::onControllableStateChanged(Controllable* c)
 	if (c == autoActivateMacroIndex || c == autoActivateRange) checkAutoBypass();
 }
 
+bool VSTNode::getAudioValueCommand(Parameter* p, float value, AudioCommand& command)
+{
+	if (p != dryWet) return Node::getAudioValueCommand(p, value, command);
+
+	command.type = DRY_WET_COMMAND;
+	command.value = value;
+	return true;
+}
+
+void VSTNode::syncAudioValues()
+{
+	Node::syncAudioValues();
+	audioDryWet = dryWet->floatValue();
+}
+
+void VSTNode::handleAudioCommand(const AudioCommand& command, int sampleOffset)
+{
+	if (command.type == DRY_WET_COMMAND) audioDryWet = command.value;
+}
+
 void VSTNode::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock)
 {
 	if (vst != nullptr && sampleRate > 0 && maximumExpectedSamplesPerBlock > 0) vst->prepareToPlay(sampleRate, maximumExpectedSamplesPerBlock);
@@ -360,7 +388,7 @@ void VSTNode::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBloc
 
 void VSTNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
-	float weight = dryWet->floatValue();
+	float weight = audioDryWet;
 
 	if (prevWetDry == weight)
 	{
@@ -369,8 +397,8 @@ void VSTNode::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiM
 	}
 	else
 	{
-		AudioBuffer<float> vstBuffer(buffer.getNumChannels(), buffer.getNumSamples());
-		vstBuffer.clear();
+		ScopedScratchBuffer vstScratch(scratchBuffers, buffer.getNumChannels(), buffer.getNumSamples());
+		AudioBuffer<float>& vstBuffer = vstScratch.buffer;
 		processVSTBlock(vstBuffer, midiMessages, false);
 
 		buffer.applyGainRamp(0, buffer.getNumSamples(), 1 - prevWetDry, 1 - weight);
@@ -395,7 +423,7 @@ void VSTNode::processVSTBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessag
 	{
 		if (!bypassed)
 		{
-			GenericScopedTryLock lock(vstStateLock);
+			const SpinLock::ScopedTryLockType lock(vstStateLock);
 			if (lock.isLocked()) vst->processBlock(buffer, midiMessages);
 		}
 
@@ -42,12 +42,15 @@ public:
 	EnumParameter* presetEnum;
 	std::unique_ptr<AudioPluginInstance> vst;
 
-	SpinLock vstStateLock;
+	SpinLock vstStateLock; //held while a live state is set, the audio thread skips the plugin for those blocks
 
 	bool antiMacroFeedback;
 	bool isSettingVST; //avoid updating vst's playconfig while setting it
 	float prevWetDry;
 
+	enum VSTCommandType { DRY_WET_COMMAND };
+	float audioDryWet; //audio thread copy of dryWet, set by DRY_WET_COMMAND
+
 	void clearItem() override;
 	
 	void setupVST(PluginDescription* description);
@@ -67,6 +70,9 @@ public:
 	void onControllableFeedbackUpdateInternal(ControllableContainer* cc, Controllable* c) override;
 	void onControllableStateChanged(Controllable* c) override;
 
+	bool getAudioValueCommand(Parameter* p, float value, AudioCommand& command) override;
+	void syncAudioValues() override;
+	void handleAudioCommand(const AudioCommand& command, int sampleOffset) override;
 
 	void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
 	void processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override;
@@ -19,6 +19,11 @@ NodeManagerViewUI::NodeManagerViewUI(NodeManager* manager) :
 	connectionManagerUI.reset(new NodeConnectionManagerViewUI(this, manager->connectionManager.get()));
 	addAndMakeVisible(connectionManagerUI.get(), 0);
 
+	cpuUsageUI.reset(manager->cpuUsage->createSlider());
+	cpuUsageUI->suffix = " %";
+	cpuUsageUI->fixedDecimals = 1;
+	addAndMakeVisible(cpuUsageUI.get());
+
 	setShowPane(true);
 
 	bringToFrontOnSelect = false;
@@ -45,6 +50,9 @@ void NodeManagerViewUI::resized()
 	BaseManagerViewUI::resized();
 	connectionManagerUI->setBounds(getLocalBounds());
 	connectionManagerUI->resized();
+
+	//top right, below the crumbs of the panel
+	cpuUsageUI->setBounds(getLocalBounds().removeFromTop(50).removeFromBottom(24).removeFromRight(180).reduced(2));
 }
 
 void NodeManagerViewUI::addItemUIInternal(BaseNodeViewUI* ui)
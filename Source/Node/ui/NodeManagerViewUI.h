@@ -24,6 +24,7 @@ public:
     Point<int> forcedDragTargetPos;
 
     std::unique_ptr< NodeConnectionManagerViewUI> connectionManagerUI;
+    std::unique_ptr<FloatSliderUI> cpuUsageUI;
 
     BaseNodeViewUI* createUIForItem(Node * n) override;
 
@@ -169,6 +169,12 @@ void BaseNodeViewUI::resized()
 	if (outMIDIConnector != nullptr) outMIDIConnector->setBounds(outR.removeFromTop(w));
 }
 
+void BaseNodeViewUI::resizedInternalHeader(Rectangle<int>& r)
+{
+	BaseItemUI::resizedInternalHeader(r);
+	if (cpuShareUI != nullptr) cpuShareUI->setBounds(r.removeFromRight(50).reduced(2));
+}
+
 void BaseNodeViewUI::resizedInternalContent(Rectangle<int>& r)
 {
 	BaseItemUI::resizedInternalContent(r);
@@ -280,6 +286,22 @@ void BaseNodeViewUI::viewFilterUpdated()
 		outControlUI.reset();
 	}
 
+	if (item->showCPUShare->boolValue())
+	{
+		if (cpuShareUI == nullptr)
+		{
+			cpuShareUI.reset(item->cpuShare->createSlider());
+			cpuShareUI->showLabel = false;
+			cpuShareUI->suffix = " %";
+			cpuShareUI->fixedDecimals = 1;
+			addAndMakeVisible(cpuShareUI.get());
+		}
+	}
+	else if (cpuShareUI != nullptr)
+	{
+		removeChildComponent(cpuShareUI.get());
+		cpuShareUI.reset();
+	}
 
 	resized();
 }
@@ -25,6 +25,7 @@ public:
 
     Rectangle<int> outControlRect;
     std::unique_ptr<VolumeControlUI> outControlUI;
+    std::unique_ptr<FloatSliderUI> cpuShareUI;
 
     void updateInputConnectors();
     void updateOutputConnectors();
@@ -32,6 +33,7 @@ public:
     void paint(Graphics& g) override;
     void paintOverChildren(Graphics& g) override;
     virtual void resized() override;
+    virtual void resizedInternalHeader(Rectangle<int>& r) override;
     virtual void resizedInternalContent(Rectangle<int>& r) override;
     virtual void resizedInternalContentNode(Rectangle<int>& r) {}
 
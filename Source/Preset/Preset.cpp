@@ -15,7 +15,8 @@ Preset::Preset(var params) :
 	BaseItem(getTypeString()),
 	linkedPresetsCC("Linked Presets"),
 	transitionCC("Transition"),
-	transitionCurve("Transition Curve")
+	transitionCurve("Transition Curve"),
+	dataVersion(0)
 {
 	itemDataType = "Preset";
 	hideInEditor = true;
@@ -138,18 +139,7 @@ var Preset::getPresetValues(bool includeParents, Array<Controllable*> ignoreList
 
 	//Parents and Linked presets
 	Array<Preset*> presetsToInclude;
-	if (includeParents)
-	{
-		if (parentContainer != nullptr && parentContainer != RootPresetManager::getInstance()) presetsToInclude.add((Preset*)parentContainer->parentContainer.get());
-
-		for (auto& c : linkedPresetsCC.controllables)
-		{
-			if (!c->enabled) continue;
-			Preset* p = dynamic_cast<Preset*>(((TargetParameter*)c)->targetContainer.get());
-			if (p == nullptr) continue;
-			presetsToInclude.add(p);
-		}
-	}
+	if (includeParents) presetsToInclude = getIncludedPresets();
 
 	for (auto& p : presetsToInclude)
 	{
@@ -166,6 +156,101 @@ var Preset::getPresetValues(bool includeParents, Array<Controllable*> ignoreList
 	return data;
 }
 
+Array<Preset*> Preset::getIncludedPresets()
+{
+	Array<Preset*> result;
+	if (parentContainer != nullptr && parentContainer != RootPresetManager::getInstance()) result.add((Preset*)parentContainer->parentContainer.get());
+
+	for (auto& c : linkedPresetsCC.controllables)
+	{
+		if (!c->enabled) continue;
+		Preset* p = dynamic_cast<Preset*>(((TargetParameter*)c)->targetContainer.get());
+		if (p == nullptr) continue;
+		result.add(p);
+	}
+
+	return result;
+}
+
+const Array<Preset::SnapshotValue>& Preset::getSnapshot(bool includeParents, bool resolveTransition)
+{
+	Snapshot& s = snapshots[(includeParents ? 1 : 0) + (resolveTransition ? 2 : 0)];
+
+	//only the presets involved are checked, not the values
+	Array<SnapshotSource> sources;
+	collectSnapshotSources(sources, includeParents);
+
+	bool isValid = s.isCompiled && s.sources.size() == sources.size();
+	for (int i = 0; i < sources.size() && isValid; i++)
+	{
+		const SnapshotSource& cs = s.sources.getReference(i);
+		const SnapshotSource& ns = sources.getReference(i);
+		isValid = cs.preset.get() == ns.preset.get() && cs.dataVersion == ns.dataVersion && cs.enabled == ns.enabled;
+	}
+
+	if (!isValid)
+	{
+		HashMap<Controllable*, bool> ignoreMap;
+		s.values.clearQuick();
+		compileSnapshotValues(s.values, ignoreMap, includeParents, resolveTransition);
+		s.sources.swapWith(sources);
+		s.isCompiled = true;
+	}
+
+	return s.values;
+}
+
+void Preset::compileSnapshotValues(Array<SnapshotValue>& values, HashMap<Controllable*, bool>& ignoreMap, bool includeParents, bool resolveTransition)
+{
+	//same merging as getPresetValues, without going through addresses
+	if (!enabled->boolValue()) return;
+
+	for (auto& c : ignoredControllables) if (c != nullptr) ignoreMap.set(c.get(), true);
+
+	HashMap<WeakReference<Controllable>, var>::Iterator it(dataMap);
+	while (it.next())
+	{
+		WeakReference<Controllable> c = it.getKey();
+		if (c == nullptr || c.wasObjectDeleted()) continue;
+		if (ignoreMap.contains(c.get())) continue;
+
+		TransitionMode tm = transitionMap.contains(c) ? transitionMap[c] : TransitionMode::DEFAULT;
+		if (tm == TransitionMode::DEFAULT && resolveTransition) tm = defaultTransitionMode->getValueDataAsEnum<TransitionMode>();
+
+		values.add({ c, it.getValue(), tm });
+		ignoreMap.set(c.get(), true);
+	}
+
+	if (!includeParents) return;
+
+	for (auto& p : getIncludedPresets())
+	{
+		//the included preset's own ignores only apply to its branch, but what it sets can't be set again by the next ones
+		HashMap<Controllable*, bool> branchIgnoreMap;
+		HashMap<Controllable*, bool>::Iterator iit(ignoreMap);
+		while (iit.next()) branchIgnoreMap.set(iit.getKey(), true);
+
+		int numValuesBefore = values.size();
+		p->compileSnapshotValues(values, branchIgnoreMap, true, resolveTransition);
+		for (int i = numValuesBefore; i < values.size(); i++) ignoreMap.set(values.getReference(i).target.get(), true);
+	}
+}
+
+void Preset::collectSnapshotSources(Array<SnapshotSource>& sources, bool includeParents)
+{
+	for (auto& s : sources) if (s.preset.get() == this) return;
+
+	sources.add({ this, dataVersion, enabled->boolValue() });
+	if (!enabled->boolValue() || !includeParents) return;
+
+	for (auto& p : getIncludedPresets()) p->collectSnapshotSources(sources, true);
+}
+
+void Preset::invalidateSnapshot()
+{
+	dataVersion++; //snapshots of this preset and of the ones including it will be recompiled on next use
+}
+
 void Preset::saveContainer(ControllableContainer* container, bool recursive)
 {
 	Array<WeakReference<Parameter>> cList = container->getAllParameters(recursive);
@@ -196,6 +281,7 @@ void Preset::save(Controllable* controllable, bool saveAllPresettables, bool noC
 
 		dataMap.clear();
 		addressMap.clear();
+		invalidateSnapshot();
 
 		int numSaved = 0;
 		for (auto& p : params)
@@ -219,19 +305,17 @@ void Preset::save(Controllable* controllable, bool saveAllPresettables, bool noC
 void Preset::load(bool recursive)
 {
 	int numLoaded = 0;
-	var data = getPresetValues(recursive, Array<Controllable*>(), false, resolveParentTransitions->boolValue());
-	NamedValueSet props = data.getDynamicObject()->getProperties();
-	for (auto& p : props)
+	const Array<SnapshotValue>& values = getSnapshot(recursive, resolveParentTransitions->boolValue());
+	for (int i = 0; i < values.size(); i++) //by index, a trigger may end up recompiling the snapshot
 	{
-		if (Controllable* tc = dynamic_cast<Controllable*>(Engine::mainEngine->getControllableForAddress(p.name.toString())))
-		{
-			if (!RootPresetManager::getInstance()->isControllablePresettable(tc)) continue;
+		const SnapshotValue& v = values.getReference(i);
+		Controllable* tc = v.target.get();
+		if (tc == nullptr || !RootPresetManager::getInstance()->isControllablePresettable(tc)) continue;
 
-			if (tc->type == Controllable::TRIGGER) ((Trigger*)tc)->trigger();
-			else ((Parameter*)tc)->setValue(p.value[0]);
+		if (tc->type == Controllable::TRIGGER) ((Trigger*)tc)->trigger();
+		else ((Parameter*)tc)->setValue(v.value);
 
-			numLoaded++;
-		}
+		numLoaded++;
 	}
 	NLOG(niceName, "Loaded " << numLoaded << " values.");
 }
@@ -247,6 +331,7 @@ void Preset::addControllableToDataMap(Controllable* c, var forceValue)
 
 	dataMap.set(c, val);
 	addressMap.set(add, val);
+	invalidateSnapshot();
 	controllableGhostAddressMap.set(c, add);
 	lostControllables.remove(add);
 	/*if (!isMain()) */overridenControllables.addIfNotAlreadyThere(add);
@@ -275,6 +360,7 @@ void Preset::removeControllableFromDataMap(Controllable* c)
 	String add = c->getControlAddress();
 	dataMap.remove(c);
 	transitionMap.remove(c);
+	invalidateSnapshot();
 	controllableGhostAddressMap.remove(c);
 	c->removeControllableListener(this);
 	unregisterLinkedInspectable(c);
@@ -293,6 +379,7 @@ void Preset::removeAddressFromDataMap(String address)
 
 	controllableGhostAddressMap.removeValue(address);
 	addressMap.remove(address);
+	invalidateSnapshot();
 	/* if (!isMain()) */ overridenControllables.removeAllInstancesOf(address);
 }
 
@@ -311,6 +398,7 @@ void Preset::recoverLostControllables()
 		{
 			addControllableToDataMap(c, addressMap.contains(add) ? addressMap[add] : var());
 			transitionMap.set(c, lit.getValue());
+			invalidateSnapshot();
 		}
 	}
 }
@@ -341,6 +429,10 @@ void Preset::onControllableFeedbackUpdate(ControllableContainer* cc, Controllabl
 		transitionTime->setEnabled(q == Transport::FREE);
 		numBeatBarQuantiz->setEnabled(q == Transport::BEAT || q == Transport::BAR);
 	}
+	else if (c == defaultTransitionMode)
+	{
+		invalidateSnapshot();
+	}
 }
 
 void Preset::itemAdded(Preset* p)
@@ -446,6 +538,8 @@ void Preset::loadJSONDataItemInternal(var data)
 		}
 	}
 
+	invalidateSnapshot();
+
 	var lostData = data.getProperty("lost", var());
 	if (lostData.isObject())
 	{
@@ -468,6 +562,7 @@ void Preset::controllableControlAddressChanged(Controllable* c)
 		if (dataMap.contains(c))
 		{
 			dataMap.remove(c);
+			invalidateSnapshot();
 			c->removeControllableListener(this);
 			lostControllables.set(controllableGhostAddressMap[c], transitionMap[c]);
 			controllableGhostAddressMap.remove(c);
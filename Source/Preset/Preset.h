@@ -53,9 +53,40 @@ public:
 
 	ControllableContainer linkedPresetsCC;
 
+	//Compiled values, with parents and linked presets already merged, so loading is a plain walk through an array
+	struct SnapshotValue
+	{
+		WeakReference<Controllable> target;
+		var value;
+		TransitionMode transitionMode;
+	};
+
+	struct SnapshotSource
+	{
+		WeakReference<ControllableContainer> preset;
+		uint32 dataVersion;
+		bool enabled;
+	};
+
+	struct Snapshot
+	{
+		bool isCompiled = false;
+		Array<SnapshotValue> values;
+		Array<SnapshotSource> sources; //presets the values come from, checked before using the snapshot
+	};
+
+	Snapshot snapshots[4]; //with / without parents, with / without resolved transitions
+	uint32 dataVersion; //incremented each time this preset's own values, transitions or ignores change
+
 	void clearItem() override;
 
 	var getPresetValues(bool includeParents = true, Array<Controllable*> ignoreList = Array<Controllable*>(), bool includeDisabled = false, bool resolveTransition = false);
+	Array<Preset*> getIncludedPresets();
+
+	const Array<SnapshotValue>& getSnapshot(bool includeParents, bool resolveTransition);
+	void compileSnapshotValues(Array<SnapshotValue>& values, HashMap<Controllable*, bool>& ignoreMap, bool includeParents, bool resolveTransition);
+	void collectSnapshotSources(Array<SnapshotSource>& sources, bool includeParents);
+	void invalidateSnapshot();
 
 	void saveContainer(ControllableContainer* container, bool recursive);
 	void save(Controllable* controllable = nullptr, bool saveAllPresettables = false, bool noCheck = false);
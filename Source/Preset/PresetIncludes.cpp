@@ -11,6 +11,7 @@
 #include "PresetIncludes.h"
 
 #include "Preset.cpp"
+#include "PresetTransition.cpp"
 #include "PresetManager.cpp"
 
 #include "ui/PresetUI.cpp"
@@ -10,8 +10,10 @@
 
 #pragma once
 #include "JuceHeader.h"
+#include "Transport/Transport.h"
 
 #include "Preset.h"
+#include "PresetTransition.h"
 #include "PresetManager.h"
 
 #include "ui/PresetUI.h"
@@ -45,7 +45,6 @@ Array<Preset*> PresetManager::getAllPresets(bool recursive, bool includeDisabled
 //Root
 RootPresetManager::RootPresetManager() :
 	PresetManager(),
-	Thread("Preset Manager"),
 	prevPreset(nullptr),
 	currentPreset(nullptr)
 {
@@ -62,6 +61,7 @@ RootPresetManager::RootPresetManager() :
 
 	loadProgress = addFloatParameter("Load Progression", "Progression of the current preset loading", 0, 0, 1);
 	loadProgress->setControllableFeedbackOnly(true);
+	transition.progressParameter = loadProgress;
 
 	curPresetName = addStringParameter("Current Preset", "The name of the current preset, for reference", "");
 	curPresetName->setControllableFeedbackOnly(true);
@@ -86,7 +86,7 @@ RootPresetManager::~RootPresetManager()
 	if (Engine::mainEngine != nullptr) Engine::mainEngine->removeEngineListener(this);
 	if (OSCRemoteControl::getInstanceWithoutCreating()) OSCRemoteControl::getInstance()->removeRemoteControlListener(this);
 
-	stopThread(100);
+	transition.stop();
 	setCurrentPreset(nullptr);
 }
 
@@ -102,7 +102,7 @@ void RootPresetManager::setCurrentPreset(Preset* p)
 
 	if (p != nullptr && !p->enabled) return;
 
-	if (Thread::getCurrentThreadId() == getThreadId()) //calling preset change from a preset transition, need to restart from another thread than this one
+	if (transition.isApplyingChanges) //calling preset change from a preset transition change, need to restart after it
 	{
 		MessageManager::getInstance()->callAsync([this, p]()
 			{
@@ -118,7 +118,7 @@ void RootPresetManager::setCurrentPreset(Preset* p)
 		currentPreset->isCurrent->setValue(false);
 	}
 
-	stopThread(100);
+	transition.stop();
 
 	prevPreset = currentPreset;
 	currentPreset = p;
@@ -158,7 +158,7 @@ void RootPresetManager::setCurrentPreset(Preset* p)
 
 			currentPreset->load(recursive);
 		}
-		else startThread();
+		else startTransition();
 	}
 
 	curPresetName->setValue(currentPreset != nullptr ? currentPreset->niceName : "");
@@ -332,7 +332,7 @@ void RootPresetManager::processMessage(const OSCMessage& m)
 }
 
 
-void RootPresetManager::run()
+void RootPresetManager::startTransition()
 {
 	if (currentPreset == nullptr) return;
 
@@ -341,47 +341,9 @@ void RootPresetManager::run()
 		&& prevPreset != nullptr
 		&& prevPreset->parentContainer == currentPreset->parentContainer) recursive = false;
 
-	var targetValues = currentPreset->getPresetValues(recursive, Array<Controllable*>(), false, currentPreset->resolveParentTransitions->boolValue());
-	NamedValueSet props = targetValues.getDynamicObject()->getProperties();
-
-	initTargetMap.clear();
-
+	const Array<Preset::SnapshotValue>& targetValues = currentPreset->getSnapshot(recursive, currentPreset->resolveParentTransitions->boolValue());
 	Preset::TransitionMode defaultTM = currentPreset->defaultTransitionMode->getValueDataAsEnum<Preset::TransitionMode>();
 
-	for (auto& val : props)
-	{
-
-		if (Controllable* tc = dynamic_cast<Controllable*>(Engine::mainEngine->getControllableForAddress(val.name.toString())))
-		{
-			if (!isControllablePresettable(tc)) continue;
-			var initTargetValue;
-			initTargetValue.append(tc->type == Controllable::TRIGGER ? var() : ((Parameter*)tc)->value);
-			initTargetValue.append(val.value[0]);
-
-			Preset::TransitionMode tm = defaultTM;
-			if (val.value.size() > 1)
-			{
-				Preset::TransitionMode otm = (Preset::TransitionMode)(int)val.value[1];
-				if (otm != Preset::DEFAULT) tm = otm;
-			}
-
-			bool canInterpolate = tc->type != Controllable::TRIGGER && tc->type != Parameter::BOOL && tc->type != Parameter::ENUM && tc->type != Parameter::STRING && tc->type != Parameter::ENUM;
-
-			if (!canInterpolate && tm == Preset::INTERPOLATE) tm = Preset::AT_START;
-
-			initTargetValue.append((int)tm);
-			initTargetMap.set(tc, initTargetValue);
-		}
-	}
-
-	float progression = 0;
-
-	loadProgress->setValue(progression);
-
-	process(0, currentPreset->transitionCurve.getValueAtPosition(0)); //force for at_start changes
-
-	double timeAtStart = Time::getMillisecondCounter() / 1000.0;
-
 	Transport::Quantization q = currentPreset->transitionQuantiz->getValueDataAsEnum<Transport::Quantization>();
 	if (q == Transport::DEFAULT) q = Transport::getInstance()->quantization->getValueDataAsEnum<Transport::Quantization>();
 
@@ -402,67 +364,9 @@ void RootPresetManager::run()
 		break;
 	}
 
-
 	//LOG("Loading preset " << currentPreset->niceName << " in " << totalTime << " seconds.");
 
-	while (!threadShouldExit())
-	{
-		double currentTime = Time::getMillisecondCounter() / 1000.0 - timeAtStart;
-		progression = jmin<float>(currentTime / totalTime, 1);
-		loadProgress->setValue(progression);
-
-		float weight = currentPreset->transitionCurve.getValueAtPosition(progression);
-		process(progression, weight);
-
-		if (progression == 1)
-		{
-			loadProgress->setValue(0);
-			return;
-		}
-		wait(30); //~30fps
-	}
-
-}
-
-void RootPresetManager::process(float progression, float weight)
-{
-	HashMap<WeakReference<Controllable>, var>::Iterator it(initTargetMap);
-
-	while (it.next())
-	{
-		if (it.getKey().wasObjectDeleted()) continue;
-		Controllable* c = it.getKey().get();
-
-		Preset::TransitionMode itm = (Preset::TransitionMode)(int)it.getValue()[2];
-		if ((itm == Preset::AT_START && progression != 0) || (itm == Preset::AT_END && progression != 1)) continue;
-
-
-		if (c->type == Controllable::TRIGGER)
-		{
-			if (itm == Preset::AT_START || itm == Preset::AT_END) ((Trigger*)c)->trigger();
-		}
-		else
-		{
-			Parameter* p = (Parameter*)c;
-			if (itm == Preset::AT_START || itm == Preset::AT_END) p->setValue(it.getValue()[1]);
-			else
-			{
-				if (p->isComplex())
-				{
-					var newVal;
-					for (int i = 0; i < p->value.size(); i++)
-					{
-						newVal.append(jmap<float>(weight, it.getValue()[0][i], it.getValue()[1][i]));
-						p->setValue(newVal);
-					}
-				}
-				else
-				{
-					p->setValue(jmap<float>(weight, it.getValue()[0], it.getValue()[1]));
-				}
-			}
-		}
-	}
+	transition.start(targetValues, defaultTM, currentPreset->transitionCurve, totalTime, q != Transport::FREE); //quantized transitions follow the transport
 }
 
 void RootPresetManager::endLoadFile()
@@ -24,7 +24,6 @@ class RootPresetManager :
     public PresetManager,
     public Inspectable::InspectableListener,
     public EngineListener,
-    public Thread,
     public OSCRemoteControl::RemoteControlListener
 {
 public:
@@ -50,9 +49,7 @@ public:
     FloatParameter* loadProgress;
 
     //Transition
-    
-    HashMap<WeakReference<Controllable>, var> initTargetMap;
-
+    PresetTransition transition;
 
 
     void clear() override;
@@ -80,8 +77,7 @@ public:
 
     void processMessage(const OSCMessage& m) override;
 
-    void run() override;
-    void process(float progression, float weight);
+    void startTransition();
 
     void endLoadFile() override;
 };
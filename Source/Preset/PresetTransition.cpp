@@ -0,0 +1,270 @@
+/*
+  ==============================================================================
+
+	PresetTransition.cpp
+	Created: 17 Oct 2026 6:24:10pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#include "Node/NodeIncludes.h"
+#include "Preset/PresetIncludes.h"
+
+PresetTransition::PresetTransition() :
+	numAudioEntries(0),
+	numDroppedAudioValues(0),
+	isRunning(false),
+	syncToTransport(false),
+	startSample(0),
+	numTotalSamples(1),
+	position(0),
+	progressParameter(nullptr),
+	isApplyingChanges(false)
+{
+	for (int i = 0; i <= curveResolution; i++) curve[i] = i * 1.0f / curveResolution;
+	Transport::getInstance()->addBlockListener(this);
+}
+
+PresetTransition::~PresetTransition()
+{
+	if (Transport* t = Transport::getInstanceWithoutCreating()) t->removeBlockListener(this);
+	stop();
+}
+
+void PresetTransition::start(const Array<Preset::SnapshotValue>& targetValues, Preset::TransitionMode defaultMode, Automation& transitionCurve, double totalTime, bool _syncToTransport)
+{
+	stop();
+
+	Array<Entry> newEntries;
+	Array<Entry> startEntries;
+	Array<Entry> newEndEntries;
+
+	for (auto& val : targetValues)
+	{
+		Controllable* tc = val.target.get();
+		if (tc == nullptr || !RootPresetManager::getInstance()->isControllablePresettable(tc)) continue;
+
+		Preset::TransitionMode tm = val.transitionMode != Preset::DEFAULT ? val.transitionMode : defaultMode;
+
+		Entry e;
+		e.target = tc;
+		e.endValue = val.value;
+
+		if (tm == Preset::INTERPOLATE && tc->type != Controllable::TRIGGER)
+		{
+			//only plain numbers and small arrays of numbers (points, colors) are interpolated, everything else changes at start
+			var startValue = ((Parameter*)tc)->value;
+			bool isArray = startValue.isArray();
+			int numValues = isArray ? startValue.size() : 1;
+			bool canInterpolate = numValues <= 4 && isArray == e.endValue.isArray() && (!isArray || e.endValue.size() == numValues);
+
+			for (int i = 0; i < numValues && canInterpolate; i++)
+			{
+				var sv = isArray ? startValue[i] : startValue;
+				var ev = isArray ? e.endValue[i] : e.endValue;
+				canInterpolate = (sv.isDouble() || sv.isInt() || sv.isInt64()) && (ev.isDouble() || ev.isInt() || ev.isInt64());
+				e.startValues[i] = sv;
+				e.endValues[i] = ev;
+			}
+
+			if (canInterpolate)
+			{
+				e.numValues = numValues;
+
+				if (numValues == 1)
+				{
+					ControllableContainer* cc = tc->parentContainer.get();
+					Node* node = nullptr;
+					while (cc != nullptr && node == nullptr)
+					{
+						node = dynamic_cast<Node*>(cc);
+						cc = cc->parentContainer.get();
+					}
+
+					AudioCommand command;
+					if (node != nullptr && node->getAudioValueCommand((Parameter*)tc, e.startValues[0], command)) e.audioNode = node;
+				}
+
+				newEntries.add(e);
+				continue;
+			}
+
+			tm = Preset::AT_START;
+		}
+
+		if (tm == Preset::AT_END) newEndEntries.add(e);
+		else startEntries.add(e);
+	}
+
+	float newCurve[curveResolution + 1];
+	for (int i = 0; i <= curveResolution; i++) newCurve[i] = transitionCurve.getValueAtPosition(i * 1.0f / curveResolution);
+
+	applyChanges(startEntries);
+	if (progressParameter != nullptr) progressParameter->setValue(0);
+
+	int newNumAudioEntries = 0;
+	for (auto& e : newEntries) if (e.audioNode != nullptr) newNumAudioEntries++;
+
+	endEntries.swapWith(newEndEntries);
+
+	{
+		const SpinLock::ScopedLockType sl(clockLock);
+		entries.swapWith(newEntries);
+		memcpy(curve, newCurve, sizeof(curve));
+		numAudioEntries = newNumAudioEntries;
+		syncToTransport = _syncToTransport;
+		startSample = Transport::getInstance()->timeInSamples;
+		numTotalSamples = jmax<int64>(roundToInt(totalTime * Transport::getInstance()->sampleRate), 1);
+		position = 0;
+		isRunning = true;
+	}
+
+	startTimerHz(50);
+}
+
+void PresetTransition::stop()
+{
+	bool wasRunning = false;
+	{
+		const SpinLock::ScopedLockType sl(clockLock);
+		wasRunning = isRunning.load();
+		isRunning = false;
+	}
+
+	stopTimer();
+
+	//the audio thread can be ahead of the last mirrored values, send the parameters' values so both agree
+	if (wasRunning) sendParameterValues();
+
+	{
+		const SpinLock::ScopedLockType sl(clockLock);
+		entries.clear();
+		numAudioEntries = 0;
+	}
+	endEntries.clear();
+}
+
+void PresetTransition::applyChanges(const Array<Entry>& changes)
+{
+	isApplyingChanges = true;
+	for (auto& e : changes)
+	{
+		Controllable* c = e.target.get();
+		if (c == nullptr) continue;
+
+		if (c->type == Controllable::TRIGGER) ((Trigger*)c)->trigger();
+		else ((Parameter*)c)->setValue(e.endValue);
+	}
+	isApplyingChanges = false;
+}
+
+void PresetTransition::applyInterpolatedValues(float progression)
+{
+	float weight = getCurveValue(progression);
+
+	isApplyingChanges = true; //a target loading another preset is deferred, entries stay valid
+	for (auto& e : entries)
+	{
+		Parameter* p = (Parameter*)e.target.get();
+		if (p == nullptr) continue;
+
+		if (e.audioNode != nullptr)
+		{
+			//already sent to the audio thread, only mirrored in the parameter
+			Node::isMirroringAudioValues = true;
+			p->setValue(jmap(weight, e.startValues[0], e.endValues[0]));
+			Node::isMirroringAudioValues = false;
+		}
+		else if (e.numValues == 1) p->setValue(jmap(weight, e.startValues[0], e.endValues[0]));
+		else
+		{
+			var newVal;
+			for (int i = 0; i < e.numValues; i++) newVal.append(jmap(weight, e.startValues[i], e.endValues[i]));
+			p->setValue(newVal);
+		}
+	}
+	isApplyingChanges = false;
+
+	if (progressParameter != nullptr) progressParameter->setValue(progression);
+}
+
+void PresetTransition::sendAudioValues(float weight)
+{
+	for (auto& e : entries)
+	{
+		Node* n = e.audioNode.get();
+		Parameter* p = (Parameter*)e.target.get();
+		if (n == nullptr || p == nullptr) continue;
+
+		//pushed directly, sendAudioCommand logs when the queue is full
+		AudioCommand command;
+		if (n->getAudioValueCommand(p, jmap(weight, e.startValues[0], e.endValues[0]), command) && !n->commandQueue.push(command)) numDroppedAudioValues++;
+	}
+}
+
+void PresetTransition::sendParameterValues()
+{
+	for (auto& e : entries)
+	{
+		Node* n = e.audioNode.get();
+		Parameter* p = (Parameter*)e.target.get();
+		if (n == nullptr || p == nullptr) continue;
+
+		AudioCommand command;
+		if (n->getAudioValueCommand(p, p->floatValue(), command)) n->sendAudioCommand(command.type, command.index, command.value);
+	}
+}
+
+float PresetTransition::getCurveValue(float progression) const
+{
+	float pos = jlimit(0.0f, 1.0f, progression) * curveResolution;
+	int index = jmin((int)pos, curveResolution - 1);
+	return jmap(pos - index, curve[index], curve[index + 1]);
+}
+
+void PresetTransition::timerCallback()
+{
+	if (!isRunning.load())
+	{
+		stopTimer();
+		return;
+	}
+
+	if (int dropped = numDroppedAudioValues.exchange(0)) LOGWARNING("Preset transition : " << dropped << " values didn't fit in the nodes' command queues, they were late by a block");
+
+	float progression = jlimit(0.0f, 1.0f, (float)(position.load() * 1.0 / numTotalSamples));
+	applyInterpolatedValues(progression);
+	if (progression < 1) return;
+
+	//the audio clock reached the end
+	Array<Entry> changes;
+	changes.swapWith(endEntries);
+	stop();
+
+	applyChanges(changes);
+	if (progressParameter != nullptr) progressParameter->setValue(0);
+}
+
+void PresetTransition::transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS)
+{
+	if (!isRunning.load()) return;
+
+	const SpinLock::ScopedTryLockType sl(clockLock);
+	if (!sl.isLocked() || !isRunning.load()) return;
+
+	//position at the end of this block. Quantized transitions follow the transport while it plays, but never backwards :
+	//after a stop or a rewind they go on with the elapsed samples
+	int64 curPosition = position.load();
+	int64 newPosition = curPosition + numSamples;
+	if (syncToTransport && isPlaying)
+	{
+		int64 transportPosition = blockStartSample + numSamples - startSample;
+		if (transportPosition >= curPosition) newPosition = transportPosition;
+	}
+
+	position = jmin(newPosition, numTotalSamples);
+
+	//the values for the next block, the graph has already processed this one
+	if (numAudioEntries > 0) sendAudioValues(getCurveValue((float)(position.load() * 1.0 / numTotalSamples)));
+}
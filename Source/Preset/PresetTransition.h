@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+	PresetTransition.h
+	Created: 17 Oct 2026 6:24:10pm
+	Author:  bkupe
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class Node;
+
+/* Preset transition engine, driven by the audio clock.
+
+   start() takes the preset's compiled snapshot, on the message thread, and compiles it in a flat list of entries
+   (target, start and end values, transition mode) along with a sampled copy of the transition curve.
+   The Transport's block callback advances the transition on the sample clock : the transport's position for quantized transitions,
+   the elapsed samples otherwise or while the transport is stopped. It runs wherever the Transport is driven, offline renders included.
+   Targets that the audio thread uses (gains, dry / wet, see Node::getAudioValueCommand) get their value for each block from that callback,
+   sent to their node as commands, so they follow the curve at block rate and their nodes ramp them per sample.
+   A message thread timer mirrors the interpolated values in the parameters, for the UI and the targets the audio thread doesn't use
+   (spat positions...), which follow at control rate.
+   Changes that can't be interpolated (triggers, enums, strings...) are applied when starting or when the audio clock reaches the end.
+*/
+class PresetTransition :
+	public Transport::BlockListener,
+	public Timer
+{
+public:
+	PresetTransition();
+	~PresetTransition();
+
+	struct Entry
+	{
+		WeakReference<Controllable> target;
+		int numValues = 0; //interpolated values, 1 for a number, up to 4 for points and colors
+		float startValues[4];
+		float endValues[4];
+		var endValue;
+		WeakReference<Node> audioNode; //the node that gets this value on the audio thread, if any
+	};
+
+	static const int curveResolution = 256;
+
+	//message thread, entries and curve are also read by the audio thread under clockLock
+	Array<Entry> entries; //interpolated
+	Array<Entry> endEntries; //changed at end
+	float curve[curveResolution + 1];
+	int numAudioEntries;
+	std::atomic<int> numDroppedAudioValues; //values that didn't fit in their node's command queue, the next block sends them again
+
+	//clock, set by the message thread under the lock, advanced by the audio thread which skips the block if it can't take it
+	SpinLock clockLock;
+	std::atomic<bool> isRunning;
+	bool syncToTransport;
+	int64 startSample;
+	int64 numTotalSamples;
+	std::atomic<int64> position; //published to the message thread
+
+	FloatParameter* progressParameter;
+	bool isApplyingChanges; //message thread, true while setting non interpolated values, which may load another preset
+
+	void start(const Array<Preset::SnapshotValue>& targetValues, Preset::TransitionMode defaultMode, Automation& transitionCurve, double totalTime, bool syncToTransport);
+	void stop();
+
+	void applyChanges(const Array<Entry>& changes);
+	void applyInterpolatedValues(float progression);
+	void sendAudioValues(float weight); //audio thread
+	void sendParameterValues(); //message thread, after the audio thread has stopped sending
+	float getCurveValue(float progression) const;
+
+	void timerCallback() override;
+
+	void transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS) override;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetTransition)
+};
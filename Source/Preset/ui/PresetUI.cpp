@@ -307,6 +307,7 @@ void PresetEditor::newMessage(const ContainerAsyncEvent& e)
 				if (e.source == &ignoreCC)
 				{
 					preset->ignoredControllables.removeAllInstancesOf(ignoreMap[c]);
+					preset->invalidateSnapshot();
 				}
 
 				buildValuesCC();
@@ -382,6 +383,7 @@ void PresetValueEditor::comboBoxChanged(ComboBox* cb)
 		Preset::TransitionMode tm = (Preset::TransitionMode)(transitionMode.getSelectedId() - 1);//remove the +1 offset
 		if (tm == Preset::DEFAULT) preset->transitionMap.remove(sourceControllable);
 		else preset->transitionMap.set(sourceControllable, tm);
+		preset->invalidateSnapshot();
 	}
 }
 
@@ -19,11 +19,15 @@ Transport::Transport() :
 	isCurrentlyPlaying(nullptr),
 	sampleRate(0),
 	blockSize(0),
+	outputLatencySamples(0),
 	timeInSamples(0),
 	numSamplesPerBeat(0),
+	tempoChangedFrom(0),
 	isSettingTempo(false),
 	setTempoSampleCount(0),
-	timeAtStart(0)
+	timeAtStart(0),
+	syncSource(nullptr),
+	syncPlayState(-1)
 {
 
 
@@ -101,6 +105,7 @@ Transport::Transport() :
 
 Transport::~Transport()
 {
+	stopTimer();
 	AudioManager::getInstance()->am.removeAudioCallback(this);
 }
 
@@ -274,16 +279,16 @@ void Transport::onContainerParameterChanged(Parameter* p)
 	}
 	else if (p == bpm)
 	{
-		if (!settingBPMFromTransport)
+		if (!settingBPMFromTransport && blockSize > 0)
 		{
-			double barRel = curBar->intValue() + (getRelativeBarSamples() * 1.0 / getBarNumSamples()); //before set new samplesPerBeat
-
+			int oldSamplesPerBeat = numSamplesPerBeat;
 			int rawSamplesPerBeat = round(sampleRate * 60.0 / bpm->doubleValue());
 			numSamplesPerBeat = rawSamplesPerBeat - rawSamplesPerBeat % blockSize;
 
-			timeInSamples = getBlockPerfectNumSamples(getBarNumSamples() * barRel); //after set new samplesPerBeat
-
-
+			//the audio thread advances the time, it moves it to the same bar position at its next block.
+			//If it hasn't yet since the last change, the time is still relative to the first beat length
+			int expected = 0;
+			if (oldSamplesPerBeat > 0 && numSamplesPerBeat != oldSamplesPerBeat) tempoChangedFrom.compare_exchange_strong(expected, oldSamplesPerBeat);
 		}
 
 #if USE_ABLETONLINK
@@ -499,6 +504,13 @@ void Transport::audioDeviceIOCallbackWithContext(const float* const* inputChanne
 	int numSamples,
 	const AudioIODeviceCallbackContext& context)
 {
+	double callbackTimeMS = Time::getMillisecondCounterHiRes();
+
+	int oldSamplesPerBeat = tempoChangedFrom.exchange(0);
+	if (oldSamplesPerBeat > 0 && numSamplesPerBeat > 0) setCurrentTime(getBlockPerfectNumSamples(timeInSamples * numSamplesPerBeat / oldSamplesPerBeat));
+
+	int64 blockStartSample = timeInSamples;
+	bool isPlaying = isCurrentlyPlaying->boolValue();
 
 	if (link->isEnabled() && link->numPeers() > 0)
 	{
@@ -511,14 +523,17 @@ void Transport::audioDeviceIOCallbackWithContext(const float* const* inputChanne
 		//beatProgression->setValue(phase / beatsPerBar->intValue());
 
 		setCurrentTime(getSamplesForTime(time.count() / 1e6));
+		blockStartSample = timeInSamples;
 	}
-	else if (isCurrentlyPlaying->boolValue())
+	else if (!followSyncSource(numSamples, callbackTimeMS, blockStartSample, isPlaying))
 	{
-		setCurrentTime(timeInSamples + numSamples);
+		if (isPlaying) setCurrentTime(timeInSamples + numSamples);
+		else if (isSettingTempo) setTempoSampleCount += numSamples;
 	}
-	else if (isSettingTempo)
+
 	{
-		setTempoSampleCount += numSamples;
+		const SpinLock::ScopedLockType lock(blockListenersLock);
+		for (auto& l : blockListeners) l->transportBlockStarted(blockStartSample, numSamples, isPlaying, callbackTimeMS);
 	}
 
 	for (int i = 0; i < numOutputChannels; i++) FloatVectorOperations::clear(outputChannelData[i], numSamples);
@@ -526,11 +541,18 @@ void Transport::audioDeviceIOCallbackWithContext(const float* const* inputChanne
 
 void Transport::audioDeviceAboutToStart(AudioIODevice* device)
 {
-	sampleRate = (int)device->getCurrentSampleRate();
-	blockSize = (int)device->getCurrentBufferSizeSamples();
+	setPlayConfig((int)device->getCurrentSampleRate(), (int)device->getCurrentBufferSizeSamples());
+	outputLatencySamples = device->getOutputLatencyInSamples();
+}
+
+void Transport::setPlayConfig(int newSampleRate, int newBlockSize)
+{
+	sampleRate = newSampleRate;
+	blockSize = newBlockSize;
 
 	int64 rawSamplesPerBeat = round(sampleRate * 60.0 / bpm->doubleValue());
 	numSamplesPerBeat = rawSamplesPerBeat - rawSamplesPerBeat % blockSize;
+	tempoChangedFrom = 0;
 	timeInSamples = 0;
 }
 
@@ -538,6 +560,94 @@ void Transport::audioDeviceStopped()
 {
 }
 
+void Transport::addBlockListener(BlockListener* listener)
+{
+	const SpinLock::ScopedLockType lock(blockListenersLock);
+	blockListeners.addIfNotAlreadyThere(listener);
+}
+
+void Transport::removeBlockListener(BlockListener* listener)
+{
+	const SpinLock::ScopedLockType lock(blockListenersLock);
+	blockListeners.removeAllInstancesOf(listener);
+}
+
+void Transport::setSyncSource(SyncSource* source)
+{
+	{
+		const SpinLock::ScopedLockType lock(blockListenersLock);
+		syncSource = source;
+		syncPlayState = -1;
+	}
+
+	if (source != nullptr) startTimerHz(50);
+	else stopTimer();
+}
+
+void Transport::removeSyncSource(SyncSource* source)
+{
+	{
+		const SpinLock::ScopedLockType lock(blockListenersLock);
+		if (syncSource != source) return;
+		syncSource = nullptr;
+		syncPlayState = -1;
+	}
+
+	stopTimer();
+}
+
+void Transport::timerCallback()
+{
+	int state = syncPlayState.exchange(-1);
+	if (state != -1 && (state == 1) != isCurrentlyPlaying->boolValue()) isCurrentlyPlaying->setValue(state == 1);
+}
+
+bool Transport::followSyncSource(int numSamples, double callbackTimeMS, int64& blockStartSample, bool& isPlaying)
+{
+	const SpinLock::ScopedTryLockType lock(blockListenersLock);
+	if (!lock.isLocked() || syncSource == nullptr || sampleRate <= 0 || blockSize <= 0 || numSamplesPerBeat <= 0) return false;
+
+	//where the master is when this block will be heard
+	double hearTimeMS = callbackTimeMS + outputLatencySamples * 1000.0 / sampleRate;
+	bool sourceIsPlaying = false;
+	double targetBeats = 0;
+	if (!syncSource->getSyncPosition(hearTimeMS, sourceIsPlaying, targetBeats)) return false;
+
+	//the parameter follows on the message thread, this block already plays or stops with the master
+	if (sourceIsPlaying != isCurrentlyPlaying->boolValue()) syncPlayState = sourceIsPlaying ? 1 : 0;
+	isPlaying = sourceIsPlaying;
+
+	//phase is compared in beats : the master's beats against the transport's, whose length is rounded to whole blocks
+	double errorBeats = targetBeats - timeInSamples * 1.0 / numSamplesPerBeat;
+	int64 errorSamples = (int64)(errorBeats * numSamplesPerBeat);
+	int64 targetSamples = (int64)(targetBeats * numSamplesPerBeat);
+
+	if (!sourceIsPlaying)
+	{
+		//follow song position / timecode locates
+		if (std::abs(errorSamples) >= blockSize) setCurrentTime(getBlockPerfectNumSamples(targetSamples));
+		blockStartSample = timeInSamples;
+		return true;
+	}
+
+	//more than half a bar away is a jump of the master, followed at once
+	if (std::abs(errorBeats) > beatsPerBar->intValue() / 2.0) setCurrentTime(getBlockPerfectNumSamples(targetSamples, false));
+
+	//the drift of the rounded beat length is only corrected when a bar starts, by whole blocks, so the loopers' bars stay whole :
+	//ahead of the master, the transport waits at the bar start. Late, it skips the missing blocks at once
+	int64 nextTime = timeInSamples + numSamples;
+	if (getRelativeBarSamples() < numSamples && std::abs(errorBeats) <= beatsPerBar->intValue() / 2.0)
+	{
+		int64 numBlocks = errorSamples / blockSize; //towards 0, never overshoots
+		if (numBlocks < 0) nextTime = timeInSamples;
+		else nextTime += numBlocks * blockSize;
+	}
+
+	blockStartSample = timeInSamples;
+	setCurrentTime(nextTime);
+	return true;
+}
+
 Optional<AudioPlayHead::PositionInfo> Transport::getPosition() const
 {
 	PositionInfo result;
@@ -23,7 +23,8 @@
 class Transport :
 	public ControllableContainer,
 	public AudioIODeviceCallback,
-	public AudioPlayHead
+	public AudioPlayHead,
+	public Timer
 {
 public:
 	juce_DeclareSingleton(Transport, true);
@@ -63,9 +64,11 @@ public:
 
 	int sampleRate;
 	int blockSize;
+	int outputLatencySamples; //reported by the audio device, between the callback and the speakers
 
 	int64 timeInSamples;
 	int numSamplesPerBeat;
+	std::atomic<int> tempoChangedFrom; //beat length before a tempo change, the audio thread moves the time to the same bar position
 
 	bool isSettingTempo;
 	int setTempoSampleCount;
@@ -129,6 +132,9 @@ public:
 
 	void setupAbletonLink();
 
+	void setPlayConfig(int sampleRate, int blockSize); //called when the device starts, or by the OfflineRenderer
+	bool followSyncSource(int numSamples, double callbackTimeMS, int64& blockStartSample, bool& isPlaying); //audio thread, false if there is no locked source
+
 	// Inherited via AudioIODeviceCallback
 
 	virtual void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
@@ -159,5 +165,35 @@ public:
 	void addTransportListener(TransportListener* newListener) { transportListeners.add(newListener); }
 	void removeTransportListener(TransportListener* listener) { transportListeners.remove(listener); }
 
+	//Called on the audio thread for each device block, with the transport position of that block.
+	//For what has to follow the rendered audio sample by sample, like outgoing MIDI clock or timecode
+	class BlockListener
+	{
+	public:
+		virtual ~BlockListener() {}
+		virtual void transportBlockStarted(int64 blockStartSample, int numSamples, bool isPlaying, double callbackTimeMS) = 0;
+	};
+
+	SpinLock blockListenersLock; //also guards syncSource
+	Array<BlockListener*> blockListeners;
+	void addBlockListener(BlockListener* listener);
+	void removeBlockListener(BlockListener* listener);
+
+	//An external master to follow, like an incoming MIDI clock or MTC. Polled on the audio thread for each block
+	class SyncSource
+	{
+	public:
+		virtual ~SyncSource() {}
+		//play state and position of the master at timeMS (millisecond counter), in beats. False if not locked yet
+		virtual bool getSyncPosition(double timeMS, bool& isPlaying, double& positionInBeats) = 0;
+	};
+
+	SyncSource* syncSource;
+	std::atomic<int> syncPlayState; //play state of the master, set on the message thread. -1 when there is nothing to change
+	void setSyncSource(SyncSource* source);
+	void removeSyncSource(SyncSource* source); //only if it's the current one
+
+	void timerCallback() override;
+
 	//DECLARE_ASYNC_EVENT(Transport, Transport, transport, ENUM_LIST(TIME_SIGNATURE_CHANGED, BPM_CHANGED))
 };